@@ -0,0 +1,263 @@
+#include "bot.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+static float const respawn_delay = 3.0f;    // Seconds before a dead bot comes back (like the server simulation)
+static float const shoot_range = 20.0f;
+static float const stuck_delay = 2.0f;      // Seconds without progress before choosing another target
+
+// Time on the steady clock of the process, shared by all the bots (ns)
+static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Bot::Bot(int index, BotSettings const& settings_arg, Apartment* apartment, std::vector<cgp::vec2> const& floor_cells_arg, BotStatistics& statistics_arg)
+    : username("bot" + std::to_string(index))
+    , room_id(settings_arg.room_prefix + std::to_string(index / settings_arg.per_room))
+    , settings(settings_arg), floor_cells(floor_cells_arg), statistics(statistics_arg), random(index)
+{
+    player.initialise_simulation();
+    player.set_apartment(apartment);
+    choose_target();
+
+    // Spread the actions of the bots
+    shoot_timer = next_interval(settings.shoot_interval);
+    chat_timer = next_interval(settings.chat_interval);
+    ping_timer = next_interval(settings.ping_interval);
+
+    connection.setLogging(false);
+    connection.registerMessageHandler([this](std::string const& message) { handle_message(message); });
+    connection.registerPongHandler([this](std::string const& payload) { handle_pong(payload); });
+}
+
+bool Bot::connect() {
+    // The local server uses the token as the username
+    connection.setNetworkConditions(settings.network);
+    was_connected = connection.connect(settings.url, username, room_id);
+    if (!was_connected) {
+        statistics.count_error();
+        return false;
+    }
+    if (settings.udp) {
+        connection.setUdpLoss(settings.udp_loss);
+        connection.requestUdp();
+    }
+    return true;
+}
+
+void Bot::disconnect() {
+    connection.disconnect();
+    was_connected = false;
+}
+
+float Bot::next_interval(float mean) {
+    if (mean <= 0.0f) return INFINITY;
+    return std::uniform_real_distribution<float>(0.5f * mean, 1.5f * mean)(random);
+}
+
+void Bot::choose_target() {
+    if (floor_cells.empty()) return;
+    target = floor_cells[std::uniform_int_distribution<size_t>(0, floor_cells.size() - 1)(random)];
+    cgp::vec3 const position = player.getPosition();
+    target_distance = cgp::norm(target - cgp::vec2(position.x, position.y));
+    stuck_timer = 0.0f;
+    input.run = std::bernoulli_distribution(0.5)(random);
+}
+
+void Bot::step(float dt) {
+    if (!connection.isConnected()) {
+        if (was_connected) {
+            statistics.count_disconnection();
+            was_connected = false;
+        }
+        return;
+    }
+
+    int current_health;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current_health = health;
+    }
+
+    if (player.isDead()) {
+        // The server restores the health on the respawn (at the spawn point for UPDATE, by itself for INPUT)
+        respawn_timer += dt;
+        if (respawn_timer >= respawn_delay) {
+            player.respawn();
+            choose_target();
+            send_state();
+        }
+        return;
+    }
+    if (current_health <= 0) {
+        player.die();
+        respawn_timer = 0.0f;
+        return;
+    }
+
+    // Walk to the target cell (another one once reached, or when blocked by a wall)
+    cgp::vec3 const position = player.getPosition();
+    cgp::vec2 const to_target = target - cgp::vec2(position.x, position.y);
+    float const distance = cgp::norm(to_target);
+    if (distance < target_distance - 0.1f) {
+        target_distance = distance;
+        stuck_timer = 0.0f;
+    }
+    stuck_timer += dt;
+    if (distance < 0.5f || stuck_timer > stuck_delay) choose_target();
+
+    input.direction = distance > 1e-3f ? cgp::vec3(to_target.x / distance, to_target.y / distance, 0.0f) : cgp::vec3(0, 0, 0);
+    shooting = false;
+
+    shoot_timer -= dt;
+    if (shoot_timer <= 0.0f) {
+        shoot();
+        shoot_timer = next_interval(settings.shoot_interval);
+    }
+    input.shoot = shooting;
+    player.step(dt, input);
+    send_state();
+
+    chat_timer -= dt;
+    if (chat_timer <= 0.0f) {
+        chat();
+        chat_timer = next_interval(settings.chat_interval);
+    }
+    ping_timer -= dt;
+    if (ping_timer <= 0.0f) {
+        connection.ping(std::to_string(now_ns()));
+        ping_timer = next_interval(settings.ping_interval);
+    }
+}
+
+void Bot::send(nlohmann::json const& message, bool state) {
+    std::string const text = message.dump();
+    if (state) connection.sendState(text);
+    else connection.send(text);
+    if (connection.isConnected()) statistics.count_sent(text.size());
+    else statistics.count_error();
+}
+
+void Bot::send_state() {
+    // Like the game, the inputs stay on the WebSocket: each one moves the player on the server, none can be lost
+    if (settings.send_input) {
+        send({ {"type", "INPUT"}, {"content", {
+            {"direction", { {"x", input.direction.x}, {"y", input.direction.y} }},
+            {"run", input.run}, {"jump", input.jump}, {"shoot", input.shoot} }} });
+        return;
+    }
+
+    // Same content as the UPDATE of the game (the aim is a rotation around the vertical axis towards the walking direction)
+    cgp::vec3 const position = player.getPosition();
+    float const angle = std::atan2(input.direction.y, input.direction.x);
+    float const c = std::cos(angle), s = std::sin(angle);
+    nlohmann::json const aim = nlohmann::json::array({
+        { c, -s, 0.0f, position.x },
+        { s, c, 0.0f, position.y },
+        { 0.0f, 0.0f, 1.0f, position.z },
+        { 0.0f, 0.0f, 0.0f, 1.0f } });
+    send({ {"type", "UPDATE"}, {"content", {
+        {"position", { {"x", position.x}, {"y", position.y}, {"z", position.z} }},
+        {"aimDirection", aim},
+        {"isShooting", shooting}, {"isMoving", player.isMoving()}, {"isRunning", player.isRunning()} }} }, true);
+}
+
+void Bot::shoot() {
+    // Nearest known player in range (the server checks the distance, not the line of sight)
+    cgp::vec3 const position = player.getPosition();
+    std::string target_name;
+    float target_distance_3d = shoot_range;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto const& other : others) {
+            float const d = cgp::norm(other.second - position);
+            if (d < target_distance_3d) {
+                target_distance_3d = d;
+                target_name = other.first;
+            }
+        }
+    }
+    if (target_name.empty()) return;
+
+    shooting = true;
+    send({ {"type", "HIT"}, {"shooter", username}, {"target", target_name},
+           {"damage", player.getWeapon().getDamage()}, {"distance", target_distance_3d} });
+}
+
+void Bot::chat() {
+    // "bot <sequence> <send time>", read back by the other bots
+    std::ostringstream content;
+    content << "bot " << ++chat_sequence << " " << now_ns();
+    send({ {"type", "CHAT"}, {"content", content.str()} });
+}
+
+void Bot::handle_message(std::string const& message) {
+    statistics.count_received(message.size());
+
+    nlohmann::json const data = nlohmann::json::parse(message, nullptr, false);
+    if (!data.is_object() || !data.contains("type") || !data["type"].is_string()) {
+        statistics.count_error();
+        return;
+    }
+
+    std::string const type = data["type"].get<std::string>();
+    if (type == "SNAPSHOT" && data.contains("content") && data["content"].is_array()) {
+        for (nlohmann::json const& entry : data["content"])
+            if (entry.contains("username") && entry["username"].is_string() && entry.contains("content"))
+                handle_state(entry["username"].get<std::string>(), entry["content"]);
+    }
+    else if (type == "UPDATE" && data.contains("content") && data["content"].is_object()) {
+        nlohmann::json const& content = data["content"];
+        if (data.contains("username") && data["username"].is_string()) {
+            handle_state(data["username"].get<std::string>(), content);
+        }
+        else if (content.contains("health") && content["health"].is_number()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            health = content["health"].get<int>();
+        }
+    }
+    else if (type == "CHAT" && data.contains("username") && data["username"].is_string() && data.contains("content") && data["content"].is_string()) {
+        handle_chat(data["username"].get<std::string>(), data["content"].get<std::string>());
+    }
+    else if (type == "UDP" && data.contains("content") && data["content"].is_object()) {
+        nlohmann::json const& content = data["content"];
+        connection.openUdp(content.value("port", 0), content.value("token", uint64_t(0)));
+    }
+    else if (type == "ERROR") {
+        statistics.count_error();
+        std::cerr << username << ": " << data.value("message", std::string()) << std::endl;
+    }
+}
+
+void Bot::handle_state(std::string const& other, nlohmann::json const& content) {
+    if (other == username || !content.is_object() || !content.contains("position") || !content["position"].is_object()) return;
+    nlohmann::json const& position = content["position"];
+    std::lock_guard<std::mutex> lock(mutex);
+    others[other] = { position.value("x", 0.0f), position.value("y", 0.0f), position.value("z", 0.0f) };
+}
+
+void Bot::handle_chat(std::string const& sender, std::string const& content) {
+    std::istringstream in(content);
+    std::string prefix;
+    int sequence = 0;
+    int64_t sent_ns = 0;
+    if (!(in >> prefix >> sequence >> sent_ns) || prefix != "bot") return;
+
+    statistics.add_chat_latency((now_ns() - sent_ns) * 1e-6);
+    std::lock_guard<std::mutex> lock(mutex);
+    int& last = chat_sequences[sender];
+    if (sequence > last + 1 && last > 0)
+        statistics.count_dropped(sequence - last - 1);
+    last = std::max(last, sequence);
+}
+
+void Bot::handle_pong(std::string const& payload) {
+    char* end = nullptr;
+    long long const sent_ns = std::strtoll(payload.c_str(), &end, 10);
+    if (end == payload.c_str()) return;
+    statistics.add_rtt((now_ns() - sent_ns) * 1e-6);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "bot_settings.hpp"
+#include "bot_statistics.hpp"
+#include "player.hpp"
+#include "login/websocket_service.hpp"
+
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+// Simulated player of the load test
+//  Each bot has its own WebSocketService connection and moves a Player with the same step() and collisions as the game:
+//  it wanders between random floor cells of the layout, sends its state at the rate of the game (UPDATE, or INPUT for the
+//  server simulation), shoots the nearest player it knows about, chats and pings the server. With --udp, the states go
+//  through the UDP channel (the other messages stay on the WebSocket).
+//  CHAT messages carry a sequence number and the send time: the other bots of the process measure the delivery latency
+//  and count the missing messages.
+class Bot {
+public:
+    Bot(int index, BotSettings const& settings, Apartment* apartment, std::vector<cgp::vec2> const& floor_cells, BotStatistics& statistics);
+
+    // Connect as bot<index> to the room of the bot (false if the connection failed)
+    bool connect();
+    void disconnect();
+    bool connected() const { return connection.isConnected(); }
+    bool udp_established() const { return connection.isUdpEstablished(); }
+    UdpChannel::Statistics udp_statistics() const { return connection.udpStatistics(); }
+
+    // Move the player by dt, then send the state and the actions that are due (stepping thread)
+    void step(float dt);
+
+private:
+    // Reading thread
+    void handle_message(std::string const& message);
+    void handle_state(std::string const& username, nlohmann::json const& content);
+    void handle_chat(std::string const& username, std::string const& content);
+    void handle_pong(std::string const& payload);
+
+    void send(nlohmann::json const& message, bool state = false); // A state is sent by UDP once the channel is open
+    void send_state();
+    void shoot();
+    void chat();
+    void choose_target();
+    float next_interval(float mean);
+
+    std::string const username;
+    std::string const room_id;
+    BotSettings const& settings;
+    std::vector<cgp::vec2> const& floor_cells;   // Centers of the walkable cells of the layout
+    BotStatistics& statistics;
+
+    WebSocketService connection;
+    bool was_connected = false;
+    Player player;
+    PlayerInput input;
+    std::mt19937 random;
+
+    cgp::vec2 target;                   // Floor cell the bot walks to
+    float stuck_timer = 0.0f;           // Time without getting closer to the target
+    float target_distance = 0.0f;
+    float shoot_timer = 0.0f;
+    float chat_timer = 0.0f;
+    float ping_timer = 0.0f;
+    float respawn_timer = 0.0f;
+    bool shooting = false;              // Shot during this step
+    int chat_sequence = 0;
+
+    // Written by the reading thread
+    std::mutex mutex;
+    std::map<std::string, cgp::vec3> others;        // Last known positions of the other players
+    std::map<std::string, int> chat_sequences;      // Last CHAT number received from each bot
+    int health = 100;
+};
@@ -0,0 +1,30 @@
+#include "bot_settings.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+BotSettings BotSettings::from_command_line(int argc, char* argv[]) {
+    BotSettings settings;
+    for (int k = 1; k < argc; ++k) {
+        std::string const arg = argv[k];
+        bool const has_value = k + 1 < argc;
+        if (arg == "--url" && has_value) settings.url = argv[++k];
+        else if (arg == "--bots" && has_value) settings.bots = std::max(1, std::atoi(argv[++k]));
+        else if (arg == "--per-room" && has_value) settings.per_room = std::max(1, std::atoi(argv[++k]));
+        else if (arg == "--room-prefix" && has_value) settings.room_prefix = argv[++k];
+        else if (arg == "--threads" && has_value) settings.threads = std::max(1, std::atoi(argv[++k]));
+        else if (arg == "--rate" && has_value) settings.rate = std::max(1, std::atoi(argv[++k]));
+        else if (arg == "--ramp" && has_value) settings.ramp = std::max(0.0f, float(std::atof(argv[++k])));
+        else if (arg == "--duration" && has_value) settings.duration = std::max(0.0f, float(std::atof(argv[++k])));
+        else if (arg == "--report" && has_value) settings.report_period = std::max(0.1f, float(std::atof(argv[++k])));
+        else if (arg == "--layout" && has_value) settings.layout = argv[++k];
+        else if (arg == "--input") settings.send_input = true;
+        else if (arg == "--udp") settings.udp = true;
+        else if (arg == "--udp-loss" && has_value) settings.udp_loss = std::min(1.0f, std::max(0.0f, float(std::atof(argv[++k]))));
+        else if (arg == "--shoot" && has_value) settings.shoot_interval = std::max(0.0f, float(std::atof(argv[++k])));
+        else if (arg == "--chat" && has_value) settings.chat_interval = std::max(0.0f, float(std::atof(argv[++k])));
+        else if (arg == "--ping" && has_value) settings.ping_interval = std::max(0.0f, float(std::atof(argv[++k])));
+    }
+    settings.network = NetworkConditions::from_command_line(argc, argv);
+    return settings;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "login/network_conditioner.hpp"
+
+#include <string>
+
+// Options of the load test bots
+//  Command line: agon_bots [--url ws://host:port/ws] [--bots N] [--per-room N] [--room-prefix name] [--threads N] [--rate Hz]
+//                [--ramp bots/s] [--duration seconds] [--report seconds] [--layout file.csv] [--input]
+//                [--shoot seconds] [--chat seconds] [--ping seconds] [--udp [--udp-loss p]]
+//                [--net-latency ms] [--net-jitter ms] [--net-bandwidth kbit/s] [--net-reorder p] [--net-loss p]
+struct BotSettings {
+    std::string url = "ws://localhost:4500/ws";
+    int bots = 100;
+    int per_room = 4;                       // Bots in the same room (bots<k>_0, bots<k>_1, ...)
+    std::string room_prefix = "bots";
+    int threads = 2;                        // Threads stepping the bots (each bot also has its own reading thread)
+    int rate = 30;                          // Simulation steps and state messages per second of every bot
+    float ramp = 20.0f;                     // Connections per second (0: all at once)
+    float duration = 60.0f;                 // Seconds after the last connection (0: until Ctrl+C)
+    float report_period = 2.0f;
+    std::string layout = "assets/layout.csv";
+    bool send_input = false;                // Send INPUT (server simulation) instead of UPDATE (client positions, like the game)
+    bool udp = false;                       // Ask for the UDP channel of the states
+    float udp_loss = 0.0f;                  // Simulated loss of the UDP datagrams (both directions)
+    NetworkConditions network;              // Simulated network of every bot (both directions)
+
+    // Mean interval between two actions of a bot (0: never)
+    float shoot_interval = 1.0f;
+    float chat_interval = 5.0f;
+    float ping_interval = 1.0f;
+
+    // Parse the bot options (unknown arguments are ignored)
+    static BotSettings from_command_line(int argc, char* argv[]);
+};
@@ -0,0 +1,102 @@
+#include "bot_statistics.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+void BotStatistics::count_sent(std::size_t bytes) {
+    sent.fetch_add(1, std::memory_order_relaxed);
+    bytes_sent.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void BotStatistics::count_received(std::size_t bytes) {
+    received.fetch_add(1, std::memory_order_relaxed);
+    bytes_received.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void BotStatistics::add_rtt(double ms) {
+    std::lock_guard<std::mutex> lock(mutex);
+    rtt.push_back(ms);
+}
+
+void BotStatistics::add_chat_latency(double ms) {
+    std::lock_guard<std::mutex> lock(mutex);
+    chat_latency.push_back(ms);
+}
+
+void BotStatistics::add_step_lateness(double ms) {
+    std::lock_guard<std::mutex> lock(mutex);
+    step_lateness_max = std::max(step_lateness_max, ms);
+}
+
+BotStatistics::Percentiles BotStatistics::percentiles(std::vector<double> samples) {
+    Percentiles result;
+    result.count = samples.size();
+    if (samples.empty()) return result;
+    std::sort(samples.begin(), samples.end());
+    auto const at = [&samples](double q) { return samples[std::min(samples.size() - 1, std::size_t(q * samples.size()))]; };
+    result.p50 = at(0.50);
+    result.p90 = at(0.90);
+    result.p99 = at(0.99);
+    result.max = samples.back();
+    return result;
+}
+
+BotStatistics::Report BotStatistics::take() {
+    Report report;
+    report.sent = sent.exchange(0);
+    report.received = received.exchange(0);
+    report.bytes_sent = bytes_sent.exchange(0);
+    report.bytes_received = bytes_received.exchange(0);
+    report.errors = errors.exchange(0);
+    report.dropped = dropped.exchange(0);
+    report.disconnections = disconnections.exchange(0);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    report.rtt = percentiles(rtt);
+    report.chat_latency = percentiles(chat_latency);
+    report.step_lateness_max = step_lateness_max;
+
+    all_rtt.insert(all_rtt.end(), rtt.begin(), rtt.end());
+    all_chat_latency.insert(all_chat_latency.end(), chat_latency.begin(), chat_latency.end());
+    rtt.clear();
+    chat_latency.clear();
+    step_lateness_max = 0.0;
+
+    total.sent += report.sent;
+    total.received += report.received;
+    total.bytes_sent += report.bytes_sent;
+    total.bytes_received += report.bytes_received;
+    total.errors += report.errors;
+    total.dropped += report.dropped;
+    total.disconnections += report.disconnections;
+    total.step_lateness_max = std::max(total.step_lateness_max, report.step_lateness_max);
+    return report;
+}
+
+BotStatistics::Report BotStatistics::summary() {
+    take();
+    std::lock_guard<std::mutex> lock(mutex);
+    Report report = total;
+    report.rtt = percentiles(all_rtt);
+    report.chat_latency = percentiles(all_chat_latency);
+    return report;
+}
+
+static void write_percentiles(std::ostream& out, char const* name, BotStatistics::Percentiles const& p) {
+    out << name << " p50 " << p.p50 << " p90 " << p.p90 << " p99 " << p.p99 << " max " << p.max << " ms (" << p.count << ")";
+}
+
+std::string BotStatistics::format(Report const& report, double elapsed) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1)
+        << "sent " << report.sent / elapsed << " msg/s (" << report.bytes_sent / elapsed / 1024.0 << " KB/s)"
+        << ", received " << report.received / elapsed << " msg/s (" << report.bytes_received / elapsed / 1024.0 << " KB/s)"
+        << " | ";
+    write_percentiles(out, "rtt", report.rtt);
+    out << " | ";
+    write_percentiles(out, "chat", report.chat_latency);
+    out << " | dropped " << report.dropped << ", errors " << report.errors << ", disconnections " << report.disconnections
+        << " | step lateness max " << report.step_lateness_max << " ms";
+    return out.str();
+}
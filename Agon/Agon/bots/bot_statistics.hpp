@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Counters and latency samples of all the bots (thread safe: updated by the stepping and the reading threads)
+class BotStatistics {
+public:
+    void count_sent(std::size_t bytes);
+    void count_received(std::size_t bytes);
+    void count_error() { errors.fetch_add(1, std::memory_order_relaxed); }
+    void count_dropped(int count) { dropped.fetch_add(count, std::memory_order_relaxed); }
+    void count_disconnection() { disconnections.fetch_add(1, std::memory_order_relaxed); }
+
+    // Latencies (ms)
+    void add_rtt(double ms);            // WebSocket ping -> pong
+    void add_chat_latency(double ms);   // CHAT of a bot -> server -> other bot of the process (same clock)
+    void add_step_lateness(double ms);  // Delay of a stepping thread behind its schedule (the client is overloaded)
+
+    struct Percentiles {
+        std::size_t count = 0;
+        double p50 = 0.0, p90 = 0.0, p99 = 0.0, max = 0.0;
+    };
+    static Percentiles percentiles(std::vector<double> samples);
+
+    struct Report {
+        uint64_t sent = 0, received = 0;
+        uint64_t bytes_sent = 0, bytes_received = 0;
+        uint64_t errors = 0;                // ERROR messages and failed sends
+        uint64_t dropped = 0;               // Missing CHAT messages in the sequence of a sender
+        uint64_t disconnections = 0;
+        Percentiles rtt, chat_latency;
+        double step_lateness_max = 0.0;
+    };
+    // Measures since the previous call (the samples are also kept for summary())
+    Report take();
+    // Measures since the start
+    Report summary();
+
+    static std::string format(Report const& report, double elapsed);
+
+private:
+    std::atomic<uint64_t> sent{0}, received{0};
+    std::atomic<uint64_t> bytes_sent{0}, bytes_received{0};
+    std::atomic<uint64_t> errors{0}, dropped{0}, disconnections{0};
+
+    std::mutex mutex;
+    std::vector<double> rtt, chat_latency;
+    double step_lateness_max = 0.0;
+    Report total;                           // Counters of the previous reports
+    std::vector<double> all_rtt, all_chat_latency;
+};
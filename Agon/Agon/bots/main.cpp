@@ -0,0 +1,159 @@
+#include "bot.hpp"
+#include "bot_settings.hpp"
+#include "bot_statistics.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Headless load test of the game server
+//  Run from the Agon directory (for assets/layout.csv) against a local agon_server, e.g.
+//  agon_bots --url ws://localhost:4500/ws --bots 400 --per-room 4 --ramp 20
+//  The bots connect progressively (--ramp): the reports show the player count at which the latencies, the drops or the
+//  lateness of the bots (client side overload) start to grow.
+
+static std::atomic<bool> interrupted{ false };
+
+// Centers of the floor cells away from the walls (reachable by the center of a player)
+static std::vector<cgp::vec2> floor_cells(std::string const& layout_filename) {
+    std::vector<std::vector<char>> const grid = Apartment::load_layout_from_csv(layout_filename);
+    int const rows = int(grid.size());
+    int cols = 0;
+    for (auto const& row : grid)
+        cols = std::max(cols, int(row.size()));
+
+    auto const is_floor = [&grid, rows](int i, int j) {
+        return i >= 0 && i < rows && j >= 0 && j < int(grid[i].size()) && grid[i][j] == '.';
+    };
+    std::vector<cgp::vec2> cells;
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < int(grid[i].size()); ++j) {
+            bool open = true;
+            for (int di = -1; di <= 1; ++di)
+                for (int dj = -1; dj <= 1; ++dj)
+                    open = open && is_floor(i + di, j + dj);
+            if (open)
+                cells.push_back({ j + 0.5f - cols / 2.0f, i + 0.5f - rows / 2.0f });
+        }
+    }
+    return cells;
+}
+
+int main(int argc, char* argv[]) {
+    BotSettings const settings = BotSettings::from_command_line(argc, argv);
+    std::signal(SIGINT, [](int) { interrupted = true; });
+    std::signal(SIGTERM, [](int) { interrupted = true; });
+
+    Apartment apartment;
+    apartment.initialize_collision(settings.layout);
+    std::vector<cgp::vec2> const cells = floor_cells(settings.layout);
+    if (apartment.wall_positions.empty() || cells.empty()) {
+        std::cerr << "Cannot load the layout " << settings.layout << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    BotStatistics statistics;
+    std::vector<std::unique_ptr<Bot>> bots;
+    for (int k = 0; k < settings.bots; ++k)
+        bots.push_back(std::make_unique<Bot>(k, settings, &apartment, cells, statistics));
+
+    std::cout << "Agon bots: " << settings.bots << " bots (" << settings.per_room << " per room) on " << settings.url << ", "
+              << settings.rate << " states/s, " << (settings.send_input ? "INPUT" : "UPDATE") << " messages" << std::endl;
+
+    // The bots are connected progressively, and only the connected ones are stepped
+    std::atomic<int> started{ 0 };
+    std::atomic<bool> running{ true };
+    std::thread connecting([&]() {
+        for (auto& bot : bots) {
+            if (!running) return;
+            bot->connect();
+            started++;
+            if (settings.ramp > 0)
+                std::this_thread::sleep_for(std::chrono::duration<float>(1.0f / settings.ramp));
+        }
+    });
+
+    // Fixed-rate stepping threads, each one running a share of the bots
+    auto const period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / settings.rate));
+    std::vector<std::thread> stepping;
+    for (int t = 0; t < settings.threads; ++t) {
+        stepping.emplace_back([&, t]() {
+            float const dt = std::chrono::duration<float>(period).count();
+            auto next = std::chrono::steady_clock::now();
+            while (running) {
+                int const count = started;
+                for (int k = t; k < count; k += settings.threads)
+                    bots[k]->step(dt);
+
+                next += period;
+                auto const now = std::chrono::steady_clock::now();
+                if (now > next) {
+                    // Late: the bots of this thread did not fit in their period (the late steps are not run in a burst)
+                    statistics.add_step_lateness(std::chrono::duration<double, std::milli>(now - next).count());
+                    next = now;
+                }
+                std::this_thread::sleep_until(next);
+            }
+        });
+    }
+
+    // Reports, until the end of the test duration after the last connection
+    auto const start = std::chrono::steady_clock::now();
+    auto last_report = start;
+    bool all_started = false;
+    auto end = start;
+    while (!interrupted) {
+        std::this_thread::sleep_for(std::chrono::duration<float>(settings.report_period));
+        auto const now = std::chrono::steady_clock::now();
+        double const elapsed = std::chrono::duration<double>(now - last_report).count();
+        last_report = now;
+
+        int connected = 0;
+        for (int k = 0; k < started; ++k)
+            if (bots[k]->connected()) connected++;
+        std::cout << "[bots] connected " << connected << "/" << settings.bots << " | "
+                  << BotStatistics::format(statistics.take(), elapsed) << std::endl;
+
+        if (started == settings.bots && !all_started) {
+            all_started = true;
+            end = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(settings.duration));
+        }
+        if (all_started && settings.duration > 0 && now >= end)
+            break;
+    }
+
+    running = false;
+    connecting.join();
+    for (auto& thread : stepping)
+        thread.join();
+
+    // Datagrams of the UDP channels (--udp), before the disconnections close them
+    int udp_established = 0;
+    UdpChannel::Statistics udp;
+    for (auto& bot : bots) {
+        if (bot->udp_established()) udp_established++;
+        UdpChannel::Statistics const statistics = bot->udp_statistics();
+        udp.sent += statistics.sent;
+        udp.received += statistics.received;
+        udp.acknowledged += statistics.acknowledged;
+        udp.lost += statistics.lost;
+        udp.late += statistics.late;
+        udp.simulated_drops += statistics.simulated_drops;
+    }
+    for (auto& bot : bots)
+        bot->disconnect();
+
+    double const total_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[bots] summary over " << total_time << " s | " << BotStatistics::format(statistics.summary(), total_time) << std::endl;
+    if (settings.udp) {
+        std::cout << "[bots] udp established " << udp_established << "/" << settings.bots << " | sent " << udp.sent
+                  << ", acknowledged " << udp.acknowledged << ", lost " << udp.lost << " | received " << udp.received
+                  << ", late " << udp.late << " | simulated drops " << udp.simulated_drops << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
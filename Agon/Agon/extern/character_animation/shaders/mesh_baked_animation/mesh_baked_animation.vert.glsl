@@ -0,0 +1,96 @@
+#version 330 core
+
+// Vertex shader - GPU skinning of an instanced crowd from baked skinning matrices
+//
+// The skinning matrices of every sampled frame are stored in animation_texture:
+//   texel (3*joint+row, frame) = row of the skinning matrix (joint_global * inverse_bind) of the joint
+// Each instance only carries its placement and the frame range of its clip, the current frame is deduced from the time.
+
+// Inputs coming from VBOs
+layout (location = 0) in vec3 vertex_position; // vertex position in bind pose (x,y,z)
+layout (location = 1) in vec3 vertex_normal;   // vertex normal in bind pose   (nx,ny,nz)
+layout (location = 2) in vec3 vertex_color;    // vertex color      (r,g,b)
+layout (location = 3) in vec2 vertex_uv;       // vertex uv-texture (u,v)
+layout (location = 4) in vec4 vertex_joint_index;  // index of the 4 most influent joints
+layout (location = 5) in vec4 vertex_joint_weight; // associated skinning weights (sum=1)
+layout (location = 6) in vec4 instance_placement;  // per-instance: position (x,y,z) and rotation angle around the y axis
+layout (location = 7) in vec4 instance_animation;  // per-instance: first frame, frame count, time offset
+
+// Output variables sent to the fragment shader
+out struct fragment_data
+{
+    vec3 position; // vertex position in world space
+    vec3 normal;   // normal position in world space
+    vec3 color;    // vertex color
+    vec2 uv;       // vertex uv
+} fragment;
+
+// Uniform variables expected to receive from the C++ program
+uniform mat4 model; // Model affine transform matrix associated to the current shape
+uniform mat4 view;  // View matrix (rigid transform) of the camera
+uniform mat4 projection; // Projection (perspective or orthogonal) matrix of the camera
+
+uniform sampler2D animation_texture; // Baked skinning matrices
+uniform float animation_time;        // Current time (in seconds)
+uniform float animation_sample_rate; // Number of baked frames per second
+
+
+// Accumulate the weighted skinning matrices (stored as 3 rows) of the 4 joints at the given frame
+void accumulate_skinning(int frame, float frame_weight, inout vec4 row_x, inout vec4 row_y, inout vec4 row_z)
+{
+	for(int k=0; k<4; ++k) {
+		float w = frame_weight * vertex_joint_weight[k];
+		int column = 3*int(vertex_joint_index[k]);
+		row_x += w * texelFetch(animation_texture, ivec2(column  , frame), 0);
+		row_y += w * texelFetch(animation_texture, ivec2(column+1, frame), 0);
+		row_z += w * texelFetch(animation_texture, ivec2(column+2, frame), 0);
+	}
+}
+
+void main()
+{
+	// Frame of the clip (looping) and interpolation between the two closest baked frames
+	int first_frame = int(instance_animation.x);
+	int frame_count = int(instance_animation.y);
+	float f = mod((animation_time + instance_animation.z) * animation_sample_rate, float(frame_count));
+	int f0 = int(floor(f));
+	int f1 = (f0+1) % frame_count;
+	float alpha = f - float(f0);
+
+	vec4 row_x = vec4(0.0);
+	vec4 row_y = vec4(0.0);
+	vec4 row_z = vec4(0.0);
+	accumulate_skinning(first_frame+f0, 1.0-alpha, row_x, row_y, row_z);
+	accumulate_skinning(first_frame+f1, alpha, row_x, row_y, row_z);
+
+	// Linear blend skinning
+	vec4 p0 = vec4(vertex_position, 1.0);
+	vec4 n0 = vec4(vertex_normal, 0.0);
+	vec3 p_skinned = vec3(dot(row_x, p0), dot(row_y, p0), dot(row_z, p0));
+	vec3 n_skinned = vec3(dot(row_x, n0), dot(row_y, n0), dot(row_z, n0));
+
+	// Placement of the instance: rotation around the y axis, then translation
+	float c = cos(instance_placement.w);
+	float s = sin(instance_placement.w);
+	mat3 R = mat3(c, 0.0, -s,  0.0, 1.0, 0.0,  s, 0.0, c);
+	vec3 p_instance = R * p_skinned + instance_placement.xyz;
+	vec3 n_instance = R * n_skinned;
+
+	// The position of the vertex in the world space
+	vec4 position = model * vec4(p_instance, 1.0);
+
+	// The normal of the vertex in the world space
+	mat4 modelNormal = transpose(inverse(model));
+	vec4 normal = modelNormal * vec4(n_instance, 0.0);
+
+	// The projected position of the vertex in the normalized device coordinates:
+	vec4 position_projected = projection * view * position;
+
+	// Fill the parameters sent to the fragment shader
+	fragment.position = position.xyz;
+	fragment.normal   = normal.xyz;
+	fragment.color = vertex_color;
+	fragment.uv = vertex_uv;
+
+	gl_Position = position_projected;
+}
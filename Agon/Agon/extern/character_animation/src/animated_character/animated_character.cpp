@@ -8,6 +8,9 @@ void character_structure::load_and_initialize(filename_loader_structure const& p
 	for(auto const& entry: animated_model.rigged_mesh){
 		std::string name = entry.first;
 		drawable[name].initialize_data_on_gpu(entry.second.mesh_deformed);
+		// The skinned positions and normals are re-sent at every frame
+		drawable[name].vbo_position.set_update_mode(opengl_vbo_update_mode::stream);
+		drawable[name].vbo_normal.set_update_mode(opengl_vbo_update_mode::stream);
 		drawable[name].texture.load_and_initialize_texture_2d_on_gpu(param_loader.loader_rigged_mesh.at(name).texture);
 	}
 	
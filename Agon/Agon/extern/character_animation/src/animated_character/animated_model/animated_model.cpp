@@ -72,12 +72,12 @@ void animated_model_structure::apply_transformation(vec3 const& translation, rot
     }
 
     for(auto& anim_entry : animation) {
-        auto& animation_matrices = anim_entry.second.matrix;
-        for(int kt=0; kt<animation_matrices[0].size(); ++kt) {
-            mat4& M = animation_matrices[0][kt];
-            M = rotation*M;
-            M.apply_scaling_to_block_linear(scaling);
-            M.apply_translation(translation);
+        auto& animation_keyframe = anim_entry.second.keyframe;
+        for(int kt=0; kt<animation_keyframe[0].size(); ++kt) {
+            affine_rts& K = animation_keyframe[0][kt];
+            K.rotation = rotation*K.rotation;
+            K.translation = rotation*K.translation + translation;
+            K.scaling *= scaling;
         }
     }
 
@@ -0,0 +1,168 @@
+#include "animation_baked.hpp"
+
+#include <algorithm>
+
+using namespace cgp;
+
+static void joint_influence_vec4(numarray<skinning_weight_info> const& dependence, vec4& joint_index, vec4& weight);
+
+void animation_baked_structure::bake(animated_model_structure const& animated_model, std::string const& mesh_name, float sample_rate_arg)
+{
+    clear();
+    sample_rate = sample_rate_arg;
+
+    controller_skinning_structure const& controller_skinning = animated_model.rigged_mesh.at(mesh_name).controller_skinning;
+    number_of_joints = controller_skinning.inverse_bind_matrices.size();
+
+    // Fill the frame range of each clip
+    int total_frame = 0;
+    for(auto const& entry : animated_model.animation) {
+        baked_clip_info info;
+        info.name = entry.first;
+        info.duration = entry.second.time_max;
+        info.first_frame = total_frame;
+        info.frame_count = std::max(1, int(std::ceil(info.duration*sample_rate)));
+        total_frame += info.frame_count;
+        clip.push_back(info);
+    }
+
+    texture_data.resize(3*number_of_joints, total_frame);
+
+    // Sample the animations on a local copy of the skeleton
+    skeleton_structure skeleton = animated_model.skeleton;
+    for(baked_clip_info const& info : clip) {
+        skeleton_animation_structure const& animation = animated_model.animation.at(info.name);
+        int const N_joint_animation = animation.joint_index.size();
+
+        for(int k_frame=0; k_frame<info.frame_count; ++k_frame) {
+            float const t = k_frame/sample_rate;
+            for(int k=0; k<N_joint_animation; ++k)
+                skeleton.joint_matrix_local[animation.joint_index[k]] = animation.evaluate(k, t);
+            skeleton.update_joint_matrix_local_to_global();
+
+            int const row = info.first_frame + k_frame;
+            for(int k_joint=0; k_joint<number_of_joints; ++k_joint) {
+                int const joint_index_in_skeleton = controller_skinning.rig_index_to_skeleton_index[k_joint];
+                mat4 const M = skeleton.joint_matrix_global[joint_index_in_skeleton] * controller_skinning.inverse_bind_matrices[k_joint];
+                for(int k_row=0; k_row<3; ++k_row)
+                    texture_data(3*k_joint+k_row, row) = { M(k_row,0), M(k_row,1), M(k_row,2), M(k_row,3) };
+            }
+        }
+    }
+
+    GLint max_texture_size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+    if(texture_data.dimension.x>max_texture_size || texture_data.dimension.y>max_texture_size) {
+        warning_cgp("Baked animation texture exceeds the maximal texture size", "Texture size: "+str(texture_data.dimension)+", decrease the sample rate or the number of animations");
+    }
+
+    texture.initialize_texture_2d_on_gpu(texture_data, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, false, GL_NEAREST, GL_NEAREST);
+}
+
+int animation_baked_structure::clip_index(std::string const& animation_name) const
+{
+    for(int k=0; k<clip.size(); ++k)
+        if(clip[k].name==animation_name)
+            return k;
+    return -1;
+}
+
+void animation_baked_structure::clear()
+{
+    if(texture.id!=0)
+        texture.clear();
+    texture_data.clear();
+    clip.clear();
+    number_of_joints = 0;
+}
+
+
+void crowd_drawable::initialize(animated_model_structure const& animated_model, std::string const& mesh_name, opengl_shader_structure const& shader, opengl_texture_image_structure const& texture, float sample_rate)
+{
+    clear();
+    baked.bake(animated_model, mesh_name, sample_rate);
+
+    rigged_mesh_structure const& rigged_mesh = animated_model.rigged_mesh.at(mesh_name);
+    drawable.initialize_data_on_gpu(rigged_mesh.mesh_bind_pose, shader, texture);
+    drawable.supplementary_texture["animation_texture"] = baked.texture;
+
+    // Per-vertex skinning influences (limited to the 4 most influent joints)
+    int const N_vertex = rigged_mesh.mesh_bind_pose.position.size();
+    numarray<vec4> joint_index(N_vertex);
+    numarray<vec4> joint_weight(N_vertex);
+    for(int k_vertex=0; k_vertex<N_vertex; ++k_vertex)
+        joint_influence_vec4(rigged_mesh.controller_skinning.vertex_to_joint_dependence[k_vertex], joint_index[k_vertex], joint_weight[k_vertex]);
+    drawable.initialize_supplementary_data_on_gpu(joint_index, 4);
+    drawable.initialize_supplementary_data_on_gpu(joint_weight, 5);
+
+    instance_capacity = 0;
+    update_instances();
+}
+
+void crowd_drawable::update_instances()
+{
+    int const N_instance = instances.size();
+    numarray<vec4> placement(std::max(N_instance, 1));
+    numarray<vec4> animation(std::max(N_instance, 1));
+    for(int k=0; k<N_instance; ++k) {
+        crowd_instance const& instance = instances[k];
+        baked_clip_info const& info = baked.clip[instance.clip];
+        placement[k] = { instance.position, instance.angle };
+        animation[k] = { float(info.first_frame), float(info.frame_count), instance.time_offset, 0.0f };
+    }
+
+    // Reallocate the per-instance buffers only when the number of instances exceeds their capacity
+    if(N_instance>instance_capacity || instance_capacity==0) {
+        if(drawable.supplementary_vbo.size()>3) {
+            drawable.supplementary_vbo[2].clear();
+            drawable.supplementary_vbo[3].clear();
+        }
+        drawable.initialize_supplementary_data_on_gpu(placement, 6, 1);
+        drawable.initialize_supplementary_data_on_gpu(animation, 7, 1);
+        instance_capacity = placement.size();
+    }
+    else {
+        drawable.update_supplementary_data_on_gpu(placement, 6);
+        drawable.update_supplementary_data_on_gpu(animation, 7);
+    }
+}
+
+void crowd_drawable::clear()
+{
+    if(drawable.vao!=0)
+        drawable.clear();
+    baked.clear();
+    instance_capacity = 0;
+}
+
+void draw(crowd_drawable const& crowd, environment_generic_structure const& environment, float time)
+{
+    if(crowd.instances.size()==0)
+        return;
+
+    uniform_generic_structure uniforms;
+    uniforms.uniform_float["animation_time"] = time;
+    uniforms.uniform_float["animation_sample_rate"] = crowd.baked.sample_rate;
+
+    draw(crowd.drawable, environment, crowd.instances.size(), true, uniforms);
+}
+
+
+// Keep the 4 largest weights of the vertex and normalize their sum to 1
+static void joint_influence_vec4(numarray<skinning_weight_info> const& dependence, vec4& joint_index, vec4& weight)
+{
+    std::vector<skinning_weight_info> sorted(dependence.begin(), dependence.end());
+    std::sort(sorted.begin(), sorted.end(), [](skinning_weight_info const& a, skinning_weight_info const& b) { return a.weight > b.weight; });
+
+    joint_index = { 0,0,0,0 };
+    weight = { 0,0,0,0 };
+    float sum = 0.0f;
+    int const N = std::min(int(sorted.size()), 4);
+    for(int k=0; k<N; ++k) {
+        joint_index[k] = float(sorted[k].joint_index);
+        weight[k] = sorted[k].weight;
+        sum += sorted[k].weight;
+    }
+    if(sum>1e-6f)
+        weight /= sum;
+}
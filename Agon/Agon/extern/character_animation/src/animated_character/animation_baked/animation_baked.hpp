@@ -0,0 +1,74 @@
+#pragma once
+
+#include "cgp/cgp.hpp"
+
+#include "../animated_model/animated_model.hpp"
+
+
+// Range of rows of the baked texture associated to one animation clip
+struct baked_clip_info {
+    std::string name;     // Name of the animation in animated_model_structure::animation
+    int first_frame = 0;  // Row of the first sampled frame in the texture
+    int frame_count = 0;  // Number of sampled frames of the clip (the clip is played as a loop)
+    float duration = 0.0f; // Duration of the clip (in seconds)
+};
+
+// Skinning matrices of all the animations of a rigged mesh, sampled at a fixed rate and stored in a float texture
+//  - Each row of the texture is one sampled frame, the clips are stored one after the other
+//  - Each skinning matrix (joint_global * inverse_bind) is stored as its 3 first rows in 3 consecutive texels
+//     texture(3*k_joint+k_row, k_frame) = row k_row of the skinning matrix of the joint k_joint (rig index of the mesh)
+struct animation_baked_structure {
+
+    float sample_rate = 30.0f; // Number of sampled frames per second
+    int number_of_joints = 0;  // Number of joints impacting the rigged mesh
+    cgp::numarray<baked_clip_info> clip;
+
+    cgp::grid_2D<cgp::vec4> texture_data;          // CPU storage of the baked matrices
+    cgp::opengl_texture_image_structure texture;   // GL_RGBA32F texture (nearest filtering, read with texelFetch)
+
+    // Sample every animation of the model for the designated rigged mesh and send the result to the GPU
+    //  The skeleton of the animated_model is not modified
+    void bake(animated_model_structure const& animated_model, std::string const& mesh_name, float sample_rate_arg = 30.0f);
+
+    // Return the index of the clip corresponding to the animation name (or -1 if it doesn't exist)
+    int clip_index(std::string const& animation_name) const;
+
+    void clear();
+};
+
+
+// Placement and animation state of one instance of the crowd
+struct crowd_instance {
+    cgp::vec3 position;       // Position of the root of the instance
+    float angle = 0.0f;       // Rotation around the vertical (y) axis
+    int clip = 0;             // Index of the clip in animation_baked_structure::clip
+    float time_offset = 0.0f; // Time offset (in seconds) of the instance in its clip
+};
+
+// Draw a set of characters sharing the same rigged mesh with a single instanced draw call
+//  The skinning is computed in the vertex shader from the baked skinning matrices: no per-character animation on the CPU
+//  Vertex attributes used in addition to the standard ones:
+//   - location 4: joint indices of the 4 most influent joints (per-vertex)
+//   - location 5: associated skinning weights (per-vertex)
+//   - location 6: instance placement (x,y,z,angle) (per-instance)
+//   - location 7: instance animation (first_frame, frame_count, time_offset, 0) (per-instance)
+struct crowd_drawable {
+
+    animation_baked_structure baked;
+    cgp::mesh_drawable drawable;
+    cgp::numarray<crowd_instance> instances;
+
+    // Bake the animations of the rigged mesh and initialize the drawable from its bind pose
+    void initialize(animated_model_structure const& animated_model, std::string const& mesh_name, cgp::opengl_shader_structure const& shader, cgp::opengl_texture_image_structure const& texture, float sample_rate = 30.0f);
+
+    // Send the current instances to the GPU (to be called after any change of the instances)
+    void update_instances();
+
+    void clear();
+
+private:
+    int instance_capacity = 0; // Number of instances allocated in the per-instance VBOs
+};
+
+// Draw all the instances at the given time (in seconds)
+void draw(crowd_drawable const& crowd, cgp::environment_generic_structure const& environment, float time);
@@ -0,0 +1,142 @@
+#include "animation_scheduler.hpp"
+
+#include <algorithm>
+
+using namespace cgp;
+
+static bool is_sphere_in_frustum(mat4 const& M_projection_view, vec3 const& center, float radius);
+static int update_period_from_distance(animation_scheduler_parameters const& parameters, float distance);
+
+std::vector<std::string> animation_scheduler_structure::start_frame(std::map<std::string, character_structure> const& characters, mat4 const& camera_view, mat4 const& camera_projection, std::string const& always_update)
+{
+    time_frame_start = std::chrono::steady_clock::now();
+    number_updated = 0;
+    number_skipped = 0;
+    number_culled = 0;
+    number_deferred = 0;
+    scheduled.clear();
+
+    vec3 const camera_position = inverse(camera_view).get_block_translation();
+    mat4 const M_projection_view = camera_projection * camera_view;
+
+    for(auto const& entry : characters) {
+        std::string const& name = entry.first;
+        skeleton_structure const& skeleton = entry.second.animated_model.skeleton;
+        animation_lod_state& state = lod[name];
+
+        state.frame_since_update++;
+        if(skeleton.joint_matrix_global.size()==0) {
+            continue;
+        }
+
+        vec3 const root = skeleton.joint_matrix_global[0].get_block_translation();
+        state.distance = norm(root-camera_position);
+        state.visible = is_sphere_in_frustum(M_projection_view, root, parameters.bounding_radius);
+        state.update_period = update_period_from_distance(parameters, state.distance);
+
+        if(parameters.active==false || name==always_update) {
+            state.visible = true;
+            state.update_period = 1;
+        }
+
+        if(state.visible==false) {
+            number_culled++;
+            continue;
+        }
+        if(state.frame_since_update < state.update_period) {
+            number_skipped++;
+            continue;
+        }
+        scheduled.push_back(name);
+    }
+
+    // Sort by priority: the forced character first, then the most late characters (relative to their update period), then the closest ones
+    std::map<std::string, animation_lod_state> const& lod_const = lod;
+    std::stable_sort(scheduled.begin(), scheduled.end(), [&](std::string const& a, std::string const& b) {
+        if(a==always_update || b==always_update)
+            return a==always_update && b!=always_update;
+        animation_lod_state const& la = lod_const.at(a);
+        animation_lod_state const& lb = lod_const.at(b);
+        int const late_a = la.frame_since_update - la.update_period;
+        int const late_b = lb.frame_since_update - lb.update_period;
+        if(late_a!=late_b)
+            return late_a > late_b;
+        return la.distance < lb.distance;
+    });
+
+    return scheduled;
+}
+
+bool animation_scheduler_structure::within_budget() const
+{
+    // At least one character is animated per frame to avoid starvation
+    if(parameters.active==false || number_updated==0)
+        return true;
+
+    float const elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - time_frame_start).count();
+    return elapsed < parameters.time_budget;
+}
+
+void animation_scheduler_structure::notify_updated(std::string const& character_name)
+{
+    lod[character_name].frame_since_update = 0;
+    number_updated++;
+}
+
+void animation_scheduler_structure::end_frame()
+{
+    number_deferred = int(scheduled.size()) - number_updated;
+    time_spent = std::chrono::duration<float>(std::chrono::steady_clock::now() - time_frame_start).count();
+}
+
+bool animation_scheduler_structure::is_visible(std::string const& character_name) const
+{
+    auto const it = lod.find(character_name);
+    if(it==lod.end())
+        return true;
+    return it->second.visible;
+}
+
+void animation_scheduler_structure::display_gui()
+{
+    ImGui::Checkbox("Animation LOD", &parameters.active);
+    ImGui::SliderFloat("Half rate distance", &parameters.distance_half_rate, 0.0f, 20.0f);
+    ImGui::SliderFloat("Quarter rate distance", &parameters.distance_quarter_rate, 0.0f, 40.0f);
+    float time_budget_ms = 1000.0f*parameters.time_budget;
+    if(ImGui::SliderFloat("Time budget (ms)", &time_budget_ms, 0.5f, 16.0f))
+        parameters.time_budget = time_budget_ms/1000.0f;
+
+    ImGui::Text("Updated: %d, Skipped: %d, Culled: %d, Deferred: %d", number_updated, number_skipped, number_culled, number_deferred);
+    ImGui::Text("Animation time: %.2f ms", 1000.0f*time_spent);
+}
+
+
+static int update_period_from_distance(animation_scheduler_parameters const& parameters, float distance)
+{
+    if(distance > parameters.distance_quarter_rate)
+        return 4;
+    if(distance > parameters.distance_half_rate)
+        return 2;
+    return 1;
+}
+
+// Test a sphere against the 6 planes of the view frustum extracted from the projection*view matrix
+static bool is_sphere_in_frustum(mat4 const& M, vec3 const& center, float radius)
+{
+    vec4 const row_x = { M(0,0), M(0,1), M(0,2), M(0,3) };
+    vec4 const row_y = { M(1,0), M(1,1), M(1,2), M(1,3) };
+    vec4 const row_z = { M(2,0), M(2,1), M(2,2), M(2,3) };
+    vec4 const row_w = { M(3,0), M(3,1), M(3,2), M(3,3) };
+
+    vec4 const planes[6] = { row_w+row_x, row_w-row_x, row_w+row_y, row_w-row_y, row_w+row_z, row_w-row_z };
+    for(int k=0; k<6; ++k) {
+        vec4 const& p = planes[k];
+        float const n = norm(vec3{p.x, p.y, p.z});
+        if(n<1e-6f)
+            continue;
+        float const signed_distance = (p.x*center.x + p.y*center.y + p.z*center.z + p.w)/n;
+        if(signed_distance < -radius)
+            return false;
+    }
+    return true;
+}
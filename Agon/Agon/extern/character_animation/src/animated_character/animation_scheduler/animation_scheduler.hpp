@@ -0,0 +1,65 @@
+#pragma once
+
+#include "cgp/cgp.hpp"
+
+#include "../animated_character.hpp"
+
+#include <chrono>
+
+
+// Level of detail of the animation of one character
+struct animation_lod_state {
+    int update_period = 1;       // The character is animated (skeleton + skinning) once every update_period frames (1, 2 or 4)
+    int frame_since_update = 0;  // Number of frames since the last animation update of the character
+    float distance = 0.0f;       // Distance between the camera and the character root
+    bool visible = true;         // Is the bounding sphere of the character inside the view frustum
+};
+
+struct animation_scheduler_parameters {
+    bool active = true;                // If false, every character is animated at every frame
+    float distance_half_rate = 6.0f;   // Beyond this distance, the character is animated every 2nd frame
+    float distance_quarter_rate = 12.0f; // Beyond this distance, the character is animated every 4th frame
+    float bounding_radius = 1.2f;      // Radius of the sphere (centered at the root joint) used for the frustum culling
+    float time_budget = 0.004f;        // Maximal time (in seconds) spent per frame to animate the characters
+};
+
+// Select which characters are animated at the current frame
+//  - Distant characters are animated at a reduced rate (and keep their last skinned pose in between)
+//  - Characters outside of the view frustum are not animated nor skinned
+//  - The total time spent in the animation of the characters is limited by a per-frame budget,
+//     the characters that did not fit in the budget get a higher priority at the next frame
+struct animation_scheduler_structure {
+
+    animation_scheduler_parameters parameters;
+    std::map<std::string, animation_lod_state> lod; // lod[character_name]
+
+    // Statistics of the last frame
+    int number_updated = 0;  // Characters animated
+    int number_skipped = 0;  // Visible characters waiting for their next update (reduced rate)
+    int number_culled = 0;   // Characters outside of the view frustum
+    int number_deferred = 0; // Characters that should have been animated but did not fit in the time budget
+    float time_spent = 0.0f; // Time (in seconds) spent between start_frame and end_frame
+
+    // Update the LOD of all the characters and return the names of the characters that should be animated at this frame, sorted by decreasing priority
+    //  - The character named always_update (if any) is always animated first (ex. character controlled by the user)
+    std::vector<std::string> start_frame(std::map<std::string, character_structure> const& characters, cgp::mat4 const& camera_view, cgp::mat4 const& camera_projection, std::string const& always_update = "");
+
+    // Return true while the time spent since start_frame is below the time budget
+    bool within_budget() const;
+
+    // Indicate that the character has been animated at this frame
+    void notify_updated(std::string const& character_name);
+
+    // Finalize the statistics of the frame
+    void end_frame();
+
+    // Return false if the character is outside of the view frustum (and doesn't need to be drawn)
+    bool is_visible(std::string const& character_name) const;
+
+    // Display the parameters and statistics in the GUI
+    void display_gui();
+
+private:
+    std::chrono::steady_clock::time_point time_frame_start;
+    std::vector<std::string> scheduled; // Characters scheduled at the current frame
+};
@@ -0,0 +1,434 @@
+#include "asset_binary.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#define ASSET_BINARY_USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace cgp;
+
+static char const asset_binary_magic[8] = { 'C','G','P','A','N','I','M','\0' };
+static uint32_t const asset_binary_version = 3; // 3: optimized meshes (mesh_optimize) - the older caches are rebuilt
+static uint32_t const asset_binary_endianness = 0x01020304;
+static size_t const asset_binary_alignment = 16;
+
+struct asset_binary_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t endianness;
+    uint32_t number_of_rigged_mesh;
+    uint32_t number_of_animation;
+    uint64_t source_key;
+};
+
+struct asset_binary_array_header {
+    uint64_t number_of_elements;
+    uint64_t element_size;
+};
+
+
+// ************************************************* //
+// Writer
+// ************************************************* //
+
+struct asset_binary_writer {
+    std::ofstream stream;
+    size_t offset = 0;
+
+    void write_raw(void const* data, size_t size) {
+        stream.write(static_cast<char const*>(data), std::streamsize(size));
+        offset += size;
+    }
+    void pad() {
+        static char const zero[asset_binary_alignment] = {};
+        size_t const remainder = offset % asset_binary_alignment;
+        if(remainder!=0)
+            write_raw(zero, asset_binary_alignment-remainder);
+    }
+    void write_array(void const* data, size_t number_of_elements, size_t element_size) {
+        asset_binary_array_header const header = { uint64_t(number_of_elements), uint64_t(element_size) };
+        write_raw(&header, sizeof(header));
+        pad();
+        if(number_of_elements>0)
+            write_raw(data, number_of_elements*element_size);
+        pad();
+    }
+
+    template <typename T>
+    void write(numarray<T> const& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written as raw data");
+        write_array(value.data.data(), value.size(), sizeof(T));
+    }
+    template <typename T>
+    void write_single(T const& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written as raw data");
+        write_array(&value, 1, sizeof(T));
+    }
+    void write(std::string const& value) {
+        write_array(value.data(), value.size(), 1);
+    }
+};
+
+
+// ************************************************* //
+// Reader
+// ************************************************* //
+
+// Read-only view of the content of a file (memory-mapped when available, otherwise read in a single call)
+struct asset_binary_file_view {
+    char const* data = nullptr;
+    size_t size = 0;
+
+    asset_binary_file_view() = default;
+    asset_binary_file_view(asset_binary_file_view const&) = delete;
+    asset_binary_file_view& operator=(asset_binary_file_view const&) = delete;
+
+    bool open(std::string const& filename) {
+#ifdef ASSET_BINARY_USE_MMAP
+        int const fd = ::open(filename.c_str(), O_RDONLY);
+        if(fd<0)
+            return false;
+        struct stat info;
+        if(fstat(fd, &info)!=0 || info.st_size==0) {
+            ::close(fd);
+            return false;
+        }
+        void* const mapped = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if(mapped==MAP_FAILED)
+            return false;
+        mapped_data = mapped;
+        data = static_cast<char const*>(mapped);
+        size = size_t(info.st_size);
+        return true;
+#else
+        std::ifstream stream(filename, std::ios::binary | std::ios::ate);
+        if(!stream.is_open())
+            return false;
+        buffer.resize(size_t(stream.tellg()));
+        stream.seekg(0);
+        stream.read(buffer.data(), std::streamsize(buffer.size()));
+        data = buffer.data();
+        size = buffer.size();
+        return bool(stream);
+#endif
+    }
+
+    ~asset_binary_file_view() {
+#ifdef ASSET_BINARY_USE_MMAP
+        if(mapped_data!=nullptr)
+            munmap(mapped_data, size);
+#endif
+    }
+
+private:
+#ifdef ASSET_BINARY_USE_MMAP
+    void* mapped_data = nullptr;
+#else
+    std::vector<char> buffer;
+#endif
+};
+
+struct asset_binary_reader {
+    char const* data = nullptr;
+    size_t size = 0;
+    size_t offset = 0;
+    bool valid = true;
+
+    void skip_padding() {
+        size_t const remainder = offset % asset_binary_alignment;
+        if(remainder!=0)
+            offset += asset_binary_alignment-remainder;
+    }
+    // Return a pointer to the raw data of the next array (nullptr if the file is truncated or the element size doesn't match)
+    char const* read_array(size_t element_size, size_t& number_of_elements) {
+        number_of_elements = 0;
+        if(!valid || offset+sizeof(asset_binary_array_header)>size) {
+            valid = false;
+            return nullptr;
+        }
+        asset_binary_array_header header;
+        std::memcpy(&header, data+offset, sizeof(header));
+        offset += sizeof(header);
+        skip_padding();
+
+        size_t const size_array = size_t(header.number_of_elements*header.element_size);
+        if(header.element_size!=element_size || offset+size_array>size) {
+            valid = false;
+            return nullptr;
+        }
+        char const* const array_data = data+offset;
+        offset += size_array;
+        skip_padding();
+
+        number_of_elements = size_t(header.number_of_elements);
+        return array_data;
+    }
+
+    template <typename T>
+    void read(numarray<T>& value) {
+        size_t N = 0;
+        char const* const array_data = read_array(sizeof(T), N);
+        value.resize(int(N));
+        if(N>0)
+            std::memcpy(value.data.data(), array_data, N*sizeof(T));
+    }
+    template <typename T>
+    void read_single(T& value) {
+        size_t N = 0;
+        char const* const array_data = read_array(sizeof(T), N);
+        if(N!=1) {
+            valid = false;
+            return;
+        }
+        std::memcpy(&value, array_data, sizeof(T));
+    }
+    void read(std::string& value) {
+        size_t N = 0;
+        char const* const array_data = read_array(1, N);
+        value.assign(array_data==nullptr ? "" : array_data, N);
+    }
+};
+
+
+// ************************************************* //
+// Texture filename relative to the binary file
+// ************************************************* //
+
+static std::string directory_of(std::string const& filename)
+{
+    size_t const position = filename.find_last_of("/\\");
+    if(position==std::string::npos)
+        return "";
+    return filename.substr(0, position+1);
+}
+
+static bool is_absolute_path(std::string const& path)
+{
+    return (path.size()>0 && (path[0]=='/' || path[0]=='\\')) || (path.size()>1 && path[1]==':');
+}
+
+
+// ************************************************* //
+// Save / Load
+// ************************************************* //
+
+void animated_model_save_binary(std::string const& filename, animated_model_structure const& animated_model, std::map<std::string, std::string> const& texture_filename, uint64_t source_key)
+{
+    asset_binary_writer writer;
+    writer.stream.open(filename, std::ios::binary);
+    if(!writer.stream.is_open()) {
+        warning_cgp("Cannot write the animated model binary file", filename);
+        return;
+    }
+
+    asset_binary_header header;
+    std::memcpy(header.magic, asset_binary_magic, sizeof(header.magic));
+    header.version = asset_binary_version;
+    header.endianness = asset_binary_endianness;
+    header.number_of_rigged_mesh = uint32_t(animated_model.rigged_mesh.size());
+    header.number_of_animation = uint32_t(animated_model.animation.size());
+    header.source_key = source_key;
+    writer.write_single(header);
+
+    // Skeleton
+    skeleton_structure const& skeleton = animated_model.skeleton;
+    int const N_joint = skeleton.joint_name.size();
+    numarray<int> joint_name_offset;
+    std::string joint_name_data;
+    for(int k=0; k<N_joint; ++k) {
+        joint_name_offset.push_back(int(joint_name_data.size()));
+        joint_name_data += skeleton.joint_name[k];
+    }
+    joint_name_offset.push_back(int(joint_name_data.size()));
+    writer.write(joint_name_offset);
+    writer.write(joint_name_data);
+    writer.write(skeleton.parent_index);
+    writer.write(skeleton.joint_matrix_local);
+
+    // Rigged meshes
+    std::string const directory = directory_of(filename);
+    for(auto const& entry : animated_model.rigged_mesh) {
+        std::string const& name = entry.first;
+        rigged_mesh_structure const& rigged_mesh = entry.second;
+        mesh const& shape = rigged_mesh.mesh_bind_pose;
+        controller_skinning_structure const& skinning = rigged_mesh.controller_skinning;
+
+        std::string texture;
+        if(texture_filename.count(name)>0) {
+            texture = texture_filename.at(name);
+            if(directory.size()>0 && texture.compare(0, directory.size(), directory)==0)
+                texture = texture.substr(directory.size());
+        }
+
+        writer.write(name);
+        writer.write(texture);
+        writer.write(shape.position);
+        writer.write(shape.normal);
+        writer.write(shape.color);
+        writer.write(shape.uv);
+        writer.write(shape.connectivity);
+
+        // Flatten the per-vertex skinning dependence
+        int const N_vertex = skinning.vertex_to_joint_dependence.size();
+        numarray<int> dependence_offset;
+        numarray<skinning_weight_info> dependence;
+        dependence_offset.resize(N_vertex+1);
+        for(int kv=0; kv<N_vertex; ++kv) {
+            dependence_offset[kv] = dependence.size();
+            for(skinning_weight_info const& info : skinning.vertex_to_joint_dependence[kv])
+                dependence.push_back(info);
+        }
+        dependence_offset[N_vertex] = dependence.size();
+        writer.write(dependence_offset);
+        writer.write(dependence);
+
+        writer.write(skinning.inverse_bind_matrices);
+        writer.write(skinning.rig_index_to_skeleton_index);
+        writer.write_single(skinning.global_bind_matrix);
+    }
+
+    // Animations
+    for(auto const& entry : animated_model.animation) {
+        skeleton_animation_structure const& animation = entry.second;
+        writer.write(entry.first);
+        writer.write(animation.joint_index);
+        for(int k_joint=0; k_joint<animation.joint_index.size(); ++k_joint) {
+            writer.write(animation.times[k_joint]);
+            writer.write(animation.keyframe[k_joint]);
+        }
+    }
+
+    if(!writer.stream)
+        warning_cgp("Error while writing the animated model binary file", filename);
+}
+
+// Offsets of the elements of a flattened array: non-decreasing, from 0 to at most the size of the array
+static bool valid_offsets(numarray<int> const& offset, size_t size)
+{
+    if(offset.size()==0)
+        return true;
+    if(offset[0]<0)
+        return false;
+    for(int k=1; k<offset.size(); ++k)
+        if(offset[k]<offset[k-1])
+            return false;
+    return size_t(offset[offset.size()-1])<=size;
+}
+
+bool animated_model_load_binary(std::string const& filename, animated_model_structure& animated_model, std::map<std::string, std::string>* texture_filename, uint64_t source_key)
+{
+    asset_binary_file_view file;
+    if(!file.open(filename))
+        return false;
+
+    asset_binary_reader reader;
+    reader.data = file.data;
+    reader.size = file.size;
+
+    asset_binary_header header;
+    reader.read_single(header);
+    if(!reader.valid || std::memcmp(header.magic, asset_binary_magic, sizeof(header.magic))!=0 || header.version!=asset_binary_version || header.endianness!=asset_binary_endianness) {
+        warning_cgp("Invalid or incompatible animated model binary file", filename);
+        return false;
+    }
+    if(source_key!=0 && header.source_key!=source_key) {
+        std::cout<<"Animated model binary file out of date (source files or loading parameters changed): "<<filename<<std::endl;
+        return false;
+    }
+
+    animated_model_structure model;
+
+    // Skeleton
+    numarray<int> joint_name_offset;
+    std::string joint_name_data;
+    reader.read(joint_name_offset);
+    reader.read(joint_name_data);
+    if(!valid_offsets(joint_name_offset, joint_name_data.size()))
+        reader.valid = false;
+    int const N_joint = std::max(0, joint_name_offset.size()-1);
+    model.skeleton.joint_name.resize(N_joint);
+    for(int k=0; k<N_joint && reader.valid; ++k)
+        model.skeleton.joint_name[k] = joint_name_data.substr(joint_name_offset[k], joint_name_offset[k+1]-joint_name_offset[k]);
+    reader.read(model.skeleton.parent_index);
+    reader.read(model.skeleton.joint_matrix_local);
+
+    // Rigged meshes
+    std::string const directory = directory_of(filename);
+    for(uint32_t k_mesh=0; k_mesh<header.number_of_rigged_mesh && reader.valid; ++k_mesh) {
+        std::string name, texture;
+        reader.read(name);
+        reader.read(texture);
+        if(texture_filename!=nullptr && texture.size()>0)
+            (*texture_filename)[name] = is_absolute_path(texture) ? texture : directory+texture;
+
+        rigged_mesh_structure& rigged_mesh = model.rigged_mesh[name];
+        mesh& shape = rigged_mesh.mesh_bind_pose;
+        controller_skinning_structure& skinning = rigged_mesh.controller_skinning;
+
+        reader.read(shape.position);
+        reader.read(shape.normal);
+        reader.read(shape.color);
+        reader.read(shape.uv);
+        reader.read(shape.connectivity);
+
+        numarray<int> dependence_offset;
+        numarray<skinning_weight_info> dependence;
+        reader.read(dependence_offset);
+        reader.read(dependence);
+        if(!valid_offsets(dependence_offset, size_t(dependence.size())))
+            reader.valid = false;
+        int const N_vertex = std::max(0, dependence_offset.size()-1);
+        skinning.vertex_to_joint_dependence.resize(N_vertex);
+        for(int kv=0; kv<N_vertex && reader.valid; ++kv) {
+            int const first = dependence_offset[kv];
+            int const N_dependence = dependence_offset[kv+1]-first;
+            skinning.vertex_to_joint_dependence[kv].resize(N_dependence);
+            if(N_dependence>0)
+                std::memcpy(skinning.vertex_to_joint_dependence[kv].data.data(), &dependence[first], N_dependence*sizeof(skinning_weight_info));
+        }
+
+        reader.read(skinning.inverse_bind_matrices);
+        reader.read(skinning.rig_index_to_skeleton_index);
+        reader.read_single(skinning.global_bind_matrix);
+
+        rigged_mesh.mesh_deformed = shape;
+    }
+
+    // Animations
+    for(uint32_t k_anim=0; k_anim<header.number_of_animation && reader.valid; ++k_anim) {
+        std::string name;
+        reader.read(name);
+        skeleton_animation_structure& animation = model.animation[name];
+        reader.read(animation.joint_index);
+
+        int const N_joint_animation = animation.joint_index.size();
+        animation.times.resize(N_joint_animation);
+        animation.keyframe.resize(N_joint_animation);
+        for(int k_joint=0; k_joint<N_joint_animation && reader.valid; ++k_joint) {
+            reader.read(animation.times[k_joint]);
+            reader.read(animation.keyframe[k_joint]);
+        }
+        if(reader.valid && N_joint_animation>0)
+            animation.update_time_max();
+    }
+
+    if(!reader.valid) {
+        warning_cgp("Truncated or corrupted animated model binary file", filename);
+        return false;
+    }
+
+    model.skeleton.update_joint_matrix_local_to_global();
+    animated_model = std::move(model);
+    return true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "cgp/cgp.hpp"
+
+#include <cstdint>
+
+#include "../animated_model/animated_model.hpp"
+
+
+// Binary container for an animated model (skeleton, rigged meshes, skinning and animations)
+//  - The data is stored exactly as it is used in memory: the vertex correspondance of the OBJ files is already applied to the skinning weights,
+//     and the loading transform (rotation, translation, scaling) is already applied to the meshes, skeleton, and animations.
+//  - Each array is stored as (number of elements, size of one element) followed by its raw data aligned on 16 bytes:
+//     the file can be memory-mapped and copied into the structures without any parsing.
+//  - The texture filename of each rigged mesh is stored relative to the directory of the binary file when possible.
+//
+// Layout of the file
+//   header: magic "CGPANIM", version, endianness tag, number of rigged meshes, number of animations, source key
+//   skeleton: joint_name, parent_index, joint_matrix_local
+//   for each rigged mesh: name, texture, position, normal, color, uv, connectivity,
+//      dependence_offset (N_vertex+1), dependence (skinning_weight_info), inverse_bind_matrices, rig_index_to_skeleton_index, global_bind_matrix
+//   for each animation: name, joint_index, then for each joint: times, keyframe (affine_rts)
+
+// Write the animated model in a binary file
+//  texture_filename[mesh_name]: texture associated to each rigged mesh (optional)
+//  source_key: identifies the source files and loading parameters the model was built from (see animated_model_load_binary)
+void animated_model_save_binary(std::string const& filename, animated_model_structure const& animated_model, std::map<std::string, std::string> const& texture_filename = std::map<std::string, std::string>(), uint64_t source_key = 0);
+
+// Load an animated model from a binary file written by animated_model_save_binary
+//  texture_filename: filled with the texture associated to each rigged mesh (if not null)
+//  source_key: if not 0, the file is rejected when it was built with another key (out of date cache)
+//  Return false if the file doesn't exist, is out of date, or is not a valid animated model binary
+bool animated_model_load_binary(std::string const& filename, animated_model_structure& animated_model, std::map<std::string, std::string>* texture_filename = nullptr, uint64_t source_key = 0);
@@ -1,4 +1,11 @@
 #include "asset_loader.hpp"
+#include "asset_binary.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <vector>
+#include <sys/stat.h>
 
 using namespace cgp;
 
@@ -33,15 +40,132 @@ void filename_loader_structure::add_rigged_mesh(std::string mesh_name, std::stri
 	rigged_loader.texture = texture;
 }
 
+void filename_loader_structure::set_binary_cache(std::string binary_filename)
+{
+    binary_cache = binary_filename;
+}
+
 void filename_loader_structure::clear()
 {
     loader_rigged_mesh.clear();
     loader_animation.clear();
     loader_skeleton = filename_loader_skeleton_structure();
+    binary_cache.clear();
+}
+
+static animated_model_structure mesh_skinning_loader_text(filename_loader_structure const& param, affine_rts const& transform);
+static void rigged_mesh_optimize(std::string const& name, rigged_mesh_structure& rigged_mesh);
+
+// FNV-1a hash, accumulated over the sources of the binary cache
+static void hash_bytes(uint64_t& hash, void const* data, size_t size)
+{
+    unsigned char const* bytes = static_cast<unsigned char const*>(data);
+    for(size_t k=0; k<size; ++k) {
+        hash ^= bytes[k];
+        hash *= 1099511628211ull;
+    }
 }
 
+// The name of a source file, with its size and modification time (0 if the file doesn't exist)
+static void hash_file(uint64_t& hash, std::string const& filename)
+{
+    hash_bytes(hash, filename.data(), filename.size()+1);
+    struct stat info;
+    int64_t stamp[2] = { 0, 0 };
+    if(filename.size()>0 && stat(filename.c_str(), &info)==0) {
+        stamp[0] = int64_t(info.st_size);
+        stamp[1] = int64_t(info.st_mtime);
+    }
+    hash_bytes(hash, stamp, sizeof(stamp));
+}
+
+// Key of the binary cache: all the source files (names, sizes, modification times), the textures and the loading transform
+static uint64_t binary_cache_source_key(filename_loader_structure const& param, affine_rts const& transform)
+{
+    uint64_t hash = 14695981039346656037ull;
+    hash_file(hash, param.loader_skeleton.skeleton_joint_name);
+    hash_file(hash, param.loader_skeleton.skeleton_parent_index);
+    hash_file(hash, param.loader_skeleton.skeleton_joint_matrix);
+    for(auto const& entry : param.loader_rigged_mesh) {
+        filename_loader_rigged_mesh_structure const& mesh_files = entry.second;
+        hash_bytes(hash, entry.first.data(), entry.first.size()+1);
+        hash_bytes(hash, mesh_files.texture.data(), mesh_files.texture.size()+1);
+        hash_file(hash, mesh_files.mesh);
+        hash_file(hash, mesh_files.controller_skinning_inverse_bind_matrix);
+        hash_file(hash, mesh_files.controller_skinning_joint);
+        hash_file(hash, mesh_files.controller_skinning_weight);
+        hash_file(hash, mesh_files.controller_skinning_rig_to_skeleton_joint_index);
+        hash_file(hash, mesh_files.controller_skinning_global_bind_matrix);
+    }
+    for(auto const& entry : param.loader_animation) {
+        hash_bytes(hash, entry.first.data(), entry.first.size()+1);
+        hash_file(hash, entry.second.animation_timing);
+        hash_file(hash, entry.second.animation_joint_index);
+        hash_file(hash, entry.second.animation_matrix);
+    }
+    float const transform_values[8] = { transform.rotation.data.x, transform.rotation.data.y, transform.rotation.data.z, transform.rotation.data.w,
+        transform.translation.x, transform.translation.y, transform.translation.z, transform.scaling };
+    hash_bytes(hash, transform_values, sizeof(transform_values));
+    return hash==0 ? 1 : hash; // 0 disables the check of the key
+}
 
 animated_model_structure mesh_skinning_loader(filename_loader_structure param, affine_rts const& transform)
+{
+    animated_model_structure animated_model;
+    uint64_t const source_key = param.binary_cache.size()>0 ? binary_cache_source_key(param, transform) : 0;
+    if(param.binary_cache.size()>0 && animated_model_load_binary(param.binary_cache, animated_model, nullptr, source_key))
+        return animated_model;
+
+    animated_model = mesh_skinning_loader_text(param, transform);
+
+    if(param.binary_cache.size()>0) {
+        // The meshes are optimized for the GPU once, when the binary container is created
+        for(auto& entry : animated_model.rigged_mesh)
+            rigged_mesh_optimize(entry.first, entry.second);
+
+        std::map<std::string, std::string> texture_filename;
+        for(auto const& entry : param.loader_rigged_mesh)
+            texture_filename[entry.first] = entry.second.texture;
+        animated_model_save_binary(param.binary_cache, animated_model, texture_filename, source_key);
+    }
+    return animated_model;
+}
+
+void mesh_skinning_convert_to_binary(filename_loader_structure param, std::string const& binary_filename, affine_rts const& transform)
+{
+    param.binary_cache = binary_filename;
+    if(check_file_exist(binary_filename))
+        std::remove(binary_filename.c_str());
+    mesh_skinning_loader(param, transform);
+}
+
+// Merge the duplicated vertices, then reorder the triangles and vertices of the mesh for the post-transform cache and the vertex fetch
+//  The skinning weights follow the new vertex order. Only the vertices with the same skinning weights can be merged.
+static void rigged_mesh_optimize(std::string const& name, rigged_mesh_structure& rigged_mesh)
+{
+    controller_skinning_structure& skinning = rigged_mesh.controller_skinning;
+
+    int const N_vertex = skinning.vertex_to_joint_dependence.size();
+    numarray<int> vertex_group(N_vertex);
+    std::map<std::vector<std::pair<int,float> >, int> group_index;
+    for(int k_vertex=0; k_vertex<N_vertex; ++k_vertex) {
+        std::vector<std::pair<int,float> > key;
+        for(skinning_weight_info const& info : skinning.vertex_to_joint_dependence[k_vertex])
+            key.push_back({info.joint_index, info.weight});
+        auto const it = group_index.insert({key, int(group_index.size())}).first;
+        vertex_group[k_vertex] = it->second;
+    }
+
+    numarray<int> vertex_remap;
+    mesh_optimization_report const report = mesh_optimize(rigged_mesh.mesh_bind_pose, true, &vertex_remap, vertex_group);
+    rigged_mesh.mesh_deformed = rigged_mesh.mesh_bind_pose;
+
+    skinning.vertex_to_joint_dependence = mesh_apply_vertex_remap(skinning.vertex_to_joint_dependence, vertex_remap);
+
+    std::cout<<"  Mesh optimization ["<<name<<"] "<<str(report)<<std::endl;
+}
+
+static animated_model_structure mesh_skinning_loader_text(filename_loader_structure const& param, affine_rts const& transform)
 {
     animated_model_structure animated_model;
     affine_rt T; 
@@ -102,20 +226,23 @@ animated_model_structure mesh_skinning_loader(filename_loader_structure param, a
         std::string const& name = entry_anim.first;
         auto const& param_anim = entry_anim.second;
 
+        numarray< numarray<mat4> > animation_matrix;
         read_from_file(param_anim.animation_timing, animated_model.animation[name].times);
         read_from_file(param_anim.animation_joint_index, animated_model.animation[name].joint_index);
-        read_from_file(param_anim.animation_matrix, animated_model.animation[name].matrix);
+        read_from_file(param_anim.animation_matrix, animation_matrix);
 
-        for(int k1=0; k1<animated_model.animation[name].matrix.size(); ++k1) {
-            for(int k2=0; k2<animated_model.animation[name].matrix[0].size(); ++k2) {
-                animated_model.animation[name].matrix[k1][k2].apply_scaling_to_block_translation(transform.scaling);
+        for(int k1=0; k1<animation_matrix.size(); ++k1) {
+            for(int k2=0; k2<animation_matrix[0].size(); ++k2) {
+                animation_matrix[k1][k2].apply_scaling_to_block_translation(transform.scaling);
             }
         }
 
-        for(int k2=0; k2<animated_model.animation[name].matrix[0].size(); ++k2) {
-            animated_model.animation[name].matrix[0][k2] = T * animated_model.animation[name].matrix[0][k2];
+        for(int k2=0; k2<animation_matrix[0].size(); ++k2) {
+            animation_matrix[0][k2] = T * animation_matrix[0][k2];
         }
 
+        // The matrices are only kept in their compact (quaternion, translation, scaling) form
+        animated_model.animation[name].set_keyframe_from_matrix(animation_matrix);
 
         animated_model.animation[name].update_time_max();
 
@@ -30,14 +30,23 @@ struct filename_loader_structure {
     std::map<std::string, filename_loader_rigged_mesh_structure> loader_rigged_mesh;
     std::map<std::string, filename_loader_animation_structure> loader_animation;
 
+    // Optional binary container (see asset_binary.hpp) used in place of the text files
+    //  If the file exists it is loaded directly, otherwise it is created from the text files at the first loading
+    //  The file is rebuilt when the source files (names, sizes, modification times), the textures or the transform change
+    std::string binary_cache;
+
     void set_skeleton(std::string skeleton_root_path);
     void add_animation(std::string anim_name, std::string animation_root_path);
     void add_rigged_mesh(std::string mesh_name, std::string rigged_mesh_root_path, std::string texture);
+    void set_binary_cache(std::string binary_filename);
     void clear();
 };
 
 animated_model_structure mesh_skinning_loader(filename_loader_structure filename_parameter, cgp::affine_rts const& transform=cgp::affine_rts ());
 
+// Load the text files and write the resulting animated model (with the transform applied) in a single binary container
+void mesh_skinning_convert_to_binary(filename_loader_structure filename_parameter, std::string const& binary_filename, cgp::affine_rts const& transform=cgp::affine_rts ());
+
 
 //Map correspondance between skinning weights and vertices (that have been duplicated to load the texture coordinates)
 template <typename T>
@@ -1,30 +1,35 @@
 #include "skeleton_animation.hpp"
 
+#include <algorithm>
+
 using namespace cgp;
 
 static bool find_relative_placement_in_array(numarray<float> const& times, float t, int& index_placement, float& ratio_placement);
+static affine_rts interpolate_keyframe(affine_rts const& K0, affine_rts const& K1, float alpha);
 
 mat4 skeleton_animation_structure::evaluate(int k_joint, float t) const {
 
     cgp::numarray<float> const& time_array = times[k_joint];
     int N_time = time_array.size();
 
-    int idx0;
+    if(cursor.size()!=times.size()) {
+        cursor.resize_clear(times.size());
+    }
+
+    int& idx0 = cursor[k_joint];
     float alpha;
     find_relative_placement_in_array(time_array, t, idx0, alpha);
 
 
-    mat4 M;
+    affine_rts K;
     if(idx0<N_time-1){
-        mat4 const& M0 = matrix[k_joint][idx0];
-        mat4 const& M1 = matrix[k_joint][idx0+1];
-        M = (1.0f-alpha)*M0 + alpha*M1;
+        K = interpolate_keyframe(keyframe[k_joint][idx0], keyframe[k_joint][idx0+1], alpha);
     }
     if(idx0>=N_time-1) {
-        M = matrix[k_joint][N_time-1];
+        K = keyframe[k_joint][N_time-1];
     }
 
-    return M;
+    return K.matrix();
 }
 
 
@@ -38,7 +43,33 @@ void skeleton_animation_structure::update_time_max()
 
 }
 
+void skeleton_animation_structure::set_keyframe_from_matrix(numarray< numarray<mat4> > const& matrix)
+{
+    int const N_joint = matrix.size();
+    keyframe.resize(N_joint);
+    for(int k_joint=0; k_joint<N_joint; ++k_joint) {
+        int const N_time = matrix[k_joint].size();
+        keyframe[k_joint].resize(N_time);
+        for(int k_time=0; k_time<N_time; ++k_time) {
+            keyframe[k_joint][k_time] = affine_rts::from_matrix(matrix[k_joint][k_time]);
+        }
+    }
+
+    cursor.clear();
+}
+
+static affine_rts interpolate_keyframe(affine_rts const& K0, affine_rts const& K1, float alpha)
+{
+    affine_rts K;
+    K.rotation = rotation_transform::lerp(K0.rotation, K1.rotation, alpha);
+    K.translation = (1.0f-alpha)*K0.translation + alpha*K1.translation;
+    K.scaling = (1.0f-alpha)*K0.scaling + alpha*K1.scaling;
+    return K;
+}
+
 // Helper function that finds the relative position of the time t in an array of discrete key time values [t_0,t_1,...t_N].
+//  Input
+//    index_placement: index found at the previous call, tested first (and its successor) before falling back to a binary search
 //  Return
 //    index_placement: i such that t_i < t < t_{i+1}
 //    ratio_placement: the relative position of t between its two discrete key time r = (t-t_i) / (t_{i+1}-t_i)
@@ -46,7 +77,7 @@ static bool find_relative_placement_in_array(numarray<float> const& times, float
 {
     assert_cgp(times.size()>=2, "time intervals should have more than 2 values");
 
-    size_t const N = times.size();
+    int const N = times.size();
     if(t<times[0]) {
         index_placement = 0;
         ratio_placement = 0.0f;
@@ -58,12 +89,20 @@ static bool find_relative_placement_in_array(numarray<float> const& times, float
         return false;
     }
 
-
-    int current_index = 0;
-    while (t > times[current_index + 1]) {
-        assert_cgp_no_msg(N>current_index);
+    // Test the previous interval and the following one, then fall back to a binary search
+    int current_index = index_placement;
+    if(current_index>=0 && current_index<N-1 && times[current_index]<=t && t<=times[current_index+1]) {
+        // same interval as previously
+    }
+    else if(current_index>=0 && current_index<N-2 && times[current_index+1]<=t && t<=times[current_index+2]) {
         ++current_index;
     }
+    else {
+        // first t_i such that t < t_i, the interval starts at the previous key
+        auto const upper = std::upper_bound(times.begin(), times.end(), t);
+        current_index = int(upper-times.begin())-1;
+        current_index = std::max(0, std::min(current_index, N-2));
+    }
     index_placement = current_index;
 
     float const t0 = times[current_index];
@@ -73,4 +112,4 @@ static bool find_relative_placement_in_array(numarray<float> const& times, float
 
     ratio_placement = (t-t0)/dt;
     return true;
-}
\ No newline at end of file
+}
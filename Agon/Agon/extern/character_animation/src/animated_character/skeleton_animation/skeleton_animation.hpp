@@ -10,15 +10,23 @@ struct skeleton_animation_structure {
     cgp::numarray<int> joint_index;
     // Store the key times for each joint, and for each time index
     cgp::numarray< cgp::numarray<float> > times; // times[k_joint][k_time]
-    // Store the joint matrix for each joint, and for each time index
-    cgp::numarray< cgp::numarray<cgp::mat4> > matrix; // matrix[k_joint][k_time]
+    // Store the joint keyframe (unit quaternion rotation, translation, uniform scaling) for each joint, and for each time index
+    cgp::numarray< cgp::numarray<cgp::affine_rts> > keyframe; // keyframe[k_joint][k_time]
 
     // Evaluate the interpolated matrix for a given join and time \in [0, time_max]
+    //  Translation and scaling are linearly interpolated, rotation uses a normalized quaternion interpolation
     cgp::mat4 evaluate(int k_joint, float t) const;
-    
+
 
     // Store the maximal time value of the animation (assume the starting time is 0)
     float time_max;
     // Update the time_max value such that time_max=max(times)
     void update_time_max();
-};
\ No newline at end of file
+
+    // Fill the keyframes from a set of (rigid + uniform scaling) matrices given for each joint and each time index
+    void set_keyframe_from_matrix(cgp::numarray< cgp::numarray<cgp::mat4> > const& matrix);
+
+    // Index of the last keyframe found for each joint, used as a starting guess for the next evaluation
+    //  (successive evaluations are usually at close times, the search is then O(1))
+    mutable cgp::numarray<int> cursor; // cursor[k_joint]
+};
@@ -20,6 +20,7 @@ skeleton_drawable::skeleton_drawable(skeleton_structure const& skeleton)
     
     segments.display_type = curve_drawable_display_type::Segments;
     segments.initialize_data_on_gpu(edges);
+    segments.vbo_position.set_update_mode(opengl_vbo_update_mode::stream); // updated at every frame
     joint_frame.initialize_data_on_gpu(mesh_primitive_frame());
     joint_sphere.initialize_data_on_gpu(mesh_primitive_sphere());
 }
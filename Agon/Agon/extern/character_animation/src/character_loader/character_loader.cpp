@@ -14,6 +14,7 @@ character_structure load_character_lola() {
 	loader_param.add_animation("Idle", project::path+"assets/lola/animation/idle/");
 	loader_param.add_animation("Walk", project::path+"assets/lola/animation/walk/");
 	loader_param.add_animation("Walk2", project::path+"assets/lola/animation/walk_style/");
+	loader_param.set_binary_cache(project::path+"assets/lola/lola.bin");
 
 	character_structure character;
 	character.load_and_initialize(loader_param, affine_rts().set_scaling(0.01f));
@@ -33,6 +34,7 @@ character_structure load_character_soccer() {
 	loader_param.add_animation("Idle", project::path+"assets/soccer/animation/idle/");
 	loader_param.add_animation("Walk", project::path+"assets/soccer/animation/walk/");
 	loader_param.add_animation("Jump", project::path+"assets/soccer/animation/jump/");
+	loader_param.set_binary_cache(project::path+"assets/soccer/soccer.bin");
 	
 
 	character_structure character;
@@ -50,6 +52,7 @@ character_structure load_character_maria_sword() {
 	loader_param.add_animation("Idle2", project::path+"assets/maria-sword/animation/idle2/");
 	loader_param.add_animation("Walk", project::path+"assets/maria-sword/animation/walking/");
 	loader_param.add_animation("Slash", project::path+"assets/maria-sword/animation/slash/");
+	loader_param.set_binary_cache(project::path+"assets/maria-sword/maria-sword.bin");
 
 	character_structure character;
 	character.load_and_initialize(loader_param, affine_rts().set_scaling(0.01f));
@@ -46,6 +46,13 @@ void scene_structure::initialize()
 
 	for(auto& entry : characters)
 		entry.second.timer.start();
+
+	// Crowd of Lola characters: all the animations are baked once, then skinned on the GPU
+	std::cout<<"- Bake the animations of the crowd"<<std::endl;
+	shader_baked_animation.load(project::path+"shaders/mesh_baked_animation/mesh_baked_animation.vert.glsl", project::path+"shaders/mesh/mesh.frag.glsl");
+	crowd.initialize(characters["Lola"].animated_model, "body", shader_baked_animation, characters["Lola"].drawable["body"].texture);
+	initialize_crowd_instances();
+	timer_crowd.start();
 	
 }
 
@@ -70,36 +77,82 @@ void scene_structure::display_frame()
 	}
 
 	// ************************************************* //
-	// Update the current skeleton of each character
+	// Select the characters to animate at this frame
 	// ************************************************* //
-	for(auto& entry : characters) {
-		std::string character_name = entry.first;
-		character_structure& character = entry.second;
+	//  Distant characters are animated at a reduced rate, characters outside of the view are not animated,
+	//  and the animation stops when the time budget of the frame is consumed (postponed characters have priority at the next frame).
+	//  The current active character is always animated as it may be driven by the effects.
+	std::vector<std::string> const characters_to_update = animation_scheduler.start_frame(characters, environment.camera_view, environment.camera_projection, current_active_character);
+
+	for(std::string const& character_name : characters_to_update) {
+		if(!animation_scheduler.within_budget())
+			break;
+
+		character_structure& character = characters[character_name];
+		animated_model_structure& animated_model = character.animated_model;
 		effect_transition_structure& transition = effect_transition[character_name];
 
+		// ************************************************* //
+		// Update the current skeleton of the character
+		// ************************************************* //
+
 		// Default animation reading a standard animation cycle
 		if(transition.active==false) {
-			character.animated_model.set_skeleton_from_animation(character.current_animation_name, character.timer.t_periodic);
+			animated_model.set_skeleton_from_animation(character.current_animation_name, character.timer.t_periodic);
 		}
 		// Currently with an active transition between two animations
 		else {
 			effect_transition_compute(transition, character);
 			effect_transition_stop_if_completed(transition, character);
 		}
-	}
 
-	// ********************************** //
-	// Apply effects on the skeleton
-	// ********************************** //
+		// ********************************** //
+		// Apply effects on the skeleton
+		// ********************************** //
+
+		if(character_name==current_active_character) {
+			// Apply the walk effect if activated
+			if(effect_walk.active) {
+				effect_walking(effect_walk, character, inputs, transition);
+			}
 
-	// Apply the walk effect if activated
-	if(effect_walk.active) {
-		effect_walking(effect_walk, characters[current_active_character], inputs, effect_transition[current_active_character]);
+			// Apply the Inverse Kinematics effect if activated
+			if(effect_ik.active) {
+				effect_ik_compute(effect_ik, animated_model.skeleton);
+			}
+		}
+
+		// Apply the head rotation effect if activated
+		if(gui.rotate_head_effect_active) {
+			effect_rotate_head_toward_objective_position(animated_model.skeleton, 10, camera_control.camera_model.position());
+		}
+
+		// ********************************** //
+		// Compute Skinning deformation
+		// ********************************** //
+		for(auto& rigged_mesh_entry : animated_model.rigged_mesh) {
+			std::string const& mesh_name = rigged_mesh_entry.first;
+			rigged_mesh_structure const& rigged_mesh = rigged_mesh_entry.second;
+			animated_model.skinning_lbs(mesh_name);
+
+			mesh_drawable& drawable = character.drawable[mesh_name];
+			drawable.vbo_position.update(rigged_mesh.mesh_deformed.position);
+			drawable.vbo_normal.update(rigged_mesh.mesh_deformed.normal);
+		}
+
+		animation_scheduler.notify_updated(character_name);
+	}
+	animation_scheduler.end_frame();
+
+	// Display the crowd: a single instanced draw call, no animation computed on the CPU
+	if(gui.display_crowd) {
+		timer_crowd.update();
+		crowd.drawable.material.texture_settings.active = gui.display_texture;
+		draw(crowd, environment, timer_crowd.t);
 	}
 
-	// Apply the Inverse Kinematics effect if activated
+	// Display the IK targets
 	if(effect_ik.active) {
-		effect_ik_compute(effect_ik, characters[current_active_character].animated_model.skeleton);
 		sphere_ik.model.translation = effect_ik.target_position + effect_ik.target_offset;
 		draw(sphere_ik, environment); // end effector
 
@@ -107,40 +160,22 @@ void scene_structure::display_frame()
 		draw(sphere_ik, environment); // start joint
 	}
 
-	// Apply the head rotation effect if activated
-	if(gui.rotate_head_effect_active) {
-		for(auto& entry_character : characters) {
-			effect_rotate_head_toward_objective_position(entry_character.second.animated_model.skeleton, 10, camera_control.camera_model.position());
-		}
-	}
-
-
-	// ********************************** //
-	// Compute Skinning deformation
-	// ********************************** //
-	for(auto& entry_character : characters) {
-		animated_model_structure& animated_model = entry_character.second.animated_model;
-		for(auto& rigged_mesh_entry : animated_model.rigged_mesh) {
-			std::string mesh_name = rigged_mesh_entry.first;
-			animated_model.skinning_lbs(mesh_name);
-		}
-	}
-
 	// ************************************** //
 	// Display the surface and the skeletons
 	// ************************************** //
 	for(auto& entry_character : characters) {
+		std::string const& character_name = entry_character.first;
 		character_structure& character = entry_character.second;
 		animated_model_structure& animated_model = entry_character.second.animated_model;
 
+		// Characters outside of the view frustum are neither animated nor drawn
+		if(!animation_scheduler.is_visible(character_name))
+			continue;
+
 		// Display meshes
 		for(auto& rigged_mesh_entry : animated_model.rigged_mesh) {
 			std::string mesh_name = rigged_mesh_entry.first;
-			rigged_mesh_structure& rigged_mesh = rigged_mesh_entry.second;
-			
 			mesh_drawable& drawable = character.drawable[mesh_name];
-			drawable.vbo_position.update(rigged_mesh.mesh_deformed.position);
-			drawable.vbo_normal.update(rigged_mesh.mesh_deformed.normal);
 
 			if(gui.display_surface) {
 				drawable.material.texture_settings.active = gui.display_texture;
@@ -183,6 +218,23 @@ void scene_structure::display_gui()
 
 	ImGui::Spacing(); ImGui::Spacing();
 
+	// Animation level of detail
+	if(ImGui::CollapsingHeader("Animation LOD")) {
+		ImGui::Indent();
+		animation_scheduler.display_gui();
+		ImGui::Unindent();
+	}
+
+	// Crowd rendered from baked animations
+	if(ImGui::CollapsingHeader("Crowd")) {
+		ImGui::Indent();
+		ImGui::Checkbox("Display crowd", &gui.display_crowd);
+		if(ImGui::SliderInt("Crowd size", &gui.crowd_size, 1, 50))
+			initialize_crowd_instances();
+		ImGui::Text("Instances: %d, Baked clips: %d, Texture: %dx%d", int(crowd.instances.size()), int(crowd.baked.clip.size()), crowd.baked.texture.width, crowd.baked.texture.height);
+		ImGui::Unindent();
+	}
+
 	// Effects
 	ImGui::Spacing(); ImGui::Separator(); 
 	ImGui::Text("Effects: "); 
@@ -322,6 +374,26 @@ void scene_structure::idle_frame()
 	camera_control.idle_frame(environment.camera_view);
 }
 
+// Place the crowd on a grid behind the main characters, each instance plays a random clip with a random time offset
+void scene_structure::initialize_crowd_instances()
+{
+	int const N = gui.crowd_size;
+	float const spacing = 1.2f;
+	int const N_clip = crowd.baked.clip.size();
+
+	crowd.instances.resize(N*N);
+	for(int kx=0; kx<N; ++kx) {
+		for(int kz=0; kz<N; ++kz) {
+			crowd_instance& instance = crowd.instances[kx+N*kz];
+			instance.position = { spacing*(kx-(N-1)/2.0f), 0.0f, -3.0f-spacing*kz };
+			instance.angle = rand_uniform(-0.5f, 0.5f);
+			instance.clip = std::min(int(rand_uniform(0.0f, float(N_clip))), N_clip-1);
+			instance.time_offset = rand_uniform(0.0f, crowd.baked.clip[instance.clip].duration);
+		}
+	}
+	crowd.update_instances();
+}
+
 void initialize_ground(mesh_drawable& ground) {
 	mesh ground_mesh = mesh_primitive_quadrangle();
 	ground_mesh.translate({-0.5f,-0.5f,0.0f});
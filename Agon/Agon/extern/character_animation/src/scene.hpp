@@ -5,6 +5,8 @@
 #include "environment.hpp"
 
 #include "animated_character/animated_character.hpp"
+#include "animated_character/animation_scheduler/animation_scheduler.hpp"
+#include "animated_character/animation_baked/animation_baked.hpp"
 #include "effects/effects.hpp"
 
 
@@ -22,6 +24,8 @@ struct gui_parameters {
 	bool display_skeleton_joint_frame = false;
 	bool display_skeleton_bone = true;
 	bool rotate_head_effect_active = false;
+	bool display_crowd = false;
+	int crowd_size = 10; // The crowd is a crowd_size x crowd_size grid of characters
 };
 
 
@@ -52,6 +56,14 @@ struct scene_structure : cgp::scene_inputs_generic {
 	std::map<std::string, character_structure> characters;
 	std::string current_active_character;
 
+	// Select the characters animated at each frame (distance/visibility LOD and time budget)
+	animation_scheduler_structure animation_scheduler;
+
+	// Large set of characters animated on the GPU from baked animations (single instanced draw call)
+	crowd_drawable crowd;
+	opengl_shader_structure shader_baked_animation;
+	timer_basic timer_crowd;
+
 
 	std::map<std::string, effect_transition_structure> effect_transition;	
 	effect_walking_structure effect_walk;
@@ -75,6 +87,8 @@ struct scene_structure : cgp::scene_inputs_generic {
 	void keyboard_event();
 	void idle_frame();
 
+	void initialize_crowd_instances();
+
 };
 
 
@@ -0,0 +1,119 @@
+#include "http_session.hpp"
+#include "room_server.hpp"
+#include "session.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+// Value of a parameter in the query string of the target (empty if absent), with the %XX and '+' escapes decoded
+static std::string query_parameter(std::string const& target, std::string const& name) {
+    size_t const query_start = target.find('?');
+    if (query_start == std::string::npos) return "";
+
+    std::string const query = target.substr(query_start + 1);
+    size_t position = 0;
+    while (position <= query.size()) {
+        size_t end = query.find('&', position);
+        if (end == std::string::npos) end = query.size();
+        std::string const pair = query.substr(position, end - position);
+        size_t const equal = pair.find('=');
+        if (pair.substr(0, equal) == name) {
+            std::string const raw = equal == std::string::npos ? "" : pair.substr(equal + 1);
+            std::string value;
+            for (size_t k = 0; k < raw.size(); ++k) {
+                if (raw[k] == '%' && k + 2 < raw.size()) {
+                    value += char(std::strtol(raw.substr(k + 1, 2).c_str(), nullptr, 16));
+                    k += 2;
+                }
+                else
+                    value += raw[k] == '+' ? ' ' : raw[k];
+            }
+            return value;
+        }
+        position = end + 1;
+    }
+    return "";
+}
+
+// Username carried by the token
+//  The local server has no account database: a JWT is not verified, only its "username" claim is read.
+//  Any other token (e.g. from the test clients) is used directly as the username.
+static std::string username_from_token(std::string const& token) {
+    size_t const first_dot = token.find('.');
+    size_t const second_dot = first_dot == std::string::npos ? std::string::npos : token.find('.', first_dot + 1);
+    if (second_dot == std::string::npos) return token;
+
+    // base64url decoding of the payload
+    std::string const payload = token.substr(first_dot + 1, second_dot - first_dot - 1);
+    std::string decoded;
+    unsigned int bits = 0;
+    int bit_count = 0;
+    for (char c : payload) {
+        int value;
+        if (c >= 'A' && c <= 'Z') value = c - 'A';
+        else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') value = c - '0' + 52;
+        else if (c == '-' || c == '+') value = 62;
+        else if (c == '_' || c == '/') value = 63;
+        else break;
+        bits = (bits << 6) | unsigned(value);
+        bit_count += 6;
+        if (bit_count >= 8) {
+            bit_count -= 8;
+            decoded += char((bits >> bit_count) & 0xFF);
+        }
+    }
+
+    nlohmann::json const claims = nlohmann::json::parse(decoded, nullptr, false);
+    if (claims.is_object() && claims.contains("username") && claims["username"].is_string())
+        return claims["username"].get<std::string>();
+    return token;
+}
+
+
+HttpSession::HttpSession(tcp::socket&& socket, std::shared_ptr<RoomServer> const& server_arg)
+    : stream(std::move(socket)), server(server_arg)
+{}
+
+void HttpSession::run() {
+    stream.expires_after(std::chrono::seconds(30));
+    http::async_read(stream, buffer, request, beast::bind_front_handler(&HttpSession::on_read, shared_from_this()));
+}
+
+void HttpSession::on_read(beast::error_code ec, std::size_t) {
+    if (ec) {
+        if (ec != http::error::end_of_stream && ec != beast::error::timeout)
+            std::cerr << "HttpSession read: " << ec.message() << std::endl;
+        return;
+    }
+    if (!websocket::is_upgrade(request)) {
+        // Only the WebSocket endpoint is served
+        stream.socket().shutdown(tcp::socket::shutdown_both, ec);
+        return;
+    }
+
+    std::string const target(request.target());
+    std::string const token = query_parameter(target, "token");
+    std::string const username = token.empty() ? "" : username_from_token(token);
+    std::string const room_id = query_parameter(target, "roomId");
+
+    // Move the connection to the io_context of the worker owning the room
+    int const worker = server->worker_for_room(room_id);
+    stream.expires_never();
+    tcp::socket socket = stream.release_socket();
+    tcp const protocol = socket.local_endpoint(ec).protocol();
+    if (ec) return;
+    tcp::socket::native_handle_type const handle = socket.release(ec);
+    if (ec) return;
+    tcp::socket worker_socket(server->worker_context(worker));
+    worker_socket.assign(protocol, handle, ec);
+    if (ec) return;
+    // Small messages at the tick rate: no Nagle delay (it adds up to a delayed ACK timeout to the latency)
+    worker_socket.set_option(tcp::no_delay(true), ec);
+
+    auto const session = std::make_shared<Session>(std::move(worker_socket), server, username, room_id, worker);
+    net::post(server->worker_context(worker), [session, request = std::move(request)]() mutable {
+        session->run(std::move(request));
+    });
+}
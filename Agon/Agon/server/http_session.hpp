@@ -0,0 +1,24 @@
+#pragma once
+
+#include "net.hpp"
+#include <memory>
+
+class RoomServer;
+
+// First step of a connection: read the HTTP upgrade request on the accepting thread
+//  The query string (/ws?token=...&roomId=...) gives the room, and the socket is then moved to the worker owning the room,
+//  where the Session accepts the WebSocket handshake.
+class HttpSession : public std::enable_shared_from_this<HttpSession> {
+public:
+    HttpSession(tcp::socket&& socket, std::shared_ptr<RoomServer> const& server);
+
+    void run();
+
+private:
+    void on_read(beast::error_code ec, std::size_t bytes_transferred);
+
+    beast::tcp_stream stream;
+    beast::flat_buffer buffer;
+    http::request<http::string_body> request;
+    std::shared_ptr<RoomServer> server;
+};
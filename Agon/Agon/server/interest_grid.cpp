@@ -0,0 +1,74 @@
+#include "interest_grid.hpp"
+#include "apartment.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+static int interval_for_rate(int tick_rate, int rate) {
+    if (rate <= 0) return 1;
+    return std::max(1, int(std::lround(float(tick_rate) / rate)));
+}
+
+InterestGrid::InterestGrid(float near_distance_arg, int tick_rate, int reduced_rate, int hidden_rate)
+    : near_distance(near_distance_arg)
+    , intervals{ 1, interval_for_rate(tick_rate, reduced_rate), interval_for_rate(tick_rate, hidden_rate) }
+{}
+
+bool InterestGrid::load(std::string const& layout_filename) {
+    grid = Apartment::load_layout_from_csv(layout_filename);
+    rows = int(grid.size());
+    cols = 0;
+    for (auto const& row : grid)
+        cols = std::max(cols, int(row.size()));
+    return rows > 0 && cols > 0;
+}
+
+bool InterestGrid::is_wall(int i, int j) const {
+    if (i < 0 || i >= rows || j < 0 || j >= int(grid[i].size())) return false; // Outside the layout: nothing to hide behind
+    return grid[i][j] == 'W';
+}
+
+bool InterestGrid::line_of_sight(cgp::vec3 const& a, cgp::vec3 const& b) const {
+    // Cell coordinates (the grid is centered on the origin, 1m cells)
+    float const ax = a.x + cols / 2.0f, ay = a.y + rows / 2.0f;
+    float const bx = b.x + cols / 2.0f, by = b.y + rows / 2.0f;
+    int j = int(std::floor(ax)), i = int(std::floor(ay));
+    int const j_end = int(std::floor(bx)), i_end = int(std::floor(by));
+
+    // Walk the cells crossed by the segment (Amanatides & Woo)
+    float const dx = bx - ax, dy = by - ay;
+    int const step_j = dx > 0 ? 1 : -1;
+    int const step_i = dy > 0 ? 1 : -1;
+    float const t_delta_x = dx != 0 ? std::abs(1.0f / dx) : INFINITY;
+    float const t_delta_y = dy != 0 ? std::abs(1.0f / dy) : INFINITY;
+    float t_max_x = dx != 0 ? ((dx > 0 ? j + 1 - ax : ax - j) * t_delta_x) : INFINITY;
+    float t_max_y = dy != 0 ? ((dy > 0 ? i + 1 - ay : ay - i) * t_delta_y) : INFINITY;
+
+    int const max_steps = std::abs(j_end - j) + std::abs(i_end - i);
+    for (int k = 0; k < max_steps; ++k) {
+        if (t_max_x < t_max_y) {
+            j += step_j;
+            t_max_x += t_delta_x;
+        }
+        else {
+            i += step_i;
+            t_max_y += t_delta_y;
+        }
+        // The cells of the two players themselves are never walls (collisions), only the crossed ones are tested
+        if ((i != i_end || j != j_end) && is_wall(i, j)) return false;
+    }
+    return true;
+}
+
+InterestGrid::Relevance InterestGrid::relevance(cgp::vec3 const& viewer, cgp::vec3 const& position) const {
+    if (!enabled()) return Relevance::Near;
+    bool const far = cgp::norm(cgp::vec2(position.x - viewer.x, position.y - viewer.y)) > near_distance;
+    bool const hidden = !line_of_sight(viewer, position);
+    if (far && hidden) return Relevance::Hidden;
+    if (far || hidden) return Relevance::Reduced;
+    return Relevance::Near;
+}
+
+int InterestGrid::interval(Relevance relevance) const {
+    return intervals[int(relevance)];
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "cgp/cgp.hpp"
+
+#include <string>
+#include <vector>
+
+// Interest management of the room states
+//  Grid over the cells of the layout (same 1m cells as Apartment) used to select the rate at which a player receives the state
+//  of another one: every tick when it is nearby and in line of sight, at a reduced rate when it is far or behind a wall, and at
+//  the lowest rate when it is both. The client still receives everybody (the positions of far players stay roughly right).
+class InterestGrid {
+public:
+    enum class Relevance { Near, Reduced, Hidden };
+
+    InterestGrid(float near_distance, int tick_rate, int reduced_rate, int hidden_rate);
+
+    // Read the walls of the layout (returns false if the file has no cell)
+    bool load(std::string const& layout_filename);
+
+    // Relevance of a player at position to an observer at viewer
+    Relevance relevance(cgp::vec3 const& viewer, cgp::vec3 const& position) const;
+    // Ticks between two updates with this relevance (1: every tick)
+    int interval(Relevance relevance) const;
+
+    // False if a wall cell is crossed by the segment between the two positions (in the horizontal plane)
+    bool line_of_sight(cgp::vec3 const& a, cgp::vec3 const& b) const;
+
+    bool enabled() const { return near_distance > 0.0f; }
+
+private:
+    bool is_wall(int i, int j) const;
+
+    float const near_distance;  // 0: no filtering (everything is Near)
+    int intervals[3];
+
+    std::vector<std::vector<char>> grid;
+    int rows = 0;
+    int cols = 0;
+};
@@ -0,0 +1,43 @@
+#include "listener.hpp"
+#include "http_session.hpp"
+
+#include <iostream>
+
+static void fail(beast::error_code ec, char const* what) {
+    if (ec == net::error::operation_aborted) return;
+    std::cerr << "Listener " << what << ": " << ec.message() << std::endl;
+}
+
+Listener::Listener(net::io_context& ioc_arg, tcp::endpoint endpoint, std::shared_ptr<RoomServer> const& server_arg)
+    : ioc(ioc_arg), acceptor(ioc_arg), server(server_arg)
+{
+    beast::error_code ec;
+    acceptor.open(endpoint.protocol(), ec);
+    if (ec) { fail(ec, "open"); return; }
+    acceptor.set_option(net::socket_base::reuse_address(true), ec);
+    if (ec) { fail(ec, "set_option"); return; }
+    acceptor.bind(endpoint, ec);
+    if (ec) { fail(ec, "bind"); return; }
+    acceptor.listen(net::socket_base::max_listen_connections, ec);
+    if (ec) { fail(ec, "listen"); return; }
+    is_open = true;
+}
+
+bool Listener::run() {
+    if (!is_open) return false;
+    do_accept();
+    return true;
+}
+
+void Listener::do_accept() {
+    // The new connection gets its own strand: the handlers of a session are never run concurrently
+    acceptor.async_accept(net::make_strand(ioc), beast::bind_front_handler(&Listener::on_accept, shared_from_this()));
+}
+
+void Listener::on_accept(beast::error_code ec, tcp::socket socket) {
+    if (ec)
+        fail(ec, "accept");
+    else
+        std::make_shared<HttpSession>(std::move(socket), server)->run();
+    do_accept();
+}
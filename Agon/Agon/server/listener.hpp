@@ -0,0 +1,24 @@
+#pragma once
+
+#include "net.hpp"
+#include <memory>
+
+class RoomServer;
+
+// Accept the incoming connections, each one read by a new HttpSession until its WebSocket upgrade
+class Listener : public std::enable_shared_from_this<Listener> {
+public:
+    Listener(net::io_context& ioc, tcp::endpoint endpoint, std::shared_ptr<RoomServer> const& server);
+
+    // Start accepting connections (returns false if the endpoint could not be opened)
+    bool run();
+
+private:
+    void do_accept();
+    void on_accept(beast::error_code ec, tcp::socket socket);
+
+    net::io_context& ioc;
+    tcp::acceptor acceptor;
+    std::shared_ptr<RoomServer> server;
+    bool is_open = false;
+};
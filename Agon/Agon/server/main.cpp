@@ -0,0 +1,42 @@
+#include "listener.hpp"
+#include "room_server.hpp"
+#include "server_settings.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+// Local authoritative Agon server
+//  Run from the Agon directory (for assets/layout.csv), then connect the game to ws://localhost:4500/ws
+//  (environment variable AGON_SERVER_URL of the client).
+
+int main(int argc, char* argv[]) {
+    ServerSettings const settings = ServerSettings::from_command_line(argc, argv);
+
+    // The connections are accepted on the main thread, then moved to the workers of their rooms
+    net::io_context ioc{ 1 };
+    auto const server = std::make_shared<RoomServer>(ioc, settings);
+    if (!server->initialize())
+        return EXIT_FAILURE;
+
+    beast::error_code ec;
+    auto const address = net::ip::make_address(settings.address, ec);
+    if (ec) {
+        std::cerr << "Invalid address " << settings.address << ": " << ec.message() << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (!std::make_shared<Listener>(ioc, tcp::endpoint{ address, settings.port }, server)->run())
+        return EXIT_FAILURE;
+    server->start();
+
+    std::cout << "Agon server listening on ws://" << settings.address << ":" << settings.port << "/ws (" << settings.threads << " workers, "
+              << settings.tick_rate << " ticks/s, " << settings.max_players_per_room << " players per room)" << std::endl;
+
+    // Stop on Ctrl+C
+    net::signal_set signals(ioc, SIGINT, SIGTERM);
+    signals.async_wait([&ioc](beast::error_code const&, int) { ioc.stop(); });
+
+    ioc.run();
+    server->stop();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,569 @@
+#include "room.hpp"
+#include "session.hpp"
+#include "apartment.hpp"
+#include "interest_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Tolerances of the validation of the client positions (the updates are sent at a variable rate and can arrive in bursts)
+static float const speed_tolerance = 1.5f;        // Factor on the maximal running speed
+static float const distance_tolerance = 0.5f;     // Distance always allowed between two updates
+static float const hit_distance_tolerance = 3.0f; // Difference allowed between the reported and the actual distance of a hit
+static float const respawn_delay = 3.0f;          // Seconds before a simulated player respawns
+static double const max_hit_rewind = 1000.0;      // Oldest display time (ms before now) at which a hit is validated
+static float const udp_timeout = 1.0f;            // Seconds without any datagram before the states go back to the WebSocket (the client sends one every 100 ms)
+static float const max_input_dt = 0.1f;           // Longest step of a sequenced input
+static float const max_input_time = 0.25f;        // Simulation time a client may accumulate (bursts of inputs after a hitch)
+static size_t const max_pending_inputs = 64;      // Older inputs are dropped (the client is corrected by the next STATE)
+
+static bool read_vec3(nlohmann::json const& json, cgp::vec3& value) {
+    if (!json.is_object()) return false;
+    for (char const* key : { "x", "y", "z" })
+        if (!json.contains(key) || !json[key].is_number() || !std::isfinite(json[key].get<float>())) return false;
+    value = { json["x"].get<float>(), json["y"].get<float>(), json["z"].get<float>() };
+    return true;
+}
+
+static nlohmann::json write_vec3(cgp::vec3 const& value) {
+    return { {"x", value.x}, {"y", value.y}, {"z", value.z} };
+}
+
+// Time of the server clock in ms (stamped on the snapshots and sent to the clock synchronization of the clients)
+static double server_time() {
+    static auto const start = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Position of a player at a past server time, interpolated between the ticks around it (clamped to the kept history)
+static cgp::vec3 position_at(std::deque<std::pair<double, cgp::vec3>> const& history, double time, cgp::vec3 const& current) {
+    if (history.empty() || time >= history.back().first) return current;
+    if (time <= history.front().first) return history.front().second;
+    size_t k = 0;
+    while (history[k + 1].first < time) ++k;
+    float const alpha = float((time - history[k].first) / (history[k + 1].first - history[k].first));
+    return (1.0f - alpha) * history[k].second + alpha * history[k + 1].second;
+}
+
+// The states of a lost datagram are sent again at the next tick, unless a more recent one was sent since
+static void resend_states(std::map<std::string, uint64_t>& sent_versions, std::vector<std::pair<std::string, uint64_t>> const& states) {
+    for (auto const& state : states) {
+        auto const version = sent_versions.find(state.first);
+        if (version != sent_versions.end() && version->second == state.second)
+            version->second = 0;
+    }
+}
+
+static nlohmann::json health_message(int health) {
+    return { {"type", "UPDATE"}, {"content", {{"health", health}}} };
+}
+
+Room::Room(std::string const& id, Apartment* apartment_arg, InterestGrid const* interest_arg, UdpServer* udp_arg, int max_players_arg, int worker_arg)
+    : worker(worker_arg), room_id(id), apartment(apartment_arg), interest(interest_arg), udp(udp_arg), max_players(max_players_arg)
+{}
+
+bool Room::join(std::shared_ptr<Session> const& session, std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (find_member(session->username()) != nullptr) {
+        error = "Vous êtes déjà dans cette room.";
+        return false;
+    }
+    if (int(members.size()) >= max_players) {
+        error = "La partie a déjà commencé ou la partie a atteint le nombre maximum de joueurs.";
+        return false;
+    }
+
+    Member member;
+    member.key = session.get();
+    member.session = session;
+    member.username = session->username();
+    member.player = std::make_unique<Player>();
+    member.player->initialise_simulation();
+    member.player->set_apartment(apartment);
+    member.last_update = std::chrono::steady_clock::now();
+    member.phase = joined_players++;
+
+    // The new player receives the current state of all the others, then they are told about the arrival
+    session->send(make_server_message("Vous avez rejoint la partie : " + room_id + "."));
+    std::vector<std::string> entries;
+    for (Member const& other : members) {
+        entries.push_back(other.state.is_null() ? std::string() : make_snapshot_entry(other));
+        member.sent_versions[other.username] = other.state_version;
+    }
+    std::vector<bool> selection;
+    for (std::string const& entry : entries)
+        selection.push_back(!entry.empty());
+    if (auto snapshot = make_snapshot(entries, selection, server_time()))
+        session->send(snapshot);
+    broadcast(make_server_message("Le joueur " + member.username + " a rejoint la partie !"), nullptr);
+
+    members.push_back(std::move(member));
+    return true;
+}
+
+void Room::leave(Session* session) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto const it = std::find_if(members.begin(), members.end(), [session](Member const& m) { return m.key == session; });
+    if (it == members.end()) return;
+
+    std::string const username = it->username;
+    if (it->udp_token != 0 && udp != nullptr)
+        udp->unregister_player(it->udp_token);
+    members.erase(it);
+    for (Member& member : members)
+        member.sent_versions.erase(username);
+    broadcast(make_server_message("Le joueur " + username + " a quitté la partie."), nullptr);
+}
+
+bool Room::empty() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return members.empty();
+}
+
+int Room::player_count() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return int(members.size());
+}
+
+Room::Member* Room::find_member(Session const* session) {
+    for (Member& member : members)
+        if (member.key == session) return &member;
+    return nullptr;
+}
+
+Room::Member* Room::find_member(std::string const& username) {
+    for (Member& member : members)
+        if (member.username == username) return &member;
+    return nullptr;
+}
+
+void Room::handle_message(Session& session, std::string const& message) {
+    nlohmann::json const data = nlohmann::json::parse(message, nullptr, false);
+    if (!data.is_object() || !data.contains("type") || !data["type"].is_string()) {
+        std::cerr << "Room " << room_id << ": ignored malformed message from " << session.username() << std::endl;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Member* sender = find_member(&session);
+    if (sender == nullptr) return;
+
+    try {
+        std::string const type = data["type"].get<std::string>();
+        if (type == "CHAT") handle_chat(*sender, data);
+        else if (type == "UPDATE") handle_update(*sender, data);
+        else if (type == "INPUT") handle_input(*sender, data);
+        else if (type == "HIT") handle_hit(*sender, data);
+        else if (type == "TIME") handle_time(*sender, data);
+        else if (type == "UDP") handle_udp_request(*sender);
+        else std::cerr << "Room " << room_id << ": unknown message type " << type << std::endl;
+    }
+    catch (std::exception const& e) {
+        // Wrong field types in a message of a known type
+        std::cerr << "Room " << room_id << ": invalid message from " << sender->username << ": " << e.what() << std::endl;
+    }
+}
+
+void Room::handle_chat(Member& sender, nlohmann::json const& message) {
+    if (!message.contains("content") || !message["content"].is_string()) return;
+    // The sender displays its own message immediately
+    broadcast(make_message({ {"type", "CHAT"}, {"username", sender.username}, {"content", message["content"]} }), &sender);
+}
+
+void Room::handle_update(Member& sender, nlohmann::json const& message) {
+    if (!message.contains("content") || !message["content"].is_object()) return;
+    nlohmann::json content = message["content"];
+    content.erase("health"); // The health is owned by the server
+
+    auto const now = std::chrono::steady_clock::now();
+    float const elapsed = std::chrono::duration<float>(now - sender.last_update).count();
+    Player& player = *sender.player;
+
+    if (sender.simulated) {
+        // The position is computed by the server from the inputs: only the other fields (aim, flags) are kept
+        content["position"] = write_vec3(player.getPosition());
+    }
+    else {
+        cgp::vec3 position;
+        if (!content.contains("position") || !read_vec3(content["position"], position)) return;
+
+        cgp::vec3 const previous = player.getPosition();
+        cgp::vec3 const spawn = player.getSpawnPosition();
+        bool const at_spawn = cgp::norm(cgp::vec2(position.x - spawn.x, position.y - spawn.y)) < 0.1f;
+
+        if (player.isDead()) {
+            // A dead player comes back at the spawn point
+            if (!at_spawn) return;
+            player.respawn();
+            send(sender, make_message(health_message(player.getHP())));
+        }
+        else {
+            float const max_distance = player.getMaxVelocity() * 1.8f * speed_tolerance * elapsed + distance_tolerance;
+            float const distance = cgp::norm(cgp::vec2(position.x - previous.x, position.y - previous.y));
+            bool const first_update = sender.state.is_null(); // Any starting position (e.g. after a reconnection)
+            bool const too_fast = distance > max_distance && !at_spawn && !first_update;
+            bool const in_wall = apartment != nullptr && apartment->check_collision(position, 0.5f * player.getCollisionRadius());
+            if (too_fast || in_wall) {
+                std::cerr << "Room " << room_id << ": rejected position of " << sender.username << (too_fast ? " (speed)" : " (wall)") << std::endl;
+                return;
+            }
+        }
+        player.setPosition(position);
+    }
+
+    sender.last_update = now;
+    sender.state = std::move(content);
+    change_state(sender);
+}
+
+void Room::handle_input(Member& sender, nlohmann::json const& message) {
+    if (!message.contains("content") || !message["content"].is_object()) return;
+    nlohmann::json const& content = message["content"];
+
+    PlayerInput input;
+    if (content.contains("direction")) {
+        nlohmann::json const& direction = content["direction"];
+        float const x = direction.value("x", 0.0f);
+        float const y = direction.value("y", 0.0f);
+        if (!std::isfinite(x) || !std::isfinite(y)) return;
+        input.direction = { x, y, 0.0f };
+        float const length = cgp::norm(input.direction);
+        if (length > 1.0f) input.direction /= length;
+    }
+    input.run = content.value("run", false);
+    input.jump = content.value("jump", false);
+    input.shoot = content.value("shoot", false);
+    sender.simulated = true;
+
+    if (!content.contains("sequence")) {
+        sender.input = input;
+        return;
+    }
+
+    // Sequenced input of a predicting client: applied once, in order, with the dt used by the client
+    uint32_t const sequence = content["sequence"].get<uint32_t>();
+    float const dt = content.value("dt", 0.0f);
+    if (sequence <= sender.last_sequence || !std::isfinite(dt) || dt <= 0.0f) return;
+    sender.last_sequence = sequence;
+    sender.sequenced = true;
+    sender.pending_inputs.push_back({ sequence, std::min(dt, max_input_dt), input });
+    if (sender.pending_inputs.size() > max_pending_inputs)
+        sender.pending_inputs.pop_front();
+}
+
+void Room::handle_time(Member& sender, nlohmann::json const& message) {
+    if (!message.contains("content") || !message["content"].is_object()) return;
+    nlohmann::json const& content = message["content"];
+    if (!content.contains("client") || !content["client"].is_number()) return;
+    // Answered at once (not at the next tick): the waiting time would be counted in the round-trip time of the client
+    send(sender, make_message({ {"type", "TIME"}, {"content", {{"client", content["client"]}, {"server", server_time()}}} }));
+}
+
+void Room::handle_udp_request(Member& sender) {
+    // Without UDP on the server, the request is not answered and the client stays on the WebSocket
+    if (udp == nullptr || !udp->enabled()) return;
+    if (sender.udp_token == 0)
+        sender.udp_token = udp->register_player(shared_from_this(), sender.key);
+    send(sender, make_message({ {"type", "UDP"}, {"content", {{"port", udp->port()}, {"token", sender.udp_token}}} }));
+}
+
+void Room::bind_udp(Session const* session, udp::endpoint const& endpoint) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Member* member = find_member(session);
+    if (member == nullptr || (member->udp_bound && member->udp_endpoint == endpoint)) return;
+    member->udp_bound = true;
+    member->udp_endpoint = endpoint;
+    member->udp_last_received = std::chrono::steady_clock::now();
+    member->udp_sequencer = UdpSequencer();
+    member->udp_sent_states.clear();
+}
+
+void Room::check_udp_timeout(Member& member, std::chrono::steady_clock::time_point now) {
+    if (!member.udp_bound || std::chrono::duration<float>(now - member.udp_last_received).count() < udp_timeout) return;
+    member.udp_bound = false;
+    // The datagrams in flight will never be acknowledged
+    for (auto const& datagram : member.udp_sent_states)
+        resend_states(member.sent_versions, datagram.second);
+    member.udp_sent_states.clear();
+    std::cerr << "Room " << room_id << ": no datagram from " << member.username << ", states sent by the WebSocket" << std::endl;
+}
+
+void Room::handle_datagram(Session const* session, UdpDataHeader const& header, std::string const& message) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Member* sender = find_member(session);
+    if (sender == nullptr || sender->udp_token == 0) return;
+    // The datagrams come from the endpoint bound by the HELLO (see UdpServer): after a timeout, the channel is used again
+    //  as soon as they arrive again (the sequence numbers go on)
+    sender->udp_bound = true;
+    sender->udp_last_received = std::chrono::steady_clock::now();
+
+    std::vector<uint16_t> acknowledged, lost;
+    bool const recent = sender->udp_sequencer.receive(header, acknowledged, lost);
+    for (uint16_t sequence : acknowledged)
+        sender->udp_sent_states.erase(sequence);
+    for (uint16_t sequence : lost) {
+        auto const it = sender->udp_sent_states.find(sequence);
+        if (it == sender->udp_sent_states.end()) continue;
+        resend_states(sender->sent_versions, it->second);
+        sender->udp_sent_states.erase(it);
+    }
+
+    // A late datagram is out of date; only the frequent states are accepted (the other messages need the WebSocket)
+    if (!recent || message.empty()) return;
+    nlohmann::json const data = nlohmann::json::parse(message, nullptr, false);
+    if (!data.is_object() || !data.contains("type") || !data["type"].is_string()) return;
+    try {
+        std::string const type = data["type"].get<std::string>();
+        if (type == "UPDATE") handle_update(*sender, data);
+        else if (type == "INPUT") handle_input(*sender, data);
+    }
+    catch (std::exception const& e) {
+        std::cerr << "Room " << room_id << ": invalid datagram from " << sender->username << ": " << e.what() << std::endl;
+    }
+}
+
+void Room::handle_hit(Member& shooter, nlohmann::json const& message) {
+    if (!message.contains("target") || !message["target"].is_string()) return;
+    // The shooter is the sender (the "shooter" field of the message is not trusted)
+    Member* target = find_member(message["target"].get<std::string>());
+    if (target == nullptr || target == &shooter) return;
+    if (shooter.player->isDead() || target->player->isDead()) return;
+
+    int const damage = std::max(0, std::min(100, message.value("damage", 0)));
+    // The shooter aimed at the target displayed in the past (interpolation delay): the target is rewound to the time of the hit
+    cgp::vec3 target_position = target->player->getPosition();
+    if (message.contains("time") && message["time"].is_number())
+        target_position = position_at(target->position_history, message["time"].get<double>(), target_position);
+    float const actual_distance = cgp::norm(target_position - shooter.player->getPosition());
+    float const reported_distance = message.value("distance", actual_distance);
+    if (std::abs(reported_distance - actual_distance) > hit_distance_tolerance) {
+        std::cerr << "Room " << room_id << ": rejected hit of " << shooter.username << " on " << target->username
+                  << " (distance " << reported_distance << " instead of " << actual_distance << ")" << std::endl;
+        return;
+    }
+
+    Player& target_player = *target->player;
+    target_player.setHP(target_player.getHP() - damage);
+    send(*target, make_message(health_message(target_player.getHP())));
+
+    if (target_player.getHP() == 0) {
+        target_player.die();
+        target->respawn_timer = 0.0f;
+        broadcast(make_server_message("Le joueur " + target->username + " a été éliminé par " + shooter.username + "."), nullptr);
+    }
+}
+
+void Room::simulate(Member& member, float dt) {
+    Player& player = *member.player;
+    if (!member.sequenced) {
+        player.step(dt, member.input);
+        return;
+    }
+
+    // The inputs may not use more time than elapsed on the server (a faster client would move faster)
+    member.input_time = std::min(member.input_time + dt, max_input_time);
+    bool applied = false;
+    uint32_t acknowledged = 0;
+    while (!member.pending_inputs.empty() && member.pending_inputs.front().dt <= member.input_time) {
+        Member::SequencedInput const& pending = member.pending_inputs.front();
+        player.step(pending.dt, pending.input);
+        member.input_time -= pending.dt;
+        acknowledged = pending.sequence;
+        applied = true;
+        member.pending_inputs.pop_front();
+    }
+    if (!applied) return;
+
+    // Authoritative state after the last applied input, for the reconciliation of the client
+    PlayerMovementState const state = player.getMovementState();
+    send_state(member, make_message({ {"type", "STATE"}, {"content", {
+        {"sequence", acknowledged},
+        {"position", write_vec3(state.position)},
+        {"velocity", write_vec3(state.velocity)},
+        {"verticalVelocity", state.vertical_velocity},
+        {"grounded", state.grounded}
+    }} }), {});
+}
+
+void Room::tick(float dt) {
+    auto const start = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (Member& member : members) {
+        if (!member.simulated) continue;
+        Player& player = *member.player;
+
+        if (player.isDead()) {
+            member.respawn_timer += dt;
+            if (member.respawn_timer < respawn_delay) continue;
+            player.respawn();
+            send(member, make_message(health_message(player.getHP())));
+        }
+
+        cgp::vec3 const previous = player.getPosition();
+        bool const was_moving = player.isMoving();
+        bool const was_shooting = player.isShooting();
+        simulate(member, dt);
+
+        if (member.state.is_null() || cgp::norm(player.getPosition() - previous) > 1e-5f || player.isMoving() != was_moving || player.isShooting() != was_shooting) {
+            member.state["position"] = write_vec3(player.getPosition());
+            member.state["isMoving"] = player.isMoving();
+            member.state["isRunning"] = player.isRunning();
+            member.state["isShooting"] = player.isShooting();
+            change_state(member);
+        }
+    }
+
+    // Each state is serialized once, then every player receives the changed states relevant at this tick
+    double const time = server_time();
+    for (Member& member : members) {
+        member.position_history.emplace_back(time, member.player->getPosition());
+        while (member.position_history.front().first < time - max_hit_rewind)
+            member.position_history.pop_front();
+    }
+    std::vector<std::string> entries(members.size());
+    for (size_t k = 0; k < members.size(); ++k)
+        if (!members[k].state.is_null()) entries[k] = make_snapshot_entry(members[k]);
+
+    std::map<std::vector<bool>, std::shared_ptr<std::string const>> snapshots; // Players with the same selection share the message
+    for (Member& recipient : members) {
+        check_udp_timeout(recipient, start);
+        std::vector<bool> selection(members.size(), false);
+        bool selected = false;
+        for (size_t k = 0; k < members.size(); ++k) {
+            Member const& other = members[k];
+            if (entries[k].empty()) continue;
+            uint64_t& sent_version = recipient.sent_versions[other.username];
+            if (other.state_version <= sent_version) continue;
+            if (&other == &recipient) {
+                // The own changed state is kept in the selection (the client ignores it): the players near each other
+                //  then have the same selection and share the serialized message
+                selection[k] = true;
+                sent_version = other.state_version;
+                continue;
+            }
+
+            InterestGrid::Relevance const relevance = interest != nullptr
+                ? interest->relevance(recipient.player->getPosition(), other.player->getPosition())
+                : InterestGrid::Relevance::Near;
+            int const interval = interest != nullptr ? interest->interval(relevance) : 1;
+            if ((tick_count + recipient.phase) % interval != 0) {
+                tick_statistics.updates_deferred++;
+                continue;
+            }
+            selection[k] = true;
+            selected = true;
+            sent_version = other.state_version;
+            tick_statistics.updates_sent++;
+        }
+        if (!selected) continue;
+
+        if (recipient.udp_bound && udp != nullptr) {
+            send_snapshot_datagrams(recipient, entries, selection, time);
+            continue;
+        }
+        std::shared_ptr<std::string const>& snapshot = snapshots[selection];
+        if (snapshot == nullptr)
+            snapshot = make_snapshot(entries, selection, time);
+        send(recipient, snapshot);
+    }
+    tick_count++;
+
+    double const lateness = std::chrono::duration<double, std::milli>(start - scheduled_tick).count();
+    double const tick_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    tick_statistics.ticks++;
+    tick_statistics.tick_time_total += tick_time;
+    tick_statistics.tick_time_max = std::max(tick_statistics.tick_time_max, tick_time);
+    tick_statistics.lateness_total += lateness;
+    tick_statistics.lateness_max = std::max(tick_statistics.lateness_max, lateness);
+}
+
+Room::TickStatistics Room::take_tick_statistics() {
+    std::lock_guard<std::mutex> lock(mutex);
+    TickStatistics statistics = tick_statistics;
+    statistics.skipped = skipped_ticks.exchange(0);
+    tick_statistics = TickStatistics();
+    return statistics;
+}
+
+void Room::send(Member& member, std::shared_ptr<std::string const> const& message) {
+    // The posted write keeps the session alive: it is never destroyed here, under the lock of the room
+    if (auto session = member.session.lock())
+        session->send(message);
+}
+
+void Room::broadcast(std::shared_ptr<std::string const> const& message, Member const* except) {
+    for (Member& member : members)
+        if (&member != except) send(member, message);
+}
+
+void Room::send_state(Member& member, std::shared_ptr<std::string const> const& message, std::vector<std::pair<std::string, uint64_t>>&& states) {
+    if (!member.udp_bound || udp == nullptr || message->size() + udp_data_header_size > udp_max_datagram_size) {
+        send(member, message);
+        return;
+    }
+    UdpDataHeader const header = member.udp_sequencer.next_header();
+    if (!states.empty())
+        member.udp_sent_states[header.sequence] = std::move(states);
+    udp->send(member.udp_endpoint, encode_udp_data_header(header), message);
+}
+
+void Room::send_snapshot_datagrams(Member& recipient, std::vector<std::string> const& entries, std::vector<bool> const& selection, double time) {
+    size_t const empty_size = udp_data_header_size + snapshot_prefix(time).size() + 2;
+    std::vector<bool> part(selection.size(), false);
+    std::vector<std::pair<std::string, uint64_t>> part_states; // Kept to send them again if their datagram is lost
+    size_t part_size = empty_size;
+    auto const flush = [&]() {
+        if (part_states.empty()) return;
+        send_state(recipient, make_snapshot(entries, part, time), std::move(part_states));
+        part.assign(selection.size(), false);
+        part_states.clear();
+        part_size = empty_size;
+    };
+
+    for (size_t k = 0; k < selection.size(); ++k) {
+        if (!selection[k] || &members[k] == &recipient) continue; // The datagrams are not shared: the own state is left out
+        if (!part_states.empty() && part_size + 1 + entries[k].size() > udp_max_datagram_size)
+            flush();
+        part_size += entries[k].size() + (part_states.empty() ? 0 : 1);
+        part[k] = true;
+        part_states.emplace_back(members[k].username, members[k].state_version);
+    }
+    flush();
+}
+
+std::shared_ptr<std::string const> Room::make_message(nlohmann::json const& message) {
+    return std::make_shared<std::string const>(message.dump());
+}
+
+std::shared_ptr<std::string const> Room::make_server_message(std::string const& content) {
+    return make_message({ {"type", "SERVER"}, {"content", content} });
+}
+
+void Room::change_state(Member& member) {
+    member.state_version = ++last_state_version;
+}
+
+std::string Room::snapshot_prefix(double time) {
+    return "{\"type\":\"SNAPSHOT\",\"time\":" + nlohmann::json(time).dump() + ",\"content\":[";
+}
+
+std::string Room::make_snapshot_entry(Member const& member) {
+    return nlohmann::json{ {"username", member.username}, {"content", member.state} }.dump();
+}
+
+std::shared_ptr<std::string const> Room::make_snapshot(std::vector<std::string> const& entries, std::vector<bool> const& selection, double time) {
+    // {"type":"SNAPSHOT","time":...,"content":[entry, ...]}, built from the serialized entries
+    std::string message = snapshot_prefix(time);
+    bool empty = true;
+    for (size_t k = 0; k < entries.size(); ++k) {
+        if (!selection[k]) continue;
+        if (!empty) message += ',';
+        message += entries[k];
+        empty = false;
+    }
+    if (empty) return nullptr;
+    message += "]}";
+    return std::make_shared<std::string const>(std::move(message));
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "player.hpp"
+#include "udp_server.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+class Apartment;
+class InterestGrid;
+class Session;
+
+// Game room: the players connected with the same roomId
+//  The movement of the players is simulated with the same Player::step and Apartment::check_collision code as the client:
+//  - INPUT messages (movement commands) are applied at each tick by the server, which is then authoritative on the position.
+//    Sequenced inputs (client prediction) are applied one by one with their own dt, and the player receives its state after
+//    the last processed input (STATE message) to reconcile its prediction.
+//  - UPDATE messages (positions computed by the client) are validated against the walls and a maximal speed before being relayed.
+//  The states that changed since the previous tick are gathered in a SNAPSHOT message at the end of each tick. The InterestGrid
+//  selects the states sent to each player (far or hidden players at a reduced rate): every state is serialized once, and the
+//  players receiving the same selection share the same buffer.
+//  A player having opened the UDP channel receives its snapshots and states by UDP, and may send its UPDATE and INPUT by UDP.
+//  The states of a snapshot acknowledged as lost are sent again at the next tick (if they did not change in between).
+//  Every public method is thread safe (the sessions of a room run on different strands).
+class Room : public std::enable_shared_from_this<Room> {
+public:
+    Room(std::string const& id, Apartment* apartment, InterestGrid const* interest, UdpServer* udp, int max_players, int worker);
+
+    // Add the player of the session (returns false with the error message if the room is full or the player already inside)
+    bool join(std::shared_ptr<Session> const& session, std::string& error);
+    void leave(Session* session);
+    bool empty() const;
+    int player_count() const;
+    std::string const& id() const { return room_id; }
+
+    // Handle a message received from a player of the room
+    void handle_message(Session& session, std::string const& message);
+
+    // UDP channel of a player: address bound by its HELLO, and received DATA datagram (called by the UdpServer)
+    void bind_udp(Session const* session, udp::endpoint const& endpoint);
+    void handle_datagram(Session const* session, UdpDataHeader const& header, std::string const& message);
+
+    // Advance the simulation of the room by dt (fixed tick), and broadcast the changed states
+    void tick(float dt);
+
+    // Scheduling state (TickScheduler)
+    int const worker;                                       // Worker owning the room: its sessions run on this worker
+    std::atomic<bool> queued{false};                        // A tick of the room is waiting or running
+    std::atomic<bool> closed{false};                        // Removed from the server: no more ticks
+    std::chrono::steady_clock::time_point scheduled_tick;   // Time at which the queued tick was due
+    std::atomic<int> skipped_ticks{0};                      // Ticks not run because the previous one was not finished
+
+    // Tick measures since the last call
+    struct TickStatistics {
+        int ticks = 0;
+        int skipped = 0;
+        double tick_time_total = 0.0;   // ms
+        double tick_time_max = 0.0;
+        double lateness_total = 0.0;    // Delay between the due time of a tick and its start (ms)
+        double lateness_max = 0.0;
+        uint64_t updates_sent = 0;      // Player states sent in the snapshots
+        uint64_t updates_deferred = 0;  // Changed states not sent at this tick because of their relevance
+    };
+    TickStatistics take_tick_statistics();
+
+private:
+    struct Member {
+        Session* key = nullptr;                 // Identifies the session (also after its destruction)
+        std::weak_ptr<Session> session;
+        std::string username;
+        std::unique_ptr<Player> player;
+
+        PlayerInput input;                      // Last received INPUT
+        bool simulated = false;                 // True once INPUT was received: the server computes the position
+        struct SequencedInput {
+            uint32_t sequence;
+            float dt;
+            PlayerInput input;
+        };
+        std::deque<SequencedInput> pending_inputs;  // Sequenced INPUT not yet applied
+        uint32_t last_sequence = 0;             // Last sequenced input received
+        bool sequenced = false;                 // The client predicts its movement: only its inputs move the player
+        float input_time = 0.0f;                // Simulation time the client may still use (limits the speed of the inputs)
+        nlohmann::json state;                   // Content of the UPDATE sent to the other players
+        uint64_t state_version = 0;             // Increased at each change of the state (numbered for the whole room)
+        std::map<std::string, uint64_t> sent_versions;  // Version of the state of each other player last sent to this one
+        int phase = 0;                          // Offset of the reduced rate updates of this player
+        std::chrono::steady_clock::time_point last_update;
+        float respawn_timer = 0.0f;             // Time since the death of a simulated player
+        std::deque<std::pair<double, cgp::vec3>> position_history; // Position at the recent ticks (server time in ms): the hits are validated where the shooter saw the target
+
+        uint64_t udp_token = 0;                 // Given on the WebSocket (0: no UDP channel requested)
+        bool udp_bound = false;                 // The HELLO of the token arrived: the states are sent by UDP
+        udp::endpoint udp_endpoint;
+        std::chrono::steady_clock::time_point udp_last_received; // Last datagram of the player (see Room::check_udp_timeout)
+        UdpSequencer udp_sequencer;
+        std::map<uint16_t, std::vector<std::pair<std::string, uint64_t>>> udp_sent_states; // States (username, version) of each datagram in flight
+    };
+
+    Member* find_member(Session const* session);
+    Member* find_member(std::string const& username);
+
+    void handle_chat(Member& sender, nlohmann::json const& message);
+    void handle_update(Member& sender, nlohmann::json const& message);
+    void handle_input(Member& sender, nlohmann::json const& message);
+    void handle_hit(Member& shooter, nlohmann::json const& message);
+    void handle_time(Member& sender, nlohmann::json const& message);
+    void handle_udp_request(Member& sender);
+    // Without any datagram for a while, the channel of the player is unbound: the states in flight are sent again by the WebSocket
+    void check_udp_timeout(Member& member, std::chrono::steady_clock::time_point now);
+
+    // Send to one player / to every player except one (nullptr: everybody)
+    void send(Member& member, std::shared_ptr<std::string const> const& message);
+    void broadcast(std::shared_ptr<std::string const> const& message, Member const* except);
+    // Send a snapshot or a state: by UDP if the channel of the player is bound (the sent states are remembered until
+    //  the datagram is acknowledged), otherwise by the WebSocket
+    void send_state(Member& member, std::shared_ptr<std::string const> const& message, std::vector<std::pair<std::string, uint64_t>>&& states);
+    // Send the selected entries by UDP in as many SNAPSHOT datagrams as needed to stay under udp_max_datagram_size
+    //  (an entry alone above the limit goes by the WebSocket)
+    void send_snapshot_datagrams(Member& recipient, std::vector<std::string> const& entries, std::vector<bool> const& selection, double time);
+    static std::shared_ptr<std::string const> make_message(nlohmann::json const& message);
+    static std::shared_ptr<std::string const> make_server_message(std::string const& content);
+    // SNAPSHOT message made of the selected entries, stamped with the server time of the tick (nullptr if none is selected)
+    static std::string snapshot_prefix(double time);
+    static std::string make_snapshot_entry(Member const& member);
+    static std::shared_ptr<std::string const> make_snapshot(std::vector<std::string> const& entries, std::vector<bool> const& selection, double time);
+    void change_state(Member& member);
+    // Apply the inputs of a simulated player for one tick, and acknowledge the sequenced ones
+    void simulate(Member& member, float dt);
+
+    std::string const room_id;
+    Apartment* apartment;       // Shared by all the rooms (only read)
+    InterestGrid const* interest;
+    UdpServer* udp;             // Shared by all the rooms (nullptr: no UDP)
+    int const max_players;
+
+    mutable std::mutex mutex;
+    std::vector<Member> members;
+    TickStatistics tick_statistics;
+    uint64_t last_state_version = 0;
+    uint64_t tick_count = 0;
+    int joined_players = 0;     // Used to spread the phases of the players
+};
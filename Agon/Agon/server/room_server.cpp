@@ -0,0 +1,168 @@
+#include "room_server.hpp"
+#include "room.hpp"
+#include "session.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+RoomServer::RoomServer(net::io_context& ioc_arg, ServerSettings const& settings_arg)
+    : ioc(ioc_arg), settings(settings_arg)
+    , interest(settings_arg.interest_distance, settings_arg.tick_rate, settings_arg.reduced_rate, settings_arg.hidden_rate)
+    , udp(ioc_arg), scheduler(settings_arg.threads, settings_arg.tick_rate), report_timer(ioc_arg)
+{}
+
+bool RoomServer::initialize() {
+    apartment.initialize_collision(settings.layout);
+    if (apartment.wall_positions.empty()) {
+        std::cerr << "Cannot load the layout " << settings.layout << std::endl;
+        return false;
+    }
+    interest.load(settings.layout);
+    std::cout << "Layout " << settings.layout << ": " << apartment.wall_positions.size() << " collision boxes" << std::endl;
+
+    // Without UDP port, the server still works with the WebSockets only
+    if (settings.udp) {
+        beast::error_code ec;
+        auto const address = net::ip::make_address(settings.address, ec);
+        if (!ec && udp.open(address, settings.udp_port != 0 ? settings.udp_port : settings.port))
+            std::cout << "UDP channel of the states on port " << udp.port() << std::endl;
+    }
+    return true;
+}
+
+void RoomServer::start() {
+    scheduler.start();
+    last_report = std::chrono::steady_clock::now();
+    if (settings.report_period > 0)
+        schedule_report();
+}
+
+void RoomServer::stop() {
+    report_timer.cancel();
+    udp.close();
+    scheduler.stop();
+}
+
+int RoomServer::worker_for_room(std::string const& room_id) {
+    std::lock_guard<std::mutex> lock(rooms_mutex);
+    auto const it = rooms.find(room_id);
+    if (it != rooms.end())
+        return it->second->worker;
+    return scheduler.least_loaded_worker();
+}
+
+std::shared_ptr<Room> RoomServer::join(std::shared_ptr<Session> const& session, std::string const& room_id, int worker, std::string& error) {
+    std::lock_guard<std::mutex> lock(rooms_mutex);
+    if (player_rooms.count(session->username()) > 0) {
+        error = "Vous êtes déjà dans cette room.";
+        return nullptr;
+    }
+
+    std::shared_ptr<Room>& room = rooms[room_id];
+    bool const created = room == nullptr;
+    if (created)
+        room = std::make_shared<Room>(room_id, &apartment, &interest, &udp, settings.max_players_per_room, worker);
+    if (!room->join(session, error)) {
+        if (created) rooms.erase(room_id);
+        return nullptr;
+    }
+    if (created)
+        scheduler.add(room);
+
+    player_rooms[session->username()] = room_id;
+    return room;
+}
+
+void RoomServer::leave(std::shared_ptr<Room> const& room, Session* session) {
+    std::lock_guard<std::mutex> lock(rooms_mutex);
+    room->leave(session);
+    player_rooms.erase(session->username());
+    if (room->empty()) {
+        scheduler.remove(*room);
+        rooms.erase(room->id());
+    }
+}
+
+void RoomServer::schedule_report() {
+    report_timer.expires_after(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(settings.report_period)));
+    report_timer.async_wait(beast::bind_front_handler(&RoomServer::on_report, shared_from_this()));
+}
+
+void RoomServer::on_report(beast::error_code ec) {
+    if (ec) return;
+    report();
+    schedule_report();
+}
+
+void RoomServer::report() {
+    auto const now = std::chrono::steady_clock::now();
+    double const elapsed = std::chrono::duration<double>(now - last_report).count();
+    last_report = now;
+
+    std::vector<std::shared_ptr<Room>> reported_rooms;
+    int player_count = 0;
+    {
+        std::lock_guard<std::mutex> lock(rooms_mutex);
+        for (auto const& room : rooms)
+            reported_rooms.push_back(room.second);
+        player_count = int(player_rooms.size());
+    }
+
+    // Measures of every room
+    struct RoomReport {
+        std::string id;
+        int worker;
+        Room::TickStatistics statistics;
+    };
+    std::vector<RoomReport> room_reports;
+    Room::TickStatistics total;
+    for (auto const& room : reported_rooms) {
+        Room::TickStatistics const s = room->take_tick_statistics();
+        room_reports.push_back({ room->id(), room->worker, s });
+        total.ticks += s.ticks;
+        total.skipped += s.skipped;
+        total.tick_time_total += s.tick_time_total;
+        total.tick_time_max = std::max(total.tick_time_max, s.tick_time_max);
+        total.lateness_total += s.lateness_total;
+        total.lateness_max = std::max(total.lateness_max, s.lateness_max);
+        total.updates_sent += s.updates_sent;
+        total.updates_deferred += s.updates_deferred;
+    }
+
+    UdpServer::Statistics const udp_statistics = udp.take_statistics();
+    double const budget = 1000.0 / settings.tick_rate;
+    std::cout << std::fixed << std::setprecision(3)
+              << "[server] rooms " << reported_rooms.size() << ", players " << player_count
+              << " (" << double(player_count) / settings.threads << " per worker)"
+              << " | tick mean " << (total.ticks > 0 ? total.tick_time_total / total.ticks : 0.0) << " ms, max " << total.tick_time_max
+              << " ms, budget " << budget << " ms | lateness mean " << (total.ticks > 0 ? total.lateness_total / total.ticks : 0.0)
+              << " ms, max " << total.lateness_max << " ms, skipped " << total.skipped
+              << " | in " << std::setprecision(1) << messages_received.exchange(0) / elapsed << " msg/s, out " << messages_sent.exchange(0) / elapsed
+              << " msg/s (" << bytes_sent.exchange(0) / elapsed / 1024.0 << " KB/s) | udp in " << udp_statistics.received / elapsed
+              << "/s, out " << udp_statistics.sent / elapsed << "/s (" << udp_statistics.bytes_sent / elapsed / 1024.0 << " KB/s) | states sent " << total.updates_sent / elapsed
+              << "/s, deferred " << total.updates_deferred / elapsed << "/s"
+              << std::endl;
+
+    std::vector<TickScheduler::WorkerStatistics> const workers = scheduler.take_worker_statistics();
+    for (int k = 0; k < int(workers.size()); ++k) {
+        std::cout << "  worker " << k << ": rooms " << workers[k].rooms << ", ticks " << workers[k].ticks
+                  << " (busy " << std::setprecision(1) << 100.0 * workers[k].busy / elapsed << "%), stolen " << workers[k].steals << std::endl;
+    }
+
+    // Rooms with the slowest ticks
+    std::sort(room_reports.begin(), room_reports.end(), [](RoomReport const& a, RoomReport const& b) {
+        return a.statistics.tick_time_max > b.statistics.tick_time_max;
+    });
+    int const slowest_count = std::min(int(room_reports.size()), 5);
+    for (int k = 0; k < slowest_count; ++k) {
+        RoomReport const& r = room_reports[k];
+        Room::TickStatistics const& s = r.statistics;
+        std::cout << std::setprecision(3) << "  room " << r.id << " (worker " << r.worker << "): ticks " << s.ticks
+                  << ", tick mean " << (s.ticks > 0 ? s.tick_time_total / s.ticks : 0.0) << " ms, max " << s.tick_time_max
+                  << " ms, lateness mean " << (s.ticks > 0 ? s.lateness_total / s.ticks : 0.0) << " ms, max " << s.lateness_max
+                  << " ms, skipped " << s.skipped << std::endl;
+    }
+    std::cout << std::defaultfloat;
+}
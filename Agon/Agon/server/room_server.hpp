@@ -0,0 +1,76 @@
+#pragma once
+
+#include "net.hpp"
+#include "server_settings.hpp"
+#include "apartment.hpp"
+#include "interest_grid.hpp"
+#include "tick_scheduler.hpp"
+#include "udp_server.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+class Room;
+class Session;
+
+// Local authoritative game server
+//  Stand-in for the remote server of the game (same WebSocket protocol), used for the tests and the network benchmarks.
+//  The rooms are created when their first player joins and removed when the last one leaves. Each room is owned by a worker
+//  of the TickScheduler, which runs its sessions and its fixed-rate ticks. The load (tick time and lateness per room and per
+//  worker, message rates) is periodically reported to measure the players per core and the tick jitter.
+//  The server is shared by the sessions and the pending handlers.
+class RoomServer : public std::enable_shared_from_this<RoomServer> {
+public:
+    RoomServer(net::io_context& ioc, ServerSettings const& settings);
+
+    // Load the collision data of the layout (returns false if the layout cannot be read), and open the UDP port
+    bool initialize();
+    // Start the workers and the statistics reports
+    void start();
+    void stop();
+
+    // Worker of the room (the least loaded one for a new room), and its io_context to run the sessions of the room
+    int worker_for_room(std::string const& room_id);
+    net::io_context& worker_context(int worker) { return scheduler.worker_context(worker); }
+
+    // Add the session to its room (nullptr with the error message if it cannot join)
+    //  A new room is owned by the worker of the session.
+    std::shared_ptr<Room> join(std::shared_ptr<Session> const& session, std::string const& room_id, int worker, std::string& error);
+    void leave(std::shared_ptr<Room> const& room, Session* session);
+
+    // Message counters of the statistics (called by the sessions)
+    void count_received() { messages_received.fetch_add(1, std::memory_order_relaxed); }
+    void count_sent(std::size_t bytes) {
+        messages_sent.fetch_add(1, std::memory_order_relaxed);
+        bytes_sent.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+private:
+    void schedule_report();
+    void on_report(beast::error_code ec);
+    void report();
+
+    net::io_context& ioc;       // Accepting thread (listener, upgrade requests and reports)
+    ServerSettings settings;
+    Apartment apartment;        // Collision boxes of the layout, shared by all the rooms
+    InterestGrid interest;      // Wall cells of the layout, shared by all the rooms
+    UdpServer udp;              // UDP channels of the players, shared by all the rooms
+
+    std::mutex rooms_mutex;
+    std::map<std::string, std::shared_ptr<Room>> rooms;
+    std::map<std::string, std::string> player_rooms;   // username -> roomId (one room at a time per account)
+
+    TickScheduler scheduler;
+    net::steady_timer report_timer;
+
+    // Statistics since the last report
+    std::atomic<uint64_t> messages_received{0};
+    std::atomic<uint64_t> messages_sent{0};
+    std::atomic<uint64_t> bytes_sent{0};
+    std::chrono::steady_clock::time_point last_report;
+};
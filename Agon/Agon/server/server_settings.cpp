@@ -0,0 +1,25 @@
+#include "server_settings.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+ServerSettings ServerSettings::from_command_line(int argc, char* argv[]) {
+    ServerSettings settings;
+    for (int k = 1; k < argc; ++k) {
+        std::string const arg = argv[k];
+        bool const has_value = k + 1 < argc;
+        if (arg == "--address" && has_value) settings.address = argv[++k];
+        else if (arg == "--port" && has_value) settings.port = static_cast<unsigned short>(std::atoi(argv[++k]));
+        else if (arg == "--threads" && has_value) settings.threads = std::max(1, std::atoi(argv[++k]));
+        else if (arg == "--tick" && has_value) settings.tick_rate = std::max(1, std::atoi(argv[++k]));
+        else if (arg == "--max-players" && has_value) settings.max_players_per_room = std::max(1, std::atoi(argv[++k]));
+        else if (arg == "--layout" && has_value) settings.layout = argv[++k];
+        else if (arg == "--report" && has_value) settings.report_period = std::max(0.0f, float(std::atof(argv[++k])));
+        else if (arg == "--interest-distance" && has_value) settings.interest_distance = std::max(0.0f, float(std::atof(argv[++k])));
+        else if (arg == "--reduced-rate" && has_value) settings.reduced_rate = std::max(1, std::atoi(argv[++k]));
+        else if (arg == "--hidden-rate" && has_value) settings.hidden_rate = std::max(1, std::atoi(argv[++k]));
+        else if (arg == "--udp-port" && has_value) settings.udp_port = static_cast<unsigned short>(std::atoi(argv[++k]));
+        else if (arg == "--no-udp") settings.udp = false;
+    }
+    return settings;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+// Options of the local room server
+//  Command line: agon_server [--address A] [--port P] [--threads N] [--tick Hz] [--max-players N] [--layout file.csv] [--report seconds]
+//                [--interest-distance m] [--reduced-rate Hz] [--hidden-rate Hz] [--udp-port P | --no-udp]
+struct ServerSettings {
+    std::string address = "0.0.0.0";
+    unsigned short port = 4500;             // Same port as the remote server (ws://host:4500/ws)
+    int threads = 1;                        // Workers running the rooms (sessions and ticks), plus one thread accepting the connections
+    int tick_rate = 30;                     // Simulation ticks per second of every room
+    int max_players_per_room = 4;
+    std::string layout = "assets/layout.csv";
+    float report_period = 5.0f;             // Seconds between two statistics reports on the standard output (0: never)
+
+    // Interest management: rate of the states of the other players
+    float interest_distance = 10.0f;        // Players closer than this and in line of sight are sent at every tick (0: always)
+    int reduced_rate = 10;                  // Updates per second of the players far away or behind a wall
+    int hidden_rate = 3;                    // Updates per second of the players far away and behind a wall
+
+    // UDP channel of the frequent states (the clients asking for it, otherwise the WebSocket)
+    bool udp = true;
+    unsigned short udp_port = 0;            // 0: same number as the WebSocket port
+
+    // Parse the server options (unknown arguments are ignored)
+    static ServerSettings from_command_line(int argc, char* argv[]);
+};
@@ -0,0 +1,115 @@
+#include "session.hpp"
+#include "room.hpp"
+#include "room_server.hpp"
+
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+// Maximal size of the messages waiting to be written to one client
+//  A SNAPSHOT only holds the states that changed since the previous tick, so the queued ones cannot be dropped:
+//  a client that late is disconnected instead of making the server memory grow without bound.
+static std::size_t const max_queued_bytes = 4 * 1024 * 1024;
+
+static void fail(beast::error_code ec, char const* what) {
+    // Normal disconnections are not reported
+    if (ec == net::error::operation_aborted || ec == websocket::error::closed || ec == http::error::end_of_stream
+        || ec == net::error::eof || ec == net::error::connection_reset)
+        return;
+    std::cerr << "Session " << what << ": " << ec.message() << std::endl;
+}
+
+Session::Session(tcp::socket&& socket, std::shared_ptr<RoomServer> const& server_arg, std::string const& username, std::string const& room_id_arg, int worker_arg)
+    : ws(std::move(socket)), server(server_arg), user(username), room_id(room_id_arg), worker(worker_arg)
+{}
+
+Session::~Session() {
+    if (room != nullptr)
+        server->leave(room, this);
+}
+
+void Session::run(http::request<http::string_body> request) {
+    ws.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+    ws.async_accept(request, beast::bind_front_handler(&Session::on_accept, shared_from_this()));
+}
+
+void Session::on_accept(beast::error_code ec) {
+    if (ec) return fail(ec, "accept");
+
+    // Same errors as the remote server, sent after the handshake so that the client can display them
+    if (user.empty())
+        return close_with_error("Identification requise.");
+    if (room_id.empty())
+        return close_with_error("ID de room requis.");
+
+    std::string error;
+    room = server->join(shared_from_this(), room_id, worker, error);
+    if (room == nullptr)
+        return close_with_error(error);
+
+    do_read();
+}
+
+void Session::do_read() {
+    ws.async_read(buffer, beast::bind_front_handler(&Session::on_read, shared_from_this()));
+}
+
+void Session::on_read(beast::error_code ec, std::size_t) {
+    if (ec) return fail(ec, "read");
+
+    server->count_received();
+    room->handle_message(*this, beast::buffers_to_string(buffer.data()));
+    buffer.consume(buffer.size());
+    do_read();
+}
+
+void Session::send(std::shared_ptr<std::string const> const& message) {
+    net::post(ws.get_executor(), beast::bind_front_handler(&Session::on_send, shared_from_this(), message));
+}
+
+void Session::close_with_error(std::string const& error) {
+    nlohmann::json message;
+    message["type"] = "ERROR";
+    message["message"] = error;
+    auto const text = std::make_shared<std::string const>(message.dump());
+    net::post(ws.get_executor(), [self = shared_from_this(), text]() {
+        self->close_after_write = true;
+        self->on_send(text);
+    });
+}
+
+void Session::on_send(std::shared_ptr<std::string const> const& message) {
+    if (overflowed) return;
+    if (queued_bytes + message->size() > max_queued_bytes) {
+        std::cerr << "Session " << user << ": more than " << max_queued_bytes / 1024 << " KB waiting to be sent, closing the connection" << std::endl;
+        overflowed = true;
+        // Cancels the pending read and write: the session is destroyed once their handlers have returned
+        beast::error_code ec;
+        beast::get_lowest_layer(ws).socket().close(ec);
+        return;
+    }
+
+    queue.push_back(message);
+    queued_bytes += message->size();
+    if (queue.size() > 1) return; // Already writing
+
+    ws.text(true);
+    ws.async_write(net::buffer(*queue.front()), beast::bind_front_handler(&Session::on_write, shared_from_this()));
+}
+
+void Session::on_write(beast::error_code ec, std::size_t bytes_transferred) {
+    if (ec) return fail(ec, "write");
+
+    server->count_sent(bytes_transferred);
+    queued_bytes -= queue.front()->size();
+    queue.erase(queue.begin());
+    if (!queue.empty()) {
+        ws.async_write(net::buffer(*queue.front()), beast::bind_front_handler(&Session::on_write, shared_from_this()));
+        return;
+    }
+    if (close_after_write)
+        ws.async_close(websocket::close_code::normal, beast::bind_front_handler(&Session::on_close, shared_from_this()));
+}
+
+void Session::on_close(beast::error_code ec) {
+    if (ec) fail(ec, "close");
+}
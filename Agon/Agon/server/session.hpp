@@ -0,0 +1,51 @@
+#pragma once
+
+#include "net.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+class RoomServer;
+class Room;
+
+// WebSocket connection of one player
+//  Created by the HttpSession on the worker owning the room (all its handlers run on the thread of this worker).
+//  The session joins the room after the handshake, forwards every received message to it, and sends the messages
+//  of the room in order with a write queue (the strings are shared between all the recipients of a broadcast).
+//  A client reading slower than the room sends is disconnected once its write queue exceeds a fixed size.
+class Session : public std::enable_shared_from_this<Session> {
+public:
+    Session(tcp::socket&& socket, std::shared_ptr<RoomServer> const& server, std::string const& username, std::string const& room_id, int worker);
+    ~Session();
+
+    // Accept the WebSocket handshake of the upgrade request
+    void run(http::request<http::string_body> request);
+
+    // Queue a message (thread safe: the write is posted on the strand of the session)
+    void send(std::shared_ptr<std::string const> const& message);
+    // Send an error message then close the connection
+    void close_with_error(std::string const& error);
+
+    std::string const& username() const { return user; }
+
+private:
+    void on_accept(beast::error_code ec);
+    void do_read();
+    void on_read(beast::error_code ec, std::size_t bytes_transferred);
+    void on_send(std::shared_ptr<std::string const> const& message);
+    void on_write(beast::error_code ec, std::size_t bytes_transferred);
+    void on_close(beast::error_code ec);
+
+    websocket::stream<beast::tcp_stream> ws;
+    beast::flat_buffer buffer;
+    std::vector<std::shared_ptr<std::string const>> queue;
+    std::size_t queued_bytes = 0;
+    bool close_after_write = false;
+    bool overflowed = false;    // The write queue exceeded its maximal size: the connection is closed
+
+    std::shared_ptr<RoomServer> server;
+    std::shared_ptr<Room> room;   // Set once the room accepted the player
+    std::string user;
+    std::string room_id;
+    int worker;
+};
@@ -0,0 +1,207 @@
+#include "tick_scheduler.hpp"
+#include "room.hpp"
+
+#include <algorithm>
+
+TickScheduler::TickScheduler(int worker_count, int tick_rate)
+    : period(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / tick_rate)))
+    , steal_delay(period / 16)
+{
+    for (int k = 0; k < worker_count; ++k)
+        workers.push_back(std::make_unique<Worker>());
+}
+
+TickScheduler::~TickScheduler() {
+    stop();
+}
+
+void TickScheduler::start() {
+    for (auto& worker : workers) {
+        // The io_context of a worker keeps running without sessions
+        worker->work = std::make_unique<net::executor_work_guard<net::io_context::executor_type>>(worker->ioc.get_executor());
+        Worker* w = worker.get();
+        worker->thread = std::thread([w]() { w->ioc.run(); });
+    }
+    {
+        std::lock_guard<std::mutex> lock(scheduler_mutex);
+        running = true;
+    }
+    scheduler = std::thread([this]() { run_scheduler(); });
+}
+
+void TickScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(scheduler_mutex);
+        if (!running) return;
+        running = false;
+    }
+    scheduler_condition.notify_all();
+    scheduler.join();
+
+    for (auto& worker : workers) {
+        worker->work.reset();
+        worker->ioc.stop();
+    }
+    for (auto& worker : workers)
+        worker->thread.join();
+}
+
+int TickScheduler::least_loaded_worker() const {
+    int best = 0;
+    for (int k = 1; k < int(workers.size()); ++k)
+        if (workers[k]->rooms < workers[best]->rooms) best = k;
+    return best;
+}
+
+void TickScheduler::add(std::shared_ptr<Room> const& room) {
+    workers[room->worker]->rooms++;
+    {
+        std::lock_guard<std::mutex> lock(scheduler_mutex);
+        // Successive rooms start at different fractions of the period (0, 1/2, 1/4, 3/4, 1/8, ...)
+        //  so that the ticks are evenly spread whatever the number of rooms
+        double phase = 0.0;
+        double scale = 0.5;
+        for (int bits = added_rooms++; bits > 0; bits >>= 1, scale *= 0.5)
+            if (bits & 1) phase += scale;
+        auto const offset = std::chrono::duration_cast<std::chrono::steady_clock::duration>(period * phase);
+        scheduled.push_back({ std::chrono::steady_clock::now() + period + offset, room });
+        std::push_heap(scheduled.begin(), scheduled.end());
+    }
+    scheduler_condition.notify_all();
+}
+
+void TickScheduler::remove(Room& room) {
+    // The entry of the room is dropped from the heap at its next due time
+    if (!room.closed.exchange(true))
+        workers[room.worker]->rooms--;
+}
+
+void TickScheduler::run_scheduler() {
+    std::unique_lock<std::mutex> lock(scheduler_mutex);
+    while (running) {
+        if (scheduled.empty()) {
+            scheduler_condition.wait(lock);
+            continue;
+        }
+        auto const now = std::chrono::steady_clock::now();
+        if (scheduled.front().time > now) {
+            scheduler_condition.wait_until(lock, scheduled.front().time);
+            continue;
+        }
+
+        std::pop_heap(scheduled.begin(), scheduled.end());
+        ScheduledTick entry = std::move(scheduled.back());
+        scheduled.pop_back();
+
+        std::shared_ptr<Room> const room = entry.room.lock();
+        if (room == nullptr || room->closed) continue;
+
+        if (room->queued.exchange(true)) {
+            // The previous tick is still waiting or running: the room is overloaded
+            room->skipped_ticks++;
+        }
+        else {
+            room->scheduled_tick = entry.time;
+            enqueue(room);
+        }
+
+        // Next tick of the room; the ticks missed by a late scheduler are skipped instead of run in a burst
+        entry.time += period;
+        while (entry.time <= now) {
+            entry.time += period;
+            room->skipped_ticks++;
+        }
+        scheduled.push_back(std::move(entry));
+        std::push_heap(scheduled.begin(), scheduled.end());
+    }
+}
+
+void TickScheduler::enqueue(std::shared_ptr<Room> const& room) {
+    Worker& owner = *workers[room->worker];
+    size_t backlog = 0;
+    {
+        std::lock_guard<std::mutex> lock(owner.mutex);
+        owner.queue.push_back(room);
+        backlog = owner.queue.size();
+    }
+    if (!owner.draining.exchange(true)) {
+        post_drain(room->worker);
+        return;
+    }
+    // The owner is busy with another tick: it normally runs this one right after it (the state of the room stays in its cache).
+    //  With several ticks waiting, an idle worker steals from its queue.
+    if (backlog < 2) return;
+    for (int k = 0; k < int(workers.size()); ++k) {
+        if (k != room->worker && !workers[k]->draining.exchange(true)) {
+            post_drain(k);
+            return;
+        }
+    }
+}
+
+void TickScheduler::post_drain(int worker) {
+    net::post(workers[worker]->ioc, [this, worker]() { drain(worker); });
+}
+
+void TickScheduler::drain(int worker) {
+    Worker& self = *workers[worker];
+    float const dt = std::chrono::duration<float>(period).count();
+    while (true) {
+        std::shared_ptr<Room> room = pop(worker);
+        if (room == nullptr) {
+            self.draining = false;
+            // A tick queued between the empty pop and the reset of the flag would not have posted a drain
+            {
+                std::lock_guard<std::mutex> lock(self.mutex);
+                if (self.queue.empty()) return;
+            }
+            if (self.draining.exchange(true)) return;
+            continue;
+        }
+        auto const start = std::chrono::steady_clock::now();
+        room->tick(dt);
+        room->queued = false;
+        self.ticks++;
+        self.busy_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+std::shared_ptr<Room> TickScheduler::pop(int worker) {
+    std::shared_ptr<Room> room;
+    {
+        Worker& self = *workers[worker];
+        std::lock_guard<std::mutex> lock(self.mutex);
+        if (!self.queue.empty()) {
+            room = std::move(self.queue.front());
+            self.queue.pop_front();
+            return room;
+        }
+    }
+    // Steal the oldest tick of another worker only if it is late: the owner is then busy (other ticks or the messages
+    //  of its sessions), otherwise it runs the tick itself with the state of the room in its cache
+    auto const now = std::chrono::steady_clock::now();
+    for (int k = 1; k < int(workers.size()); ++k) {
+        Worker& victim = *workers[(worker + k) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.queue.empty() && now - victim.queue.front()->scheduled_tick > steal_delay) {
+            room = std::move(victim.queue.front());
+            victim.queue.pop_front();
+            workers[worker]->steals++;
+            return room;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<TickScheduler::WorkerStatistics> TickScheduler::take_worker_statistics() {
+    std::vector<WorkerStatistics> statistics;
+    for (auto& worker : workers) {
+        WorkerStatistics s;
+        s.rooms = worker->rooms;
+        s.ticks = worker->ticks.exchange(0);
+        s.steals = worker->steals.exchange(0);
+        s.busy = worker->busy_ns.exchange(0) * 1e-9;
+        statistics.push_back(s);
+    }
+    return statistics;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "net.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Room;
+
+// Fixed pool of workers running the rooms
+//  Each worker has its own io_context and thread: the sessions of a room are moved to the worker owning the room
+//  (Room::worker), so that the messages of a room and its ticks are normally handled by the same thread.
+//  A scheduler thread keeps the next tick time of every room (the rooms are spread over the tick period to avoid
+//  all the ticks starting at the same instant) and queues the due ticks to the owner of the room. A worker with an
+//  empty queue steals the late ticks waiting in the queue of a busy worker (the room state is protected by the lock of the room).
+class TickScheduler {
+public:
+    TickScheduler(int worker_count, int tick_rate);
+    ~TickScheduler();
+
+    // Start / stop the workers and the scheduler thread
+    void start();
+    void stop();
+
+    int worker_count() const { return int(workers.size()); }
+    net::io_context& worker_context(int worker) { return workers[worker]->ioc; }
+    // Worker owning the fewest rooms (for a new room)
+    int least_loaded_worker() const;
+
+    // Tick the room periodically on its worker, until it is removed
+    void add(std::shared_ptr<Room> const& room);
+    void remove(Room& room);
+
+    // Counters of a worker since the last call
+    struct WorkerStatistics {
+        int rooms = 0;
+        uint64_t ticks = 0;     // Ticks run by the worker (its own rooms and the stolen ones)
+        uint64_t steals = 0;    // Ticks taken from the queue of another worker
+        double busy = 0.0;      // Time spent in the ticks (s)
+    };
+    std::vector<WorkerStatistics> take_worker_statistics();
+
+private:
+    struct Worker {
+        net::io_context ioc{1};
+        std::unique_ptr<net::executor_work_guard<net::io_context::executor_type>> work;
+        std::thread thread;
+
+        std::mutex mutex;
+        std::deque<std::shared_ptr<Room>> queue;    // Due ticks, the oldest first
+        std::atomic<bool> draining{false};          // A drain() is posted or running on this worker
+        std::atomic<int> rooms{0};
+        std::atomic<uint64_t> ticks{0};
+        std::atomic<uint64_t> steals{0};
+        std::atomic<int64_t> busy_ns{0};
+    };
+
+    void run_scheduler();
+    void enqueue(std::shared_ptr<Room> const& room);
+    void post_drain(int worker);
+    void drain(int worker);
+    std::shared_ptr<Room> pop(int worker);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::chrono::steady_clock::duration const period;
+    std::chrono::steady_clock::duration const steal_delay;  // Lateness from which another worker can take a tick
+
+    // Scheduler thread
+    std::thread scheduler;
+    std::mutex scheduler_mutex;
+    std::condition_variable scheduler_condition;
+    struct ScheduledTick {
+        std::chrono::steady_clock::time_point time;
+        std::weak_ptr<Room> room;
+        bool operator<(ScheduledTick const& other) const { return time > other.time; } // Min-heap on the time
+    };
+    std::vector<ScheduledTick> scheduled;           // Heap of the next tick of every room
+    bool running = false;
+    int added_rooms = 0;                            // Used to spread the tick phases of the rooms
+};
@@ -0,0 +1,125 @@
+#include "udp_server.hpp"
+#include "room.hpp"
+
+#include <iostream>
+#include <vector>
+
+UdpServer::UdpServer(net::io_context& ioc_arg)
+    : ioc(ioc_arg), socket(ioc_arg), random(std::random_device{}())
+{}
+
+bool UdpServer::open(net::ip::address const& address, unsigned short port) {
+    beast::error_code ec;
+    socket.open(address.is_v6() ? udp::v6() : udp::v4(), ec);
+    if (!ec) socket.bind(udp::endpoint{ address, port }, ec);
+    if (ec) {
+        std::cerr << "Cannot open the UDP port " << port << ": " << ec.message() << " (the states stay on the WebSockets)" << std::endl;
+        return false;
+    }
+    opened = true;
+    bound_port = socket.local_endpoint().port();
+    receive();
+    return true;
+}
+
+void UdpServer::close() {
+    beast::error_code ec;
+    socket.close(ec);
+    opened = false;
+}
+
+uint64_t UdpServer::register_player(std::weak_ptr<Room> const& room, Session const* key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t token = 0;
+    while (token == 0 || players.count(token) > 0)
+        token = random();
+    Player& player = players[token];
+    player.room = room;
+    player.key = key;
+    return token;
+}
+
+void UdpServer::unregister_player(uint64_t token) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto const it = players.find(token);
+    if (it == players.end()) return;
+    if (it->second.bound)
+        endpoints.erase(it->second.endpoint);
+    players.erase(it);
+}
+
+void UdpServer::send(udp::endpoint const& endpoint, std::string&& header, std::shared_ptr<std::string const> const& message) {
+    auto const datagram_header = std::make_shared<std::string const>(std::move(header));
+    // The socket is only used by the accepting thread
+    net::post(ioc, [this, endpoint, datagram_header, message]() {
+        std::array<net::const_buffer, 2> const buffers = { net::buffer(*datagram_header), net::buffer(*message) };
+        socket.async_send_to(buffers, endpoint, [this, datagram_header, message](beast::error_code ec, std::size_t size) {
+            if (ec) return;
+            datagrams_sent.fetch_add(1, std::memory_order_relaxed);
+            bytes_sent.fetch_add(size, std::memory_order_relaxed);
+        });
+    });
+}
+
+UdpServer::Statistics UdpServer::take_statistics() {
+    Statistics statistics;
+    statistics.received = datagrams_received.exchange(0);
+    statistics.sent = datagrams_sent.exchange(0);
+    statistics.bytes_sent = bytes_sent.exchange(0);
+    return statistics;
+}
+
+void UdpServer::receive() {
+    socket.async_receive_from(net::buffer(buffer), sender, beast::bind_front_handler(&UdpServer::on_receive, this));
+}
+
+void UdpServer::on_receive(beast::error_code ec, std::size_t size) {
+    if (ec == net::error::operation_aborted) return;
+    if (ec) {
+        receive();
+        return;
+    }
+    datagrams_received.fetch_add(1, std::memory_order_relaxed);
+
+    UdpPacket packet;
+    if (decode_udp_packet(buffer.data(), size, packet)) {
+        // The room is called without the lock (the rooms call register_player with their own lock)
+        std::shared_ptr<Room> room;
+        Session const* key = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (packet.kind == UdpPacketKind::HELLO) {
+                auto const it = players.find(packet.token);
+                if (it != players.end()) {
+                    Player& player = it->second;
+                    if (player.bound)
+                        endpoints.erase(player.endpoint);
+                    player.endpoint = sender;
+                    player.bound = true;
+                    endpoints[sender] = packet.token;
+                    room = player.room.lock();
+                    key = player.key;
+                }
+            }
+            else if (packet.kind == UdpPacketKind::DATA) {
+                auto const endpoint = endpoints.find(sender);
+                if (endpoint != endpoints.end()) {
+                    Player const& player = players[endpoint->second];
+                    room = player.room.lock();
+                    key = player.key;
+                }
+            }
+        }
+
+        if (room != nullptr && packet.kind == UdpPacketKind::HELLO) {
+            room->bind_udp(key, sender);
+            // Answered to every HELLO: the previous HELLO_ACK may have been lost
+            auto const ack = std::make_shared<std::string const>(encode_udp_hello(UdpPacketKind::HELLO_ACK, packet.token));
+            socket.async_send_to(net::buffer(*ack), sender, [ack](beast::error_code, std::size_t) {});
+        }
+        else if (room != nullptr) {
+            room->handle_datagram(key, packet.header, packet.message);
+        }
+    }
+    receive();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "net.hpp"
+#include "login/udp_packet.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+
+class Room;
+class Session;
+
+// UDP endpoint of the server for the frequent states (protocol in udp_packet.hpp)
+//  A room gives a token to each player asking for the channel on its WebSocket. The HELLO datagram of this token binds
+//  its source address to the player (answered by HELLO_ACK); the DATA datagrams from this address are then given to the
+//  room of the player, and the room sends the snapshots and the states of the player to it.
+//  The datagrams are received on the accepting thread. Every public method is thread safe.
+class UdpServer {
+public:
+    explicit UdpServer(net::io_context& ioc);
+
+    // Bind the socket and start receiving (returns false if the port cannot be used)
+    bool open(net::ip::address const& address, unsigned short port);
+    void close();
+    bool enabled() const { return opened; }
+    unsigned short port() const { return bound_port; }
+
+    // Token of a player of the room (the session identifies the player in the room), valid until unregister_player
+    uint64_t register_player(std::weak_ptr<Room> const& room, Session const* key);
+    void unregister_player(uint64_t token);
+
+    // Send a DATA datagram made of the header and the message (shared by the recipients: not copied)
+    void send(udp::endpoint const& endpoint, std::string&& header, std::shared_ptr<std::string const> const& message);
+
+    // Datagrams and bytes since the last call
+    struct Statistics {
+        uint64_t received = 0;
+        uint64_t sent = 0;
+        uint64_t bytes_sent = 0;
+    };
+    Statistics take_statistics();
+
+private:
+    void receive();
+    void on_receive(beast::error_code ec, std::size_t size);
+
+    struct Player {
+        std::weak_ptr<Room> room;
+        Session const* key = nullptr;
+        udp::endpoint endpoint;
+        bool bound = false;
+    };
+
+    net::io_context& ioc;
+    udp::socket socket;
+    bool opened = false;
+    unsigned short bound_port = 0;
+    std::array<char, 65536> buffer;
+    udp::endpoint sender;
+
+    std::mutex mutex;
+    std::map<uint64_t, Player> players;            // By token
+    std::map<udp::endpoint, uint64_t> endpoints;   // Token of each bound address
+    std::mt19937_64 random;
+
+    std::atomic<uint64_t> datagrams_received{0};
+    std::atomic<uint64_t> datagrams_sent{0};
+    std::atomic<uint64_t> bytes_sent{0};
+};
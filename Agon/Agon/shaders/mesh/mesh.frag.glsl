@@ -30,7 +30,7 @@ layout(location=0) out vec4 FragColor;
 
 uniform sampler2D image_texture;   // Texture image identifiant
 
-uniform mat4 view;       // View matrix (rigid transform) of the camera - to compute the camera position
+uniform vec3 camera_position; // Position of the camera in world space (computed once per frame on the CPU)
 
 uniform vec3 light; // position of the light
 
@@ -44,11 +44,15 @@ struct phong_structure {
 };
 
 // Settings for texture display
+//  When MATERIAL_VARIANT is defined, the settings are compile-time values (USE_TEXTURE, TEXTURE_INVERSE_V, TWO_SIDED)
+//  set by mesh_drawable_shader_variant, and the corresponding branches are removed from the shader
+#ifndef MATERIAL_VARIANT
 struct texture_settings_structure {
 	bool use_texture;       // Switch the use of texture on/off
 	bool texture_inverse_v; // Reverse the texture in the v component (1-v)
 	bool two_sided;         // Display a two-sided illuminated surface (doesn't work on Mac)
 };
+#endif
 
 // Material of the mesh (using a Phong model)
 struct material_structure
@@ -57,7 +61,9 @@ struct material_structure
 	float alpha; // alpha coefficient
 
 	phong_structure phong;                       // Phong coefficients
+#ifndef MATERIAL_VARIANT
 	texture_settings_structure texture_settings; // Additional settings for the texture
+#endif
 }; 
 
 uniform material_structure material;
@@ -65,20 +71,22 @@ uniform material_structure material;
 
 void main()
 {
-	// Compute the position of the center of the camera
-	mat3 O = transpose(mat3(view));                   // get the orientation matrix
-	vec3 last_col = vec3(view*vec4(0.0, 0.0, 0.0, 1.0)); // get the last column
-	vec3 camera_position = -O*last_col;
-
-
 	// Renormalize normal
 	vec3 N = normalize(fragment.normal);
 
 	// Inverse the normal if it is viewed from its back (two-sided surface)
 	//  (note: gl_FrontFacing doesn't work on Mac)
+#ifdef MATERIAL_VARIANT
+#if TWO_SIDED
+	if (gl_FrontFacing == false) {
+		N = -N;
+	}
+#endif
+#else
 	if (material.texture_settings.two_sided && gl_FrontFacing == false) {
 		N = -N;
 	}
+#endif
 
 	// Phong coefficient (diffuse, specular)
 	// *************************************** //
@@ -100,6 +108,19 @@ void main()
 	// Texture
 	// *************************************** //
 
+#ifdef MATERIAL_VARIANT
+#if USE_TEXTURE
+	// Current uv coordinates
+#if TEXTURE_INVERSE_V
+	vec2 uv_image = vec2(fragment.uv.x, 1.0-fragment.uv.y);
+#else
+	vec2 uv_image = fragment.uv;
+#endif
+	vec4 color_image_texture = texture(image_texture, uv_image);
+#else
+	vec4 color_image_texture = vec4(1.0,1.0,1.0,1.0);
+#endif
+#else
 	// Current uv coordinates
 	vec2 uv_image = vec2(fragment.uv.x, fragment.uv.y);
 	if(material.texture_settings.texture_inverse_v) {
@@ -111,6 +132,7 @@ void main()
 	if(material.texture_settings.use_texture == false) {
 		color_image_texture=vec4(1.0,1.0,1.0,1.0);
 	}
+#endif
 	
 	// Compute Shading
 	// *************************************** //
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "cgp/cgp.hpp"
+#include <string>
 #include <vector>
 
 class Apartment {
@@ -9,13 +10,18 @@ public:
     Apartment();
 
     // Initialize the apartment meshes and structures
-    void initialize();
+    //  The textures are decoded in the background by texture_loader and display a placeholder color until they are uploaded
+    void initialize(cgp::opengl_texture_async_loader_structure& texture_loader);
+
+    // Build only the collision boxes of the layout (no OpenGL context needed: used by the server simulation)
+    //  The drawing functions are defined in apartment_client.cpp, compiled in the game only
+    void initialize_collision(const std::string& layout_filename = "assets/layout.csv");
 
     // Clear all mesh data
     void clear();
 
-    // Draw the apartment
-    void draw(const cgp::environment_generic_structure& environment);
+    // Add the apartment to the render queue of the frame (all the walls share the same shader and texture)
+    void draw(cgp::render_queue_structure& queue, const cgp::environment_generic_structure& environment);
 
     // Collision detection for player movement
     bool check_collision(const cgp::vec3& position, float radius);
@@ -23,6 +29,10 @@ public:
     std::vector<cgp::vec3> wall_positions;
     std::vector<cgp::vec3> wall_dimensions;
 
+    // Cells of the layout file ('W': wall, 'D': door, '.': floor), one row per line
+    //  The grid is centered on the origin with 1m cells: cell (i,j) covers x in [j - cols/2, j + 1 - cols/2], y in [i - rows/2, i + 1 - rows/2]
+    static std::vector<std::vector<char>> load_layout_from_csv(const std::string& filename);
+
 private:
     // Apartment structure elements
     cgp::mesh_drawable floor;
@@ -39,20 +49,27 @@ private:
     float apartment_length;
     float room_height;
 
+    // Segments of the layout walls, turned into drawables by initialize
+    struct WallSegment {
+        float x1, y1, x2, y2, z1, z2, thickness;
+        bool isHorizontal;
+    };
+    std::vector<WallSegment> wall_segments;
+
     // Helper functions to create apartment components
     void create_floor();
     void create_ceiling();
     void create_walls();
 
-    // CSV grid loader and wall/door generator for flexible apartment layout
-    std::vector<std::vector<char>> load_layout_from_csv(const std::string& filename);
+    // Wall/door generator for flexible apartment layout
     void create_walls_from_grid(const std::vector<std::vector<char>>& grid);
     
     // Generate doors from grid layout 
     void create_door(float x1, float x2, float y, float z0, float z1, float wall_thickness, bool isHorizontal);
     
-    // Helper for simple wall segment creation
+    // Helper for simple wall segment creation (collision box and recorded segment)
     void create_wall_segment(float x1, float y1, float x2, float y2, float z1, float z2, float thickness, bool isHorizontal);
+    void create_wall_segment_drawables(const WallSegment& segment);
     
     // Texture for doors
     cgp::opengl_texture_image_structure door_texture;
@@ -1,4 +1,5 @@
 #include "audio_system.hpp"
+#include "profiler.hpp"
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -477,6 +478,7 @@ float AudioSystem::get_master_volume() const {
 }
 
 void AudioSystem::update() {
+    PROFILE_SCOPE("AudioSystem::update");
     if (!initialized) return;
     
     // Update listener properties
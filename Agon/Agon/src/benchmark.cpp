@@ -0,0 +1,188 @@
+#include "benchmark.hpp"
+#include "scene.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <nlohmann/json.hpp>
+
+BenchmarkSettings BenchmarkSettings::from_command_line(int argc, char* argv[]) {
+    BenchmarkSettings settings;
+    for (int k = 1; k < argc; ++k) {
+        std::string const arg = argv[k];
+        bool const has_value = k + 1 < argc;
+        if (arg == "--benchmark") settings.enabled = true;
+        else if (arg == "--players" && has_value) settings.players = std::max(0, std::atoi(argv[++k]));
+        else if (arg == "--frames" && has_value) settings.frames = std::max(1, std::atoi(argv[++k]));
+        else if (arg == "--warmup" && has_value) settings.warmup_frames = std::max(0, std::atoi(argv[++k]));
+        else if (arg == "--width" && has_value) settings.width = std::max(1, std::atoi(argv[++k]));
+        else if (arg == "--height" && has_value) settings.height = std::max(1, std::atoi(argv[++k]));
+        else if (arg == "--output" && has_value) settings.output = argv[++k];
+    }
+    return settings;
+}
+
+Benchmark::Benchmark(BenchmarkSettings const& settings_arg)
+    : settings(settings_arg)
+{}
+
+int Benchmark::run(scene_structure& scene) {
+    std::cout << "Benchmark: " << settings.players << " remote players, " << settings.frames << " frames (" << settings.warmup_frames << " warmup), "
+              << settings.width << "x" << settings.height << std::endl;
+
+    // Skip the login: the scene is drawn as in the game, with a fixed camera and no user input
+    scene.current_state = GameState::MAIN_GAME;
+    scene.username = "benchmark";
+    scene.fps_mode = true;
+    scene.cursor_mode = false;
+    scene.spectator_mode = false;
+    scene.follow_player_mode = false;
+
+    // The textures must be on the GPU before the measure (otherwise the first frames draw the placeholders)
+    scene.texture_loader.finish();
+    spawn_remote_players(scene);
+
+    scene.window.width = settings.width;
+    scene.window.height = settings.height;
+    scene.camera_projection.aspect_ratio = settings.width / static_cast<float>(settings.height);
+    scene.environment.camera_projection = scene.camera_projection.matrix();
+
+    frame_time_ms.clear();
+    draw_calls.clear();
+    program_changes.clear();
+    texture_changes.clear();
+    vao_changes.clear();
+
+    int const total_frames = settings.warmup_frames + settings.frames;
+    for (int frame = 0; frame < total_frames; ++frame) {
+        // Warmup frames start the path at the same position as the first measured frame
+        int const path_frame = std::max(0, frame - settings.warmup_frames);
+        scene.simulation_camera_view = camera_view_along_path(path_frame / static_cast<float>(settings.frames));
+        scene.publish_render_snapshot();
+
+        glViewport(0, 0, settings.width, settings.height);
+        vec3 const& background_color = scene.environment.background_color;
+        glClearColor(background_color.x, background_color.y, background_color.z, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glEnable(GL_DEPTH_TEST);
+
+        auto const start = std::chrono::steady_clock::now();
+        scene.display_frame();
+        glFinish(); // Include the GPU execution of the frame
+        auto const end = std::chrono::steady_clock::now();
+
+        glfwSwapBuffers(scene.window.glfw_window);
+        glfwPollEvents();
+
+        if (frame >= settings.warmup_frames) {
+            frame_time_ms.push_back(std::chrono::duration<float, std::milli>(end - start).count());
+            cgp::render_queue_structure::statistics_structure const& statistics = scene.frame_statistics;
+            draw_calls.push_back(statistics.draw_calls);
+            program_changes.push_back(statistics.program_changes);
+            texture_changes.push_back(statistics.texture_changes);
+            vao_changes.push_back(statistics.vao_changes);
+        }
+    }
+
+    std::string const renderer = reinterpret_cast<char const*>(glGetString(GL_RENDERER));
+    std::string const gl_version = reinterpret_cast<char const*>(glGetString(GL_VERSION));
+    if (!write_results(renderer, gl_version)) {
+        std::cerr << "Benchmark: cannot write the results to " << settings.output << std::endl;
+        return 1;
+    }
+    std::cout << "Benchmark results written to " << settings.output << std::endl;
+    return 0;
+}
+
+void Benchmark::spawn_remote_players(scene_structure& scene) const {
+    if (settings.players == 0) return;
+
+    // Regular grid over the apartment floor, each player looking in a different direction
+    int const columns = int(std::ceil(std::sqrt(float(settings.players))));
+    int const rows = (settings.players + columns - 1) / columns;
+    float const extent_x = 8.0f;
+    float const extent_y = 10.0f;
+
+    std::lock_guard<std::mutex> lock(scene.remote_players_mutex);
+    for (int k = 0; k < settings.players; ++k) {
+        int const i = k % columns;
+        int const j = k / columns;
+        cgp::vec3 const position = {
+            extent_x * ((i + 0.5f) / columns - 0.5f),
+            extent_y * ((j + 0.5f) / rows - 0.5f),
+            1.7f
+        };
+        float const yaw = 2.4f * k;
+        cgp::vec3 const front = { std::cos(yaw), std::sin(yaw), 0.0f };
+        cgp::mat4 const aim_view = cgp::inverse(cgp::camera_frame_look_at(position, position + front, { 0, 0, 1 })).matrix();
+
+        std::string const name = "bot_" + std::to_string(k);
+        RemotePlayer remote_player;
+        remote_player.model = scene.remote_player_model; // Same model as the players received from the server
+        remote_player.update_state(position, aim_view);
+        scene.remote_players[name] = std::move(remote_player);
+        scene.remote_player_usernames.push_back(name);
+    }
+}
+
+cgp::mat4 Benchmark::camera_view_along_path(float t) const {
+    // Ellipse inside the apartment, with the height of the camera going up and down twice per loop,
+    //  always looking at the center of the room (where most of the players are visible)
+    float const angle = 2.0f * cgp::Pi * t;
+    cgp::vec3 const eye = {
+        3.5f * std::cos(angle),
+        4.5f * std::sin(angle),
+        1.7f + 0.8f * std::sin(2.0f * angle)
+    };
+    cgp::vec3 const center = { 0.0f, 0.0f, 1.0f };
+    return cgp::inverse(cgp::camera_frame_look_at(eye, center, { 0, 0, 1 })).matrix();
+}
+
+// Value at the given percentile (nearest rank) of the sorted values
+template <typename T>
+static T percentile(std::vector<T> const& sorted_values, float p) {
+    size_t const rank = size_t(std::ceil(p / 100.0f * sorted_values.size()));
+    return sorted_values[std::min(sorted_values.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+template <typename T>
+static nlohmann::json summary(std::vector<T> values) {
+    nlohmann::json result;
+    if (values.empty()) return result;
+    std::sort(values.begin(), values.end());
+    double const sum = std::accumulate(values.begin(), values.end(), 0.0);
+    result["mean"] = sum / values.size();
+    result["min"] = values.front();
+    result["p50"] = percentile(values, 50.0f);
+    result["p90"] = percentile(values, 90.0f);
+    result["p95"] = percentile(values, 95.0f);
+    result["p99"] = percentile(values, 99.0f);
+    result["max"] = values.back();
+    return result;
+}
+
+bool Benchmark::write_results(std::string const& renderer, std::string const& gl_version) const {
+    nlohmann::json results;
+    results["players"] = settings.players;
+    results["frames"] = settings.frames;
+    results["warmup_frames"] = settings.warmup_frames;
+    results["width"] = settings.width;
+    results["height"] = settings.height;
+    results["renderer"] = renderer;
+    results["gl_version"] = gl_version;
+
+    results["frame_time_ms"] = summary(frame_time_ms);
+    results["draw_calls"] = summary(draw_calls);
+    results["program_changes"] = summary(program_changes);
+    results["texture_changes"] = summary(texture_changes);
+    results["vao_changes"] = summary(vao_changes);
+
+    std::ofstream file(settings.output);
+    if (!file) return false;
+    file << results.dump(4) << std::endl;
+    return bool(file);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "cgp/cgp.hpp"
+#include <string>
+#include <vector>
+
+struct scene_structure;
+
+// Options of the headless rendering benchmark
+//  Command line: Agon --benchmark [--players N] [--frames N] [--warmup N] [--width W] [--height H] [--output file.json]
+struct BenchmarkSettings {
+    bool enabled = false;           // Set by --benchmark
+    int players = 16;               // Number of synthetic remote players
+    int frames = 1000;              // Number of measured frames (one loop of the camera path)
+    int warmup_frames = 60;         // Frames drawn before the measure (lazy GPU uploads, shader variants, caches)
+    int width = 1280;               // Size of the offscreen framebuffer
+    int height = 720;
+    std::string output = "benchmark.json";
+
+    // Parse the benchmark options (the other arguments are ignored)
+    static BenchmarkSettings from_command_line(int argc, char* argv[]);
+};
+
+// Headless rendering benchmark for the automated performance regression runs
+//  The scene is used without login nor network: the game starts directly, N synthetic remote players are placed in the apartment,
+//  and the camera flies along a fixed scripted path (the same frames are drawn at every run).
+//  Each frame is timed from display_frame() to the end of its GPU execution (glFinish), and the frame time percentiles
+//  and render queue statistics are written to a JSON file.
+class Benchmark {
+public:
+    explicit Benchmark(BenchmarkSettings const& settings);
+
+    // Run the benchmark on the initialized scene (the OpenGL context must be current). Returns the exit code of the program.
+    int run(scene_structure& scene);
+
+private:
+    void spawn_remote_players(scene_structure& scene) const;
+    cgp::mat4 camera_view_along_path(float t) const; // t in [0,1]: one loop of the path
+    bool write_results(std::string const& renderer, std::string const& gl_version) const;
+
+    BenchmarkSettings settings;
+
+    // Measures of each frame
+    std::vector<float> frame_time_ms;
+    std::vector<int> draw_calls;
+    std::vector<int> program_changes;
+    std::vector<int> texture_changes;
+    std::vector<int> vao_changes;
+};
@@ -17,7 +17,7 @@ void Crosshair::initialize() {
     update_geometry();
     
     // Initialize the drawable with the geometry
-    crosshair_mesh.initialize_data_on_gpu(crosshair_geometry);
+    reinitialize_gpu_geometry();
     
     std::cout << "Crosshair: Successfully initialized" << std::endl;
 }
@@ -26,8 +26,9 @@ void Crosshair::set_type(CrosshairType new_type) {
     if (type != new_type) {
         type = new_type;
         update_geometry();
+        // The number of vertices and triangles depends on the type
         if (crosshair_mesh.vbo_position.id != 0) {
-            crosshair_mesh.initialize_data_on_gpu(crosshair_geometry);
+            reinitialize_gpu_geometry();
         }
     }
 }
@@ -40,8 +41,9 @@ void Crosshair::set_size(float new_size) {
     if (size != new_size) {
         size = new_size;
         update_geometry();
+        // Same topology: only the positions are streamed to the GPU
         if (crosshair_mesh.vbo_position.id != 0) {
-            crosshair_mesh.initialize_data_on_gpu(crosshair_geometry);
+            crosshair_mesh.vbo_position.update(crosshair_geometry.position);
         }
     }
 }
@@ -50,8 +52,9 @@ void Crosshair::set_thickness(float new_thickness) {
     if (thickness != new_thickness) {
         thickness = new_thickness;
         update_geometry();
+        // Same topology: only the positions are streamed to the GPU
         if (crosshair_mesh.vbo_position.id != 0) {
-            crosshair_mesh.initialize_data_on_gpu(crosshair_geometry);
+            crosshair_mesh.vbo_position.update(crosshair_geometry.position);
         }
     }
 }
@@ -60,6 +63,15 @@ void Crosshair::set_enabled(bool new_enabled) {
     enabled = new_enabled;
 }
 
+void Crosshair::reinitialize_gpu_geometry() {
+    // Release the previous buffers: initialize_data_on_gpu doesn't free them
+    if (crosshair_mesh.vao != 0) {
+        crosshair_mesh.clear();
+    }
+    crosshair_mesh.initialize_data_on_gpu(crosshair_geometry);
+    crosshair_mesh.vbo_position.set_update_mode(opengl_vbo_update_mode::stream);
+}
+
 void Crosshair::update_geometry() {
     switch (type) {
         case CrosshairType::CROSS:
@@ -250,7 +262,7 @@ void Crosshair::draw_opengl(const environment_structure& environment, int window
     // Create a temporary environment for 2D rendering
     environment_structure overlay_env = environment;
     overlay_env.camera_projection = projection;
-    overlay_env.camera_view = view;
+    overlay_env.set_camera_view(view);
     
     // Draw the crosshair
     draw(crosshair_mesh, overlay_env);
@@ -28,6 +28,7 @@ private:
     void create_circle_geometry();
     void create_crosshair_geometry();
     void update_geometry();
+    void reinitialize_gpu_geometry(); // Re-allocate the GPU buffers when the topology changes
 
 public:
     Crosshair();
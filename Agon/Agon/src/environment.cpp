@@ -10,6 +10,14 @@ bool project::fps_limiting = false;
 float project::fps_max=120.0f;
 // Automatic synchronization of GLFW with the vertical-monitor refresh
 bool project::vsync=false;     
+// Simulation on a separate thread at a fixed rate (not available with emscripten)
+#ifndef __EMSCRIPTEN__
+bool project::simulation_in_thread = true;
+#else
+bool project::simulation_in_thread = false;
+#endif
+// Number of simulation steps per second
+float project::simulation_rate = 60.0f;
 // Initial dimension of the OpenGL window (ratio if in [0,1], and absolute pixel size if > 1)
 float project::initial_window_size_width  = 0.95f; 
 float project::initial_window_size_height = 0.95f;
@@ -26,8 +34,15 @@ void environment_structure::send_opengl_uniform(opengl_shader_structure const& s
 {
 	opengl_uniform(shader, "projection", camera_projection, expected);
 	opengl_uniform(shader, "view", camera_view, expected);
+	opengl_uniform(shader, "camera_position", camera_position, false);
 	opengl_uniform(shader, "light", light, false);
 
 	uniform_generic.send_opengl_uniform(shader, expected);
 
+}
+
+void environment_structure::set_camera_view(mat4 const& view)
+{
+	camera_view = view;
+	camera_position = view.inverse_assuming_rigid_transform().get_block_translation();
 }
\ No newline at end of file
@@ -19,6 +19,9 @@ struct environment_structure : environment_generic_structure
 	// The position/orientation of a camera that can rotates freely around a specific position
 	mat4 camera_view;
 
+	// Position of the camera in world space, sent to the shaders (updated with camera_view by set_camera_view)
+	vec3 camera_position;
+
 	// A projection structure (perspective or orthogonal projection)
 	mat4 camera_projection;
 
@@ -33,6 +36,9 @@ struct environment_structure : environment_generic_structure
 	//  The function is expected to send the uniform variables to the shader (e.g. camera, light)
 	void send_opengl_uniform(opengl_shader_structure const& shader, bool expected = default_expected_uniform) const override;
 
+	// Set the view matrix and the camera position deduced from it (once per frame, rather than at each draw call)
+	void set_camera_view(mat4 const& view);
+
 
 };
 
@@ -55,6 +61,10 @@ struct project {
 	static float fps_max; // Maximal default FPS (used only of fps_max is true)
 	static bool vsync; // Automatic synchronization of GLFW with the vertical-monitor refresh
 
+	// Simulation (inputs, physics, network send) on its own thread at a fixed rate, independent of the rendering
+	static bool simulation_in_thread; // If false, one simulation step is run before each frame
+	static float simulation_rate;     // Simulation steps per second
+
 	// Initial window size: expressed as ratio of screen in [0,1], or absolute pixel value if > 1
 	static float initial_window_size_width;
 	static float initial_window_size_height;
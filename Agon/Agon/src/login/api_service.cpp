@@ -1,4 +1,5 @@
 #include "api_service.hpp"
+#include "profiler.hpp"
 #include <iostream>
 #include <thread>
 
@@ -51,10 +52,38 @@ void APIService::registerWebSocketHandler(WebSocketMessageType type,
     message_handlers_[type] = handler;
 }
 
+// Name of the profiler scope of each handler
+static const char* handler_profile_name(WebSocketMessageType type) {
+    switch (type) {
+    case WebSocketMessageType::ERROR: return "handler ERROR";
+    case WebSocketMessageType::UPDATE: return "handler UPDATE";
+    case WebSocketMessageType::SERVER: return "handler SERVER";
+    case WebSocketMessageType::CHAT: return "handler CHAT";
+    case WebSocketMessageType::SNAPSHOT: return "handler SNAPSHOT";
+    case WebSocketMessageType::STATE: return "handler STATE";
+    case WebSocketMessageType::TIME: return "handler TIME";
+    case WebSocketMessageType::UDP: return "handler UDP";
+    default: return "handler UNKNOWN";
+    }
+}
+
 void APIService::handleWebSocketMessage(const std::string& message) {
+    PROFILE_SCOPE("handleWebSocketMessage");
     try {
         json data = json::parse(message);
         WebSocketMessageType type = getMessageType(data);
+        if (type == WebSocketMessageType::SNAPSHOT) {
+            handleSnapshot(data);
+            return;
+        }
+        if (type == WebSocketMessageType::TIME) {
+            handleTime(data);
+            return;
+        }
+        if (type == WebSocketMessageType::UDP) {
+            handleUdp(data);
+            return;
+        }
 
         std::function<void(const nlohmann::json&)> handler_to_call = nullptr;
         {
@@ -72,6 +101,7 @@ void APIService::handleWebSocketMessage(const std::string& message) {
                 std::cout << "[Debug] Chat message from " << data["username"].get<std::string>() << ": " 
                           << data["content"].get<std::string>() << std::endl;
             }
+            ProfileScope handler_scope(handler_profile_name(type));
             handler_to_call(data);
         } else {
             // No handler was registered for this message type
@@ -103,6 +133,10 @@ WebSocketMessageType APIService::getMessageType(const json& data) {
             if (type == "UPDATE") return WebSocketMessageType::UPDATE;
             if (type == "SERVER") return WebSocketMessageType::SERVER;
             if (type == "CHAT") return WebSocketMessageType::CHAT;
+            if (type == "SNAPSHOT") return WebSocketMessageType::SNAPSHOT;
+            if (type == "STATE") return WebSocketMessageType::STATE;
+            if (type == "TIME") return WebSocketMessageType::TIME;
+            if (type == "UDP") return WebSocketMessageType::UDP;
         }
     } catch (const std::exception& e) {
         std::cerr << "Error determining message type: " << e.what() << std::endl;
@@ -111,6 +145,57 @@ WebSocketMessageType APIService::getMessageType(const json& data) {
     return WebSocketMessageType::UNKNOWN;
 }
 
+// {"type":"SNAPSHOT","time":...,"content":[{"username":...,"content":{...}}, ...]} is split into the UPDATE messages of each player
+//  The server time of the tick (if any) is kept in the "time" field of each UPDATE.
+void APIService::handleSnapshot(const json& data) {
+    ProfileScope handler_scope(handler_profile_name(WebSocketMessageType::SNAPSHOT));
+    if (!data.contains("content") || !data["content"].is_array()) {
+        std::cerr << "SNAPSHOT message without player list" << std::endl;
+        return;
+    }
+    bool const stamped = data.contains("time") && data["time"].is_number();
+    if (stamped)
+        network_clock_.handleSnapshot(data["time"].get<double>());
+
+    std::function<void(const nlohmann::json&)> update_handler = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(handlers_mutex_);
+        auto it = message_handlers_.find(WebSocketMessageType::UPDATE);
+        if (it != message_handlers_.end()) update_handler = it->second;
+    }
+    if (!update_handler) return;
+
+    for (const json& entry : data["content"]) {
+        if (!entry.is_object() || !entry.contains("username") || !entry.contains("content")) continue;
+        json update = { {"type", "UPDATE"}, {"username", entry["username"]}, {"content", entry["content"]} };
+        if (stamped) update["time"] = data["time"];
+        update_handler(update);
+    }
+}
+
+// {"type":"TIME","content":{"client":...,"server":...}}: answer to a request of the NetworkClock
+void APIService::handleTime(const json& data) {
+    ProfileScope handler_scope(handler_profile_name(WebSocketMessageType::TIME));
+    if (!data.contains("content") || !data["content"].is_object()) return;
+    const json& content = data["content"];
+    if (!content.contains("client") || !content["client"].is_number() || !content.contains("server") || !content["server"].is_number()) {
+        std::cerr << "TIME message without client and server times" << std::endl;
+        return;
+    }
+    network_clock_.handleResponse(content["client"].get<double>(), content["server"].get<double>());
+}
+
+// {"type":"UDP","content":{"port":...,"token":...}}: answer to WebSocketService::requestUdp, starts the handshake
+void APIService::handleUdp(const json& data) {
+    ProfileScope handler_scope(handler_profile_name(WebSocketMessageType::UDP));
+    if (!data.contains("content") || !data["content"].is_object()) return;
+    const json& content = data["content"];
+    if (!content.contains("port") || !content["port"].is_number_unsigned() || !content.contains("token") || !content["token"].is_number_unsigned()) {
+        std::cerr << "UDP message without port and token" << std::endl;
+        return;
+    }
+    WebSocketService::getInstance().openUdp(content["port"].get<unsigned short>(), content["token"].get<uint64_t>());
+}
 
 bool APIService::checkServerConnection() const{
     httplib::Client client(base_url);
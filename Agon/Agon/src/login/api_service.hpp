@@ -1,3 +1,4 @@
+#pragma once
 #include <httplib/httplib.h>
 #include <nlohmann/json.hpp>
 #include <string>
@@ -6,6 +7,7 @@
 #include <iostream>
 #include <mutex>
 #include "websocket_service.hpp"  // Add WebSocketService header
+#include "network_clock.hpp"
 
 const int MAX_RETRIES = 3;
 const int RETRY_DELAY_MS = 2000;
@@ -23,7 +25,11 @@ enum class WebSocketMessageType {
     ERROR = 1,
     UPDATE = 2,
     SERVER = 3,
-    CHAT = 4
+    CHAT = 4,
+    SNAPSHOT = 5,   // States of several players in one message, handled as one UPDATE per player
+    STATE = 6,      // Authoritative state of the local player after its last processed INPUT (client prediction)
+    TIME = 7,       // Answer to a clock synchronization request, handled by the NetworkClock
+    UDP = 8         // Port and token of the UDP channel of the states, handled by the WebSocketService
 };
 
 class APIService {
@@ -54,6 +60,12 @@ public:
     std::string getAuthToken() const { return auth_token; }
     bool isLoggedIn() const { return !auth_token.empty(); }
 
+    // Dispatch a received message to its handler (called by the reading thread of WebSocketService, or by a NetworkReplay)
+    void handleWebSocketMessage(const std::string& message);
+
+    // Server clock, network delays and interpolation delay (updated by the TIME and SNAPSHOT messages)
+    NetworkClock& networkClock() { return network_clock_; }
+
 private:
     APIService();
     // Make sure there's no trailing slash in base_url
@@ -64,10 +76,14 @@ private:
     std::mutex status_mutex; // For thread safety
     
     // WebSocket message handling
-    void handleWebSocketMessage(const std::string& message);
     WebSocketMessageType getMessageType(const nlohmann::json& json);
+    void handleSnapshot(const nlohmann::json& data);
+    void handleTime(const nlohmann::json& data);
+    void handleUdp(const nlohmann::json& data);
     
     // Message handlers for different types of messages
     std::map<WebSocketMessageType, std::function<void(const nlohmann::json&)>> message_handlers_;
     std::mutex handlers_mutex_; // For thread safety of the handlers map
+
+    NetworkClock network_clock_;
 };
\ No newline at end of file
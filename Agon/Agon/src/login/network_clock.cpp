@@ -0,0 +1,140 @@
+#include "network_clock.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <nlohmann/json.hpp>
+
+static size_t const max_samples = 8;                  // Synchronization samples kept to choose the offset
+static int const quick_requests = 5;                  // Requests sent every quick_request_interval after a reset
+static double const quick_request_interval = 100.0;
+static double const request_interval = 1000.0;
+static double const max_round_trip = 5000.0;          // Longer samples are ignored (e.g. replayed messages)
+static double const default_snapshot_interval = 1000.0 / 30.0;
+static double const min_interpolation_delay = 20.0;
+static double const max_interpolation_delay = 500.0;
+static double const jitter_margin = 3.0;              // Jitters of margin in the interpolation delay
+
+NetworkClock::NetworkClock()
+    : start_(std::chrono::steady_clock::now())
+{
+    reset();
+}
+
+double NetworkClock::localTime() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+}
+
+bool NetworkClock::requestDue() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!has_snapshot_) return false;
+    if (requests_sent_ == 0) return true;
+    double const interval = requests_sent_ < quick_requests ? quick_request_interval : request_interval;
+    return localTime() - last_request_ >= interval;
+}
+
+std::string NetworkClock::makeRequest() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    last_request_ = localTime();
+    requests_sent_++;
+    return nlohmann::json{ {"type", "TIME"}, {"content", {{"client", last_request_}}} }.dump();
+}
+
+void NetworkClock::handleResponse(double client_time, double server_time) {
+    double const now = localTime();
+    double const round_trip = now - client_time;
+    if (round_trip < 0.0 || round_trip > max_round_trip) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    samples_.push_back({ round_trip, server_time - 0.5 * (client_time + now) });
+    if (samples_.size() > max_samples)
+        samples_.pop_front();
+    auto const best = std::min_element(samples_.begin(), samples_.end(), [](Sample const& a, Sample const& b) { return a.round_trip < b.round_trip; });
+    offset_ = best->offset;
+
+    // Smoothed round-trip time and its mean deviation (same gains as TCP)
+    if (samples_.size() == 1) {
+        round_trip_ = round_trip;
+        round_trip_jitter_ = 0.5 * round_trip;
+    }
+    else {
+        round_trip_jitter_ += 0.25 * (std::abs(round_trip - round_trip_) - round_trip_jitter_);
+        round_trip_ += 0.125 * (round_trip - round_trip_);
+    }
+}
+
+void NetworkClock::handleSnapshot(double server_time) {
+    double const now = localTime();
+    std::lock_guard<std::mutex> lock(mutex_);
+    double const transit = now - server_time; // Includes the unknown offset, which cancels out in the differences
+    if (has_snapshot_ && server_time > last_snapshot_server_) {
+        snapshot_jitter_ += (std::abs(transit - last_transit_) - snapshot_jitter_) / 16.0;
+        // A pause without changed states is counted as the longest delay
+        double const interval = std::min(server_time - last_snapshot_server_, max_interpolation_delay);
+        snapshot_interval_ += 0.125 * (interval - snapshot_interval_);
+    }
+    has_snapshot_ = true;
+    last_snapshot_server_ = server_time;
+    last_transit_ = transit;
+
+    // The delay grows at once when the jitter increases, and decreases slowly (the displayed time slows down a little)
+    double const target = std::min(max_interpolation_delay, std::max(min_interpolation_delay, snapshot_interval_ + jitter_margin * snapshot_jitter_));
+    interpolation_delay_ += (target > interpolation_delay_ ? 0.5 : 0.02) * (target - interpolation_delay_);
+}
+
+void NetworkClock::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    samples_.clear();
+    requests_sent_ = 0;
+    offset_ = 0.0;
+    round_trip_ = 0.0;
+    round_trip_jitter_ = 0.0;
+    has_snapshot_ = false;
+    snapshot_jitter_ = 0.0;
+    snapshot_interval_ = default_snapshot_interval;
+    interpolation_delay_ = 2.0 * default_snapshot_interval;
+}
+
+bool NetworkClock::isSynchronized() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !samples_.empty();
+}
+
+double NetworkClock::serverTime() const {
+    return toServerTime(localTime());
+}
+
+double NetworkClock::toServerTime(double local_time) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return local_time + offset_;
+}
+
+double NetworkClock::roundTripTime() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return round_trip_;
+}
+
+double NetworkClock::roundTripJitter() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return round_trip_jitter_;
+}
+
+double NetworkClock::snapshotJitter() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return snapshot_jitter_;
+}
+
+double NetworkClock::snapshotInterval() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return snapshot_interval_;
+}
+
+double NetworkClock::interpolationDelay() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return interpolation_delay_;
+}
+
+double NetworkClock::renderTime() const {
+    double const now = localTime();
+    std::lock_guard<std::mutex> lock(mutex_);
+    return now + offset_ - interpolation_delay_;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+
+// Estimation of the server clock, of the network delays and of the interpolation delay of the remote states
+//  Synchronization: the client regularly sends {"type":"TIME","content":{"client":t0}} and the server answers at once with
+//  its own time {"type":"TIME","content":{"client":t0,"server":ts}}. Received at t1, the sample gives the round-trip time
+//  t1 - t0 and the clock offset ts - (t0 + t1) / 2; the offset of the sample with the smallest round-trip time of the
+//  recent ones is kept (the least delayed by the queues, so the most symmetric).
+//  Jitter: the SNAPSHOT messages carry the server time of their tick, and the variation of their transit time is averaged
+//  as in RTP (RFC 3550). The interpolation delay covers one snapshot interval plus a margin proportional to this jitter,
+//  so that the remote states to interpolate between have arrived when they are displayed.
+//  All the times are in milliseconds. Thread safe: updated by the reading thread, queried by the simulation and render threads.
+class NetworkClock {
+public:
+    NetworkClock();
+
+    // Local monotonic time (since the creation of the clock)
+    double localTime() const;
+
+    // Synchronization requests: a few quick samples after a reset, then one per second
+    //  They start after the first stamped snapshot, so that a server without clock does not receive unknown messages.
+    bool requestDue() const;
+    std::string makeRequest();
+    void handleResponse(double client_time, double server_time);
+    // Arrival of a message stamped with the server time
+    void handleSnapshot(double server_time);
+    // Forget the measures (new connection)
+    void reset();
+
+    // Queries for the rendering and the hit validation
+    bool isSynchronized() const;                        // At least one synchronization sample (otherwise the offset is 0)
+    double serverTime() const;                          // Current server time
+    double toServerTime(double local_time) const;
+    double roundTripTime() const;                       // Smoothed round-trip time
+    double roundTripJitter() const;                     // Mean deviation of the round-trip time
+    double snapshotJitter() const;                      // Mean variation of the transit time of the snapshots
+    double snapshotInterval() const;                    // Mean server time between two received snapshots
+    double interpolationDelay() const;                  // Delay of the displayed remote states behind the server time
+    double renderTime() const;                          // Server time at which the remote states are displayed now
+
+private:
+    struct Sample {
+        double round_trip;
+        double offset;
+    };
+
+    std::chrono::steady_clock::time_point start_;
+    mutable std::mutex mutex_;
+
+    std::deque<Sample> samples_;                        // Most recent synchronization samples
+    int requests_sent_ = 0;
+    double last_request_ = 0.0;
+    double offset_ = 0.0;                               // Server time - local time
+    double round_trip_ = 0.0;
+    double round_trip_jitter_ = 0.0;
+
+    bool has_snapshot_ = false;
+    double last_snapshot_server_ = 0.0;
+    double last_transit_ = 0.0;
+    double snapshot_jitter_ = 0.0;
+    double snapshot_interval_ = 0.0;
+    double interpolation_delay_ = 0.0;
+};
@@ -0,0 +1,149 @@
+#include "network_conditioner.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+static const float min_retransmission_timeout = 200.0f;    // ms, minimum RTO of Linux TCP
+static const float reorder_hold = 20.0f;                   // ms, minimum additional delay of a reordered message
+static const float max_queueing = 1000.0f;                 // ms, buffer of the link: the unreliable messages waiting longer are dropped
+
+static float probability(const char* text) {
+    return std::min(1.0f, std::max(0.0f, float(std::atof(text))));
+}
+
+bool NetworkConditions::active() const {
+    return latency > 0.0f || jitter > 0.0f || bandwidth > 0.0f || reorder > 0.0f || loss > 0.0f;
+}
+
+NetworkConditions NetworkConditions::from_command_line(int argc, char* argv[]) {
+    NetworkConditions conditions;
+    for (int k = 1; k < argc; ++k) {
+        std::string const arg = argv[k];
+        bool const has_value = k + 1 < argc;
+        if (arg == "--net-latency" && has_value) conditions.latency = std::max(0.0f, float(std::atof(argv[++k])));
+        else if (arg == "--net-jitter" && has_value) conditions.jitter = std::max(0.0f, float(std::atof(argv[++k])));
+        else if (arg == "--net-bandwidth" && has_value) conditions.bandwidth = std::max(0.0f, float(std::atof(argv[++k])));
+        else if (arg == "--net-reorder" && has_value) conditions.reorder = probability(argv[++k]);
+        else if (arg == "--net-loss" && has_value) conditions.loss = probability(argv[++k]);
+    }
+    return conditions;
+}
+
+NetworkConditioner::NetworkConditioner(const std::string& name)
+    : name_(name), random_(std::random_device{}())
+{}
+
+NetworkConditioner::~NetworkConditioner() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void NetworkConditioner::setConditions(const NetworkConditions& conditions) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    conditions_ = conditions;
+}
+
+NetworkConditions NetworkConditioner::conditions() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return conditions_;
+}
+
+void NetworkConditioner::submit(std::size_t bytes, bool reliable, std::function<void()> action) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Once the conditions are removed, the messages go through the queue until it is empty: they stay in order
+        if (conditions_.active() || !queue_.empty()) {
+            std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+            bool const lost = conditions_.loss > 0.0f && uniform(random_) < conditions_.loss;
+            if (lost && !reliable) {
+                statistics_.dropped++;
+                return;
+            }
+
+            // The link sends one message at a time
+            Clock::time_point const now = Clock::now();
+            Clock::time_point departure = now;
+            if (conditions_.bandwidth > 0.0f) {
+                float const transmission = float(bytes) * 8.0f / conditions_.bandwidth; // kbit/s = bit/ms
+                departure = std::max(now, link_free_) + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::milli>(transmission));
+                // The reliable messages wait (TCP slows the sender down), the datagrams overflow the buffer
+                if (!reliable && std::chrono::duration<float, std::milli>(departure - now).count() > max_queueing) {
+                    statistics_.dropped++;
+                    return;
+                }
+                link_free_ = departure;
+            }
+
+            float delay = conditions_.latency;
+            if (conditions_.jitter > 0.0f)
+                delay = std::max(0.0f, delay + std::uniform_real_distribution<float>(-conditions_.jitter, conditions_.jitter)(random_));
+            if (lost) {
+                // Resent by TCP after a timeout of about one round trip and four deviations
+                delay += std::max(min_retransmission_timeout, 2.0f * conditions_.latency + 4.0f * conditions_.jitter);
+                statistics_.retransmitted++;
+            }
+            else if (!reliable && conditions_.reorder > 0.0f && uniform(random_) < conditions_.reorder) {
+                delay += std::max(reorder_hold, conditions_.latency);
+                statistics_.reordered++;
+            }
+
+            Clock::time_point arrival = departure + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::milli>(delay));
+            if (reliable) {
+                arrival = std::max(arrival, last_reliable_);
+                last_reliable_ = arrival;
+            }
+            queue_.emplace(std::make_pair(arrival, submitted_++), std::move(action));
+
+            statistics_.delayed++;
+            statistics_.delay += 0.05f * (std::chrono::duration<float, std::milli>(arrival - now).count() - statistics_.delay);
+            if (!thread_.joinable())
+                thread_ = std::thread([this]() { run(); });
+            wake_.notify_one();
+            return;
+        }
+    }
+    action();
+}
+
+void NetworkConditioner::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.clear();
+}
+
+NetworkConditioner::Statistics NetworkConditioner::statistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Statistics statistics = statistics_;
+    statistics.pending = queue_.size();
+    return statistics;
+}
+
+void NetworkConditioner::run() {
+    Profiler::instance().set_thread_name(name_);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (queue_.empty()) {
+            wake_.wait(lock);
+            continue;
+        }
+        auto const first = queue_.begin();
+        Clock::time_point const arrival = first->first.first;
+        if (Clock::now() < arrival) {
+            wake_.wait_until(lock, arrival);
+            continue;
+        }
+        std::function<void()> action = std::move(first->second);
+        queue_.erase(first);
+
+        // The action may submit another message (e.g. a handler sending an answer)
+        lock.unlock();
+        action();
+        lock.lock();
+    }
+}
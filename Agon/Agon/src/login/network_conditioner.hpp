@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+
+// Simulated conditions of one direction of the network (all zero: real network)
+struct NetworkConditions {
+    float latency = 0.0f;       // One-way delay (ms)
+    float jitter = 0.0f;        // Variation of the delay, uniform in [-jitter, +jitter] (ms)
+    float bandwidth = 0.0f;     // Capacity of the link (kbit/s, 0: unlimited): a message waits for the previous ones to be sent
+    float reorder = 0.0f;       // Probability that an unreliable message is held back, the following ones overtaking it
+    float loss = 0.0f;          // Probability that a message is lost: dropped if unreliable, retransmitted if reliable
+
+    bool active() const;
+
+    // --net-latency ms --net-jitter ms --net-bandwidth kbit/s --net-reorder p --net-loss p (unknown arguments are ignored)
+    static NetworkConditions from_command_line(int argc, char* argv[]);
+};
+
+// Network condition simulator of one direction, between a transport and the game (test of bad networks on the loopback)
+//  Each message comes with the action sending or delivering it, run on the thread of the conditioner once the message has
+//  crossed the simulated link: after its transmission at the bandwidth of the link, then after the latency and its jitter.
+//  - Reliable messages (WebSocket) keep their order, and a lost one arrives after a TCP retransmission timeout, delaying
+//    the following ones (head-of-line blocking).
+//  - Unreliable messages (UDP datagrams) are dropped when lost or when the link is saturated for more than a second, and
+//    can arrive out of order.
+//  Without conditions, the action runs at once on the calling thread.
+class NetworkConditioner {
+public:
+    explicit NetworkConditioner(const std::string& name);
+    ~NetworkConditioner();
+
+    void setConditions(const NetworkConditions& conditions);
+    NetworkConditions conditions() const;
+
+    void submit(std::size_t bytes, bool reliable, std::function<void()> action);
+
+    // Forget the messages not delivered yet (disconnection)
+    void clear();
+
+    struct Statistics {
+        uint64_t delayed = 0;           // Messages through the simulated link
+        uint64_t dropped = 0;           // Lost unreliable messages
+        uint64_t retransmitted = 0;     // Lost reliable messages
+        uint64_t reordered = 0;
+        std::size_t pending = 0;        // Messages in the link
+        float delay = 0.0f;             // Moving average of the delay of the messages (ms)
+    };
+    Statistics statistics() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void run();
+
+    std::string name_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::map<std::pair<Clock::time_point, uint64_t>, std::function<void()>> queue_;    // By arrival time, then submission
+    NetworkConditions conditions_;
+    Clock::time_point link_free_;       // End of the transmission of the previous message (bandwidth)
+    Clock::time_point last_reliable_;   // Arrival of the previous reliable message (order of the stream)
+    uint64_t submitted_ = 0;
+    std::mt19937 random_;
+    Statistics statistics_;
+    bool stopping_ = false;
+    std::thread thread_;                // Started with the first delayed message
+};
@@ -0,0 +1,213 @@
+#include "network_recording.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <nlohmann/json.hpp>
+
+static const char recording_magic[8] = { 'A', 'G', 'O', 'N', 'R', 'E', 'C', '1' };
+
+static void write_varint(std::ofstream& file, uint64_t value) {
+    while (value >= 0x80) {
+        file.put(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    file.put(static_cast<char>(value));
+}
+
+static bool read_varint(std::ifstream& file, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int const byte = file.get();
+        if (byte == std::char_traits<char>::eof()) return false;
+        value |= uint64_t(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+bool NetworkRecorder::open(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_.open(filename, std::ios::binary | std::ios::trunc);
+    if (!file_) {
+        std::cerr << "Cannot create the network recording " << filename << std::endl;
+        return false;
+    }
+    file_.write(recording_magic, sizeof(recording_magic));
+    last_time_ = std::chrono::steady_clock::now();
+    open_ = true;
+    std::cout << "Recording the network messages to " << filename << std::endl;
+    return true;
+}
+
+void NetworkRecorder::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_) return;
+    open_ = false;
+    file_.close();
+}
+
+void NetworkRecorder::record(NetworkRecordKind kind, const std::string& message) {
+    if (!open_) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_) return;
+
+    auto const now = std::chrono::steady_clock::now();
+    uint64_t const delta_us = std::chrono::duration_cast<std::chrono::microseconds>(now - last_time_).count();
+    last_time_ += std::chrono::microseconds(delta_us); // The rounding errors do not accumulate
+
+    file_.put(static_cast<char>(kind));
+    write_varint(file_, delta_us);
+    write_varint(file_, message.size());
+    file_.write(message.data(), message.size());
+}
+
+bool load_network_recording(const std::string& filename, std::vector<NetworkRecord>& records) {
+    std::ifstream file(filename, std::ios::binary);
+    char magic[sizeof(recording_magic)];
+    if (!file || !file.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), recording_magic)) {
+        std::cerr << "Cannot read the network recording " << filename << std::endl;
+        return false;
+    }
+
+    // Size of the file, to reject a message size larger than the rest of the file (truncated or corrupted recording)
+    std::streamoff const data_begin = file.tellg();
+    file.seekg(0, std::ios::end);
+    uint64_t const file_size = uint64_t(file.tellg());
+    file.seekg(data_begin);
+
+    records.clear();
+    int64_t time_us = 0;
+    while (true) {
+        int const kind = file.get();
+        uint64_t delta_us = 0, size = 0;
+        if (kind == std::char_traits<char>::eof() || !read_varint(file, delta_us) || !read_varint(file, size)) break;
+        if (size > file_size - uint64_t(file.tellg())) {
+            std::cerr << "The network recording " << filename << " is truncated after " << records.size() << " records" << std::endl;
+            break;
+        }
+        std::string message(size, '\0');
+        if (!file.read(&message[0], size)) break;
+        time_us += int64_t(delta_us);
+        records.push_back({ static_cast<NetworkRecordKind>(kind), time_us, std::move(message) });
+    }
+    return true;
+}
+
+NetworkReplaySettings NetworkReplaySettings::from_command_line(int argc, char* argv[]) {
+    NetworkReplaySettings settings;
+    for (int k = 1; k < argc; ++k) {
+        std::string const arg = argv[k];
+        bool const has_value = k + 1 < argc;
+        if (arg == "--record" && has_value) settings.record = argv[++k];
+        else if (arg == "--replay" && has_value) settings.replay = argv[++k];
+        else if (arg == "--replay-speed" && has_value) settings.speed = std::max(0.0f, float(std::atof(argv[++k])));
+        else if (arg == "--replay-output" && has_value) settings.output = argv[++k];
+        else if (arg == "--replay-exit") settings.exit_when_done = true;
+    }
+    return settings;
+}
+
+NetworkReplay::NetworkReplay(const NetworkReplaySettings& settings)
+    : settings_(settings)
+{}
+
+NetworkReplay::~NetworkReplay() {
+    stop();
+}
+
+bool NetworkReplay::load() {
+    if (!load_network_recording(settings_.replay, records_)) return false;
+
+    for (const NetworkRecord& record : records_) {
+        if (record.kind != NetworkRecordKind::INFO) continue;
+        nlohmann::json const info = nlohmann::json::parse(record.message, nullptr, false);
+        if (info.is_object() && info.contains("username") && info["username"].is_string())
+            username_ = info["username"].get<std::string>();
+    }
+    std::cout << "Network replay " << settings_.replay << ": " << records_.size() << " records, player " << username_ << std::endl;
+    return true;
+}
+
+void NetworkReplay::start(std::function<void(const std::string&)> handler) {
+    handler_ = handler;
+    running_ = true;
+    thread_ = std::thread([this]() { run(); });
+}
+
+void NetworkReplay::stop() {
+    running_ = false;
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void NetworkReplay::run() {
+    Profiler::instance().set_thread_name("Replay");
+
+    types_.clear();
+    handler_time_ms_.clear();
+    auto const start = std::chrono::steady_clock::now();
+    for (const NetworkRecord& record : records_) {
+        if (!running_) break;
+        if (record.kind != NetworkRecordKind::INBOUND) continue;
+
+        if (settings_.speed > 0.0f) {
+            auto const due = start + std::chrono::microseconds(int64_t(record.time_us / settings_.speed));
+            std::this_thread::sleep_until(due);
+        }
+
+        // The type is read before the measure (the handler parses the message itself)
+        nlohmann::json const data = nlohmann::json::parse(record.message, nullptr, false);
+        types_.push_back(data.is_object() && data.contains("type") && data["type"].is_string() ? data["type"].get<std::string>() : "UNKNOWN");
+
+        auto const handler_start = std::chrono::steady_clock::now();
+        handler_(record.message);
+        handler_time_ms_.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - handler_start).count());
+    }
+    duration_s_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    report();
+    finished_ = true;
+}
+
+// Count, mean and percentiles (nearest rank) of the values
+static nlohmann::json timing_statistics(std::vector<double> values) {
+    nlohmann::json result;
+    result["count"] = values.size();
+    if (values.empty()) return result;
+    std::sort(values.begin(), values.end());
+    auto const at = [&values](double p) { return values[std::min(values.size() - 1, size_t(p / 100.0 * values.size()))]; };
+    double total = 0.0;
+    for (double value : values) total += value;
+    result["mean"] = total / values.size();
+    result["p50"] = at(50.0);
+    result["p90"] = at(90.0);
+    result["p99"] = at(99.0);
+    result["max"] = values.back();
+    return result;
+}
+
+void NetworkReplay::report() const {
+    std::map<std::string, std::vector<double>> times_by_type;
+    for (size_t k = 0; k < handler_time_ms_.size(); ++k)
+        times_by_type[types_[k]].push_back(handler_time_ms_[k]);
+
+    nlohmann::json result;
+    result["recording"] = settings_.replay;
+    result["speed"] = settings_.speed;
+    result["duration_s"] = duration_s_;
+    result["messages"] = handler_time_ms_.size();
+    result["messages_per_s"] = duration_s_ > 0.0 ? handler_time_ms_.size() / duration_s_ : 0.0;
+    result["handler_ms"] = timing_statistics(handler_time_ms_);
+    for (auto const& type : times_by_type)
+        result["handler_ms_by_type"][type.first] = timing_statistics(type.second);
+
+    std::cout << "Network replay finished: " << result.dump(2) << std::endl;
+    if (!settings_.output.empty()) {
+        std::ofstream file(settings_.output);
+        file << result.dump(2) << std::endl;
+        if (!file) std::cerr << "Cannot write the replay results to " << settings_.output << std::endl;
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Recording of the WebSocket traffic of a session, to replay it without server
+//  Binary log: the header "AGONREC1", then one record per message:
+//  [kind: 1 byte] [time since the previous record in microseconds: varint] [size: varint] [message: size bytes]
+enum class NetworkRecordKind : uint8_t {
+    INBOUND = 0,    // Received from the server
+    OUTBOUND = 1,   // Sent to the server
+    INFO = 2        // Information about the session (JSON: username, roomId), written by the game
+};
+
+// Writer of the log (thread safe: called by the reading thread and the sending threads)
+class NetworkRecorder {
+public:
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const { return open_; }
+
+    void record(NetworkRecordKind kind, const std::string& message);
+
+private:
+    std::atomic<bool> open_{false};
+    std::mutex mutex_;
+    std::ofstream file_;
+    std::chrono::steady_clock::time_point last_time_;
+};
+
+struct NetworkRecord {
+    NetworkRecordKind kind;
+    int64_t time_us;        // Since the start of the recording
+    std::string message;
+};
+
+// Read a whole log (returns false if the file is missing or is not a recording; a truncated last record is ignored)
+bool load_network_recording(const std::string& filename, std::vector<NetworkRecord>& records);
+
+// Options of the recording and of the replay
+//  Command line: Agon [--record file.agonrec] | [--replay file.agonrec [--replay-speed S] [--replay-output file.json] [--replay-exit]]
+struct NetworkReplaySettings {
+    std::string record;             // Record the session to this file
+    std::string replay;             // Replay this file instead of connecting to a server
+    float speed = 1.0f;             // 1: original timing, 2: twice faster..., 0: as fast as possible
+    std::string output;             // JSON file of the handler timings (empty: standard output only)
+    bool exit_when_done = false;    // Close the game at the end of the replay
+
+    static NetworkReplaySettings from_command_line(int argc, char* argv[]);
+};
+
+// Replay of the received messages of a recording through the message handler of the game
+//  The messages are delivered on a separate thread, like the reading thread of WebSocketService, at their original times
+//  (or as fast as possible), and each handler call is timed: the same traffic gives repeatable measures of the message
+//  handling and remote player paths. The sent messages are skipped.
+class NetworkReplay {
+public:
+    explicit NetworkReplay(const NetworkReplaySettings& settings);
+    ~NetworkReplay();
+
+    bool load();
+    // Username of the recorded player (from the INFO record), to skip its own updates as in the game
+    const std::string& username() const { return username_; }
+
+    void start(std::function<void(const std::string&)> handler);
+    void stop();
+    bool finished() const { return finished_; }
+
+private:
+    void run();
+    void report() const;
+
+    NetworkReplaySettings settings_;
+    std::vector<NetworkRecord> records_;
+    std::string username_;
+
+    std::function<void(const std::string&)> handler_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> finished_{false};
+
+    // Measures (written by the replay thread, read after it ended)
+    std::vector<std::string> types_;            // Type of each replayed message
+    std::vector<double> handler_time_ms_;
+    double duration_s_ = 0.0;
+};
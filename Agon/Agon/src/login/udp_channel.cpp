@@ -0,0 +1,180 @@
+#include "udp_channel.hpp"
+#include "profiler.hpp"
+
+#include <iostream>
+#include <boost/asio/post.hpp>
+
+namespace net = boost::asio;
+using udp = net::ip::udp;
+
+static int const max_hello_attempts = 10;
+static auto const timer_period = std::chrono::milliseconds(100);    // HELLO repetition, and acknowledgments when nothing is sent
+
+UdpChannel::UdpChannel()
+    : random_(std::random_device{}())
+{}
+
+UdpChannel::~UdpChannel() {
+    close();
+}
+
+bool UdpChannel::open(const std::string& host, unsigned short port, uint64_t token, std::function<void(const std::string&)> handler) {
+    close();
+    try {
+        ioc_.restart();
+        udp::resolver resolver(ioc_);
+        udp::endpoint const server = *resolver.resolve(udp::v4(), host, std::to_string(port)).begin();
+        socket_ = std::make_unique<udp::socket>(ioc_);
+        socket_->open(udp::v4());
+        socket_->connect(server); // Only the datagrams of the server are received
+        timer_ = std::make_unique<net::steady_timer>(ioc_);
+    } catch (const std::exception& e) {
+        std::cerr << "Cannot open the UDP channel to " << host << ":" << port << ": " << e.what() << std::endl;
+        failed_ = true;
+        return false;
+    }
+
+    session_++;
+    token_ = token;
+    handler_ = handler;
+    hello_sent_ = 0;
+    sequencer_ = UdpSequencer();
+    established_ = false;
+    failed_ = false;
+    {
+        std::lock_guard<std::mutex> lock(statistics_mutex_);
+        statistics_ = Statistics();
+    }
+
+    receive();
+    onTimer({}); // First HELLO
+    thread_ = std::thread([this]() {
+        Profiler::instance().set_thread_name("UDP");
+        ioc_.run();
+    });
+    std::cout << "UDP channel: handshake with " << host << ":" << port << std::endl;
+    return true;
+}
+
+void UdpChannel::close() {
+    if (!thread_.joinable()) return;
+    ioc_.stop();
+    thread_.join();
+    socket_.reset();
+    timer_.reset();
+    established_ = false;
+}
+
+void UdpChannel::send(const std::string& message) {
+    if (!established_) return;
+    net::post(ioc_, [this, message]() { sendData(message); });
+}
+
+UdpChannel::Statistics UdpChannel::statistics() const {
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    return statistics_;
+}
+
+void UdpChannel::receive() {
+    socket_->async_receive(net::buffer(buffer_), [this](const boost::system::error_code& ec, std::size_t size) { onReceive(ec, size); });
+}
+
+void UdpChannel::onReceive(const boost::system::error_code& ec, std::size_t size) {
+    if (ec == net::error::operation_aborted) return;
+    // Errors of a connected UDP socket (e.g. ICMP port unreachable before the server listens) do not close the channel
+    if (!ec && !simulateLoss()) {
+        if (inbound_ == nullptr) {
+            handleDatagram(buffer_.data(), size);
+        }
+        else {
+            // Back to the io thread once the datagram has crossed the simulated link
+            auto const datagram = std::make_shared<std::string const>(buffer_.data(), size);
+            uint64_t const session = session_;
+            inbound_->submit(size, false, [this, datagram, session]() {
+                net::post(ioc_, [this, datagram, session]() {
+                    if (session == session_) handleDatagram(datagram->data(), datagram->size());
+                });
+            });
+        }
+    }
+    receive();
+}
+
+void UdpChannel::handleDatagram(const char* data, std::size_t size) {
+    UdpPacket packet;
+    if (!decode_udp_packet(data, size, packet)) return;
+    if (packet.kind == UdpPacketKind::HELLO_ACK && packet.token == token_ && !established_) {
+        established_ = true;
+        std::cout << "UDP channel established: the states are sent by UDP" << std::endl;
+    }
+    else if (packet.kind == UdpPacketKind::DATA) {
+        established_ = true; // The HELLO_ACK may have been lost
+        std::vector<uint16_t> acknowledged, lost;
+        bool const recent = sequencer_.receive(packet.header, acknowledged, lost);
+        {
+            std::lock_guard<std::mutex> lock(statistics_mutex_);
+            statistics_.received++;
+            statistics_.acknowledged += acknowledged.size();
+            statistics_.lost += lost.size();
+            if (!recent) statistics_.late++;
+        }
+        if (recent && !packet.message.empty() && handler_)
+            handler_(packet.message);
+    }
+}
+
+void UdpChannel::scheduleTimer() {
+    timer_->expires_after(timer_period);
+    timer_->async_wait([this](const boost::system::error_code& ec) { onTimer(ec); });
+}
+
+void UdpChannel::onTimer(const boost::system::error_code& ec) {
+    if (ec) return;
+    if (!established_) {
+        if (hello_sent_ >= max_hello_attempts) {
+            failed_ = true;
+            std::cerr << "UDP channel: no answer from the server, the states stay on the WebSocket" << std::endl;
+            return;
+        }
+        hello_sent_++;
+        sendDatagram(std::make_shared<std::string const>(encode_udp_hello(UdpPacketKind::HELLO, token_)));
+    }
+    else if (std::chrono::steady_clock::now() - last_sent_ >= timer_period) {
+        sendData(""); // Acknowledgments of the received states
+    }
+    scheduleTimer();
+}
+
+void UdpChannel::sendData(const std::string& message) {
+    sendDatagram(std::make_shared<std::string const>(encode_udp_data_header(sequencer_.next_header()) + message));
+    last_sent_ = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    statistics_.sent++;
+}
+
+void UdpChannel::sendDatagram(std::shared_ptr<std::string const> datagram) {
+    if (simulateLoss()) return;
+    if (outbound_ == nullptr) {
+        transmit(datagram);
+        return;
+    }
+    // The socket is only used by the io thread
+    uint64_t const session = session_;
+    outbound_->submit(datagram->size(), false, [this, datagram, session]() {
+        net::post(ioc_, [this, datagram, session]() {
+            if (session == session_) transmit(datagram);
+        });
+    });
+}
+
+void UdpChannel::transmit(std::shared_ptr<std::string const> datagram) {
+    socket_->async_send(net::buffer(*datagram), [datagram](const boost::system::error_code&, std::size_t) {});
+}
+
+bool UdpChannel::simulateLoss() {
+    float const loss = loss_;
+    if (loss <= 0.0f || std::uniform_real_distribution<float>(0.0f, 1.0f)(random_) >= loss) return false;
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    statistics_.simulated_drops++;
+    return true;
+}
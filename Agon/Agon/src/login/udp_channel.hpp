@@ -0,0 +1,91 @@
+#pragma once
+
+#include "udp_packet.hpp"
+#include "network_conditioner.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/udp.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+// Unreliable UDP channel of the frequent states, next to the WebSocket
+//  On TCP, a lost segment delays all the following messages until it is retransmitted (head-of-line blocking): the positions
+//  arrive late and in bursts. The states sent on this channel are never resent nor waited for: a late datagram is dropped,
+//  and the next state replaces a lost one. The WebSocket keeps the login, the chat and the reliable events (HIT...).
+//  The handshake repeats HELLO with the token given by the server on the WebSocket; without HELLO_ACK after
+//  max_hello_attempts, the channel fails and the WebSocket is used for everything.
+//  The datagrams are handled on a thread of the channel; send() can be called from any thread.
+class UdpChannel {
+public:
+    UdpChannel();
+    ~UdpChannel();
+
+    // Start the handshake with the UDP endpoint of the server. The handler receives the messages of the DATA datagrams.
+    bool open(const std::string& host, unsigned short port, uint64_t token, std::function<void(const std::string&)> handler);
+    void close();
+
+    bool isEstablished() const { return established_; }
+    bool hasFailed() const { return failed_; }
+
+    // Send a message in one datagram (dropped if the channel is not established)
+    void send(const std::string& message);
+
+    // Simulated loss of the sent and received datagrams (probability in [0,1]), to test over the loopback
+    void setLoss(float probability) { loss_ = probability; }
+
+    // Simulated network conditions of all the datagrams (nullptr: none), the conditioners outliving the channel
+    void setConditioners(NetworkConditioner* outbound, NetworkConditioner* inbound) { outbound_ = outbound; inbound_ = inbound; }
+
+    struct Statistics {
+        uint64_t sent = 0;              // DATA datagrams
+        uint64_t received = 0;
+        uint64_t acknowledged = 0;      // Sent datagrams acknowledged by the server
+        uint64_t lost = 0;              // Sent datagrams lost according to the acknowledgments
+        uint64_t late = 0;              // Received datagrams dropped because a more recent one had arrived
+        uint64_t simulated_drops = 0;   // Datagrams dropped by setLoss
+    };
+    Statistics statistics() const;
+
+private:
+    void receive();
+    void onReceive(const boost::system::error_code& ec, std::size_t size);
+    void handleDatagram(const char* data, std::size_t size);
+    void scheduleTimer();
+    void onTimer(const boost::system::error_code& ec);
+    void sendData(const std::string& message);
+    void sendDatagram(std::shared_ptr<std::string const> datagram);
+    void transmit(std::shared_ptr<std::string const> datagram);
+    bool simulateLoss();
+
+    boost::asio::io_context ioc_;
+    std::unique_ptr<boost::asio::ip::udp::socket> socket_;
+    std::unique_ptr<boost::asio::steady_timer> timer_;
+    std::thread thread_;
+    std::array<char, 65536> buffer_;
+
+    // State of the io thread
+    uint64_t session_ = 0;      // Number of open() calls: the datagrams delayed by a conditioner are dropped after a reopening
+    uint64_t token_ = 0;
+    int hello_sent_ = 0;
+    UdpSequencer sequencer_;
+    std::chrono::steady_clock::time_point last_sent_;
+    std::mt19937 random_;
+    std::function<void(const std::string&)> handler_;
+
+    std::atomic<bool> established_{false};
+    std::atomic<bool> failed_{false};
+    std::atomic<float> loss_{0.0f};
+    NetworkConditioner* outbound_ = nullptr;
+    NetworkConditioner* inbound_ = nullptr;
+
+    mutable std::mutex statistics_mutex_;
+    Statistics statistics_;
+};
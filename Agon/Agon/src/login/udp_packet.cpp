@@ -0,0 +1,115 @@
+#include "udp_packet.hpp"
+
+static size_t const max_in_flight = 256;      // Older sent datagrams are forgotten (counted as lost)
+static uint16_t const loss_threshold = 3;     // More recent datagrams acknowledged before a missing one is lost
+
+static void write_integer(std::string& data, uint64_t value, int bytes) {
+    for (int k = 0; k < bytes; ++k)
+        data.push_back(static_cast<char>((value >> (8 * k)) & 0xFF));
+}
+
+static uint64_t read_integer(char const* data, int bytes) {
+    uint64_t value = 0;
+    for (int k = 0; k < bytes; ++k)
+        value |= uint64_t(static_cast<unsigned char>(data[k])) << (8 * k);
+    return value;
+}
+
+std::string encode_udp_hello(UdpPacketKind kind, uint64_t token) {
+    std::string data;
+    data.push_back(static_cast<char>(kind));
+    write_integer(data, token, 8);
+    return data;
+}
+
+std::string encode_udp_data_header(UdpDataHeader const& header) {
+    std::string data;
+    data.reserve(udp_data_header_size);
+    data.push_back(static_cast<char>(UdpPacketKind::DATA));
+    write_integer(data, header.sequence, 2);
+    write_integer(data, header.ack, 2);
+    write_integer(data, header.ack_bits, 4);
+    return data;
+}
+
+bool decode_udp_packet(char const* data, size_t size, UdpPacket& packet) {
+    if (size < 1) return false;
+    packet.kind = static_cast<UdpPacketKind>(data[0]);
+    switch (packet.kind) {
+    case UdpPacketKind::HELLO:
+    case UdpPacketKind::HELLO_ACK:
+        if (size != 9) return false;
+        packet.token = read_integer(data + 1, 8);
+        return true;
+    case UdpPacketKind::DATA:
+        if (size < udp_data_header_size) return false;
+        packet.header.sequence = uint16_t(read_integer(data + 1, 2));
+        packet.header.ack = uint16_t(read_integer(data + 3, 2));
+        packet.header.ack_bits = uint32_t(read_integer(data + 5, 4));
+        packet.message.assign(data + udp_data_header_size, size - udp_data_header_size);
+        return packet.header.sequence != 0;
+    default:
+        return false;
+    }
+}
+
+bool udp_sequence_newer(uint16_t a, uint16_t b) {
+    return a != b && uint16_t(a - b) < 0x8000;
+}
+
+UdpDataHeader UdpSequencer::next_header() {
+    UdpDataHeader header;
+    header.sequence = next_sequence;
+    header.ack = has_received ? remote_sequence : 0;
+    header.ack_bits = has_received ? received_bits : 0;
+
+    next_sequence++;
+    if (next_sequence == 0) next_sequence = 1;
+    in_flight.push_back(header.sequence);
+    return header;
+}
+
+bool UdpSequencer::receive(UdpDataHeader const& header, std::vector<uint16_t>& acknowledged, std::vector<uint16_t>& lost) {
+    // Sent datagrams acknowledged or lost according to the other side
+    if (header.ack != 0) {
+        for (auto it = in_flight.begin(); it != in_flight.end();) {
+            uint16_t const sequence = *it;
+            uint16_t const distance = uint16_t(header.ack - sequence);
+            bool const received = distance == 0 || (distance <= 32 && (header.ack_bits >> (distance - 1)) & 1u);
+            if (received) {
+                acknowledged.push_back(sequence);
+                it = in_flight.erase(it);
+            }
+            else if (udp_sequence_newer(header.ack, sequence) && distance >= loss_threshold) {
+                lost.push_back(sequence);
+                it = in_flight.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+    while (in_flight.size() > max_in_flight) {
+        lost.push_back(in_flight.front());
+        in_flight.pop_front();
+    }
+
+    // Received sequences of the other side
+    if (!has_received) {
+        has_received = true;
+        remote_sequence = header.sequence;
+        received_bits = 0;
+        return true;
+    }
+    if (header.sequence == remote_sequence) return false; // Duplicate
+    if (udp_sequence_newer(header.sequence, remote_sequence)) {
+        uint16_t const shift = uint16_t(header.sequence - remote_sequence);
+        received_bits = shift > 32 ? 0u : ((shift == 32 ? 0u : received_bits << shift) | (1u << (shift - 1)));
+        remote_sequence = header.sequence;
+        return true;
+    }
+    uint16_t const distance = uint16_t(remote_sequence - header.sequence);
+    if (distance <= 32)
+        received_bits |= 1u << (distance - 1);
+    return false;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Datagrams of the UDP channel of the frequent states (shared by the client and the local server)
+//  Every datagram starts with its kind (1 byte), the integers are little endian:
+//  - HELLO (client -> server) and HELLO_ACK (server -> client): [kind] [token: 8 bytes]
+//    Handshake: the token is given to the client on the WebSocket, the client repeats HELLO until the HELLO_ACK arrives.
+//  - DATA: [kind] [sequence: 2 bytes] [ack: 2 bytes] [ack bits: 4 bytes] [message: JSON text, empty for an acknowledgment only]
+//    The messages are not resent: the sequence numbers only drop the late datagrams and detect the lost ones.
+enum class UdpPacketKind : uint8_t {
+    HELLO = 1,
+    HELLO_ACK = 2,
+    DATA = 3
+};
+
+struct UdpDataHeader {
+    uint16_t sequence = 0;      // Number of this datagram (0 is never used)
+    uint16_t ack = 0;           // Last sequence received from the other side (0: none yet)
+    uint32_t ack_bits = 0;      // Bit k set: the sequence ack - 1 - k was received too
+};
+
+size_t const udp_data_header_size = 9;
+// Largest datagram sent, header included: below the usual path MTU (1280 bytes of IPv6 minus the IP and UDP headers),
+//  so that a datagram is never fragmented (a lost fragment loses the whole datagram). The larger messages use the WebSocket.
+size_t const udp_max_datagram_size = 1200;
+
+std::string encode_udp_hello(UdpPacketKind kind, uint64_t token);
+std::string encode_udp_data_header(UdpDataHeader const& header);
+
+// Read a datagram (returns false if it is malformed). For DATA, the message is the rest of the datagram.
+struct UdpPacket {
+    UdpPacketKind kind;
+    uint64_t token = 0;
+    UdpDataHeader header;
+    std::string message;
+};
+bool decode_udp_packet(char const* data, size_t size, UdpPacket& packet);
+
+// True if the 16 bits sequence a is more recent than b (the numbers wrap around)
+bool udp_sequence_newer(uint16_t a, uint16_t b);
+
+// Numbering and acknowledgments of the DATA datagrams of one side of the channel
+//  The received sequences are summarized in the header of every sent datagram (last one and a bitfield of the 32 previous ones).
+//  From the acknowledgments of the other side, a sent datagram is acknowledged, or lost when three more recent datagrams were
+//  acknowledged before it (or it left the bitfield).
+class UdpSequencer {
+public:
+    // Header of the next sent datagram (numbered, with the current acknowledgments)
+    UdpDataHeader next_header();
+
+    // Received datagram: fills the sent sequences acknowledged or lost since the previous call, and returns false if the
+    //  datagram is older than the most recent one received (its content is out of date: only its acknowledgments are used)
+    bool receive(UdpDataHeader const& header, std::vector<uint16_t>& acknowledged, std::vector<uint16_t>& lost);
+
+private:
+    uint16_t next_sequence = 1;
+    bool has_received = false;
+    uint16_t remote_sequence = 0;   // Most recent received sequence
+    uint32_t received_bits = 0;     // Received sequences before it
+    std::deque<uint16_t> in_flight; // Sent sequences neither acknowledged nor lost, in order
+};
@@ -1,4 +1,5 @@
 #include "websocket_service.hpp"
+#include "profiler.hpp"
 #include <iostream>
 #include <regex>
 
@@ -16,6 +17,7 @@ WebSocketService& WebSocketService::getInstance() {
 WebSocketService::WebSocketService() {
     // Initialize IO context
     ioc_ = std::make_unique<net::io_context>();
+    udp_.setConditioners(&outbound_, &inbound_);
 }
 
 WebSocketService::~WebSocketService() {
@@ -36,6 +38,9 @@ bool WebSocketService::connect(const std::string& url, const std::string& token,
         std::cout << "Already connected to WebSocket server\n";
         return true;
     }
+
+    // Threads, delayed messages and UDP channel of a previous connection lost by itself
+    disconnect();
     
     try {
         // Parse URL
@@ -81,24 +86,32 @@ bool WebSocketService::connect(const std::string& url, const std::string& token,
         }
         
         std::cout << "Connecting to " << host << ":" << port << target << std::endl;
+        host_ = host;
         
-        // Create fresh objects for the connection
+        // Create fresh objects for the connection (the previous stream is destroyed before its io_context)
+        {
+            std::lock_guard<std::mutex> lock(write_mutex_);
+            ws_.reset();
+        }
+        resolver_.reset();
         ioc_ = std::make_unique<net::io_context>();
         resolver_ = std::make_unique<tcp::resolver>(*ioc_);
-        ws_ = std::make_unique<websocket::stream<tcp::socket>>(*ioc_);
+        auto ws = std::make_unique<websocket::stream<tcp::socket>>(*ioc_);
+        uint64_t const generation = ++generation_;
         
         // Look up the domain name
         auto const results = resolver_->resolve(host, port);
         
         // Make the connection on the IP address we get from a lookup
-        auto ep = net::connect(ws_->next_layer(), results);
+        auto ep = net::connect(ws->next_layer(), results);
+        ws->next_layer().set_option(tcp::no_delay(true)); // Small messages at the frame rate: send them without waiting
         
         // Set a timeout for the handshake
-        ws_->set_option(websocket::stream_base::timeout::suggested(
+        ws->set_option(websocket::stream_base::timeout::suggested(
             beast::role_type::client));
         
         // Set a decorator to change the User-Agent of the handshake
-        ws_->set_option(websocket::stream_base::decorator(
+        ws->set_option(websocket::stream_base::decorator(
             [](websocket::request_type& req) {
                 req.set(http::field::user_agent,
                     std::string(BOOST_BEAST_VERSION_STRING) +
@@ -106,8 +119,24 @@ bool WebSocketService::connect(const std::string& url, const std::string& token,
             }));
             
         // Perform the websocket handshake
-        ws_->handshake(host + ":" + port, target);
-        
+        ws->handshake(host + ":" + port, target);
+
+        // Pongs are received by the read loop
+        if (pong_handler_) {
+            ws->control_callback([this, generation](websocket::frame_type kind, beast::string_view payload) {
+                if (kind == websocket::frame_type::pong) {
+                    std::string const data(payload);
+                    inbound_.submit(data.size(), true, [this, data, generation]() {
+                        if (generation == generation_) pong_handler_(data);
+                    });
+                }
+            });
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(write_mutex_);
+            ws_ = std::move(ws);
+        }
         connected_ = true;
         
         // Start the IO service in a separate thread
@@ -121,8 +150,8 @@ bool WebSocketService::connect(const std::string& url, const std::string& token,
         });
         
         // Start reading messages
-        read_thread_ = std::thread([this]() {
-            readLoop();
+        read_thread_ = std::thread([this, generation]() {
+            readLoop(generation);
         });
         
         return true;
@@ -133,12 +162,24 @@ bool WebSocketService::connect(const std::string& url, const std::string& token,
 }
 
 void WebSocketService::disconnect() {
-    if (!connected_) return;
+    // Also run after a connection lost by itself (connected_ already false): its threads, its UDP channel and its
+    //  delayed messages are still there
+    bool const was_connected = connected_.exchange(false);
     
     try {
-        // Close the WebSocket connection
-        if (ws_) {
-            ws_->close(websocket::close_code::normal);
+        generation_++;
+        udp_.close();
+        inbound_.clear();
+        outbound_.clear();
+
+        // Shut the socket down: the blocking read of readLoop returns (a close handshake from this thread would run
+        //  concurrently with that read)
+        {
+            std::lock_guard<std::mutex> lock(write_mutex_);
+            if (ws_) {
+                beast::error_code ec;
+                ws_->next_layer().shutdown(tcp::socket::shutdown_both, ec);
+            }
         }
         
         // Stop the IO context
@@ -146,8 +187,6 @@ void WebSocketService::disconnect() {
             ioc_->stop();
         }
         
-        connected_ = false;
-        
         // Wait for threads to finish
         if (read_thread_.joinable()) {
             read_thread_.join();
@@ -157,7 +196,8 @@ void WebSocketService::disconnect() {
             io_thread_.join();
         }
         
-        std::cout << "Disconnected from WebSocket server" << std::endl;
+        if (was_connected)
+            std::cout << "Disconnected from WebSocket server" << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Error during disconnect: " << e.what() << std::endl;
     }
@@ -172,23 +212,53 @@ void WebSocketService::send(const std::string& message) {
         std::cerr << "Cannot send message: not connected" << std::endl;
         return;
     }
-    
+    uint64_t const generation = generation_;
+    outbound_.submit(message.size(), true, [this, message, generation]() { write(message, generation); });
+}
+
+void WebSocketService::write(const std::string& message, uint64_t generation) {
     try {
         // Send the message synchronously
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        if (!connected_ || !ws_ || generation != generation_) return; // Disconnected while the message was delayed
         ws_->write(net::buffer(message));
-        std::cout << "Message sent: " << message << std::endl;
+        recorder_.record(NetworkRecordKind::OUTBOUND, message);
+        if (logging_)
+            std::cout << "Message sent: " << message << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Error sending message: " << e.what() << std::endl;
         connected_ = false;
     }
 }
 
+void WebSocketService::ping(const std::string& payload) {
+    if (!connected_ || !ws_) return;
+
+    uint64_t const generation = generation_;
+    outbound_.submit(payload.size(), true, [this, payload, generation]() {
+        try {
+            std::lock_guard<std::mutex> lock(write_mutex_);
+            if (!connected_ || !ws_ || generation != generation_) return;
+            ws_->ping(websocket::ping_data(payload.c_str()));
+        } catch (const std::exception& e) {
+            std::cerr << "Error sending ping: " << e.what() << std::endl;
+            connected_ = false;
+        }
+    });
+}
+
+void WebSocketService::registerPongHandler(std::function<void(const std::string&)> handler) {
+    pong_handler_ = handler;
+}
+
 void WebSocketService::registerMessageHandler(std::function<void(const std::string&)> handler) {
     std::lock_guard<std::mutex> lock(mutex_);
     message_handler_ = handler;
 }
 
-void WebSocketService::readLoop() {
+void WebSocketService::readLoop(uint64_t generation) {
+    Profiler::instance().set_thread_name("WebSocket");
+
     try {
         beast::flat_buffer buffer;
         
@@ -198,20 +268,18 @@ void WebSocketService::readLoop() {
             
             // Extract message to string
             std::string message = beast::buffers_to_string(buffer.data());
-            std::cout << "Message received: " << message << std::endl;
             
             // Clear the buffer for the next read
             buffer.consume(buffer.size());
             
-            // Call handler if registered
-            std::lock_guard<std::mutex> lock(mutex_);
-            if (message_handler_) {
-                message_handler_(message);
-            }
+            std::size_t const size = message.size();
+            inbound_.submit(size, true, [this, message = std::move(message), generation]() {
+                if (generation == generation_) deliver(message);
+            });
         }
     } catch (const beast::system_error& se) {
         // Don't log error if it's just because the connection was closed normally
-        if (se.code() != websocket::error::closed) {
+        if (connected_ && se.code() != websocket::error::closed) {
             std::cerr << "WebSocket read error: " << se.code().message() << std::endl;
         }
         connected_ = false;
@@ -220,3 +288,41 @@ void WebSocketService::readLoop() {
         connected_ = false;
     }
 }
+
+void WebSocketService::deliver(const std::string& message) {
+    recorder_.record(NetworkRecordKind::INBOUND, message);
+    if (logging_)
+        std::cout << "Message received: " << message << std::endl;
+
+    // Call handler if registered
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (message_handler_) {
+        message_handler_(message);
+    }
+}
+
+void WebSocketService::requestUdp() {
+    send("{\"type\":\"UDP\"}");
+}
+
+void WebSocketService::openUdp(unsigned short port, uint64_t token) {
+    if (!connected_) return;
+    // The datagrams are delivered like the WebSocket messages (recorded, then given to the handler)
+    udp_.open(host_, port, token, [this](const std::string& message) { deliver(message); });
+}
+
+void WebSocketService::setNetworkConditions(const NetworkConditions& conditions) {
+    inbound_.setConditions(conditions);
+    outbound_.setConditions(conditions);
+}
+
+void WebSocketService::sendState(const std::string& message) {
+    if (!udp_.isEstablished() || message.size() + udp_data_header_size > udp_max_datagram_size) {
+        send(message);
+        return;
+    }
+    udp_.send(message);
+    recorder_.record(NetworkRecordKind::OUTBOUND, message);
+    if (logging_)
+        std::cout << "Message sent (UDP): " << message << std::endl;
+}
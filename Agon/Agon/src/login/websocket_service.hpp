@@ -9,11 +9,18 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include "network_recording.hpp"
+#include "udp_channel.hpp"
+#include "network_conditioner.hpp"
 
 class WebSocketService {
 public:
     // Singleton pattern
     static WebSocketService& getInstance();
+
+    // Separate connections (used by the load test bots, the game uses getInstance())
+    WebSocketService();
+    ~WebSocketService();
     
     // Connect to a WebSocket server
     bool connect(const std::string& url, const std::string& token = "", const std::string& roomId = "");
@@ -29,14 +36,44 @@ public:
     
     // Check if connected
     bool isConnected() const;
-    
-    
+
+    // Print every sent and received message on the standard output (default: true)
+    void setLogging(bool enabled) { logging_ = enabled; }
+
+    // Send a WebSocket ping: the handler registered before connect() receives the payload of the pong
+    void ping(const std::string& payload);
+    void registerPongHandler(std::function<void(const std::string&)> handler);
+
+    // Record every received and sent message with its time (see NetworkRecorder), and information about the session
+    bool startRecording(const std::string& filename) { return recorder_.open(filename); }
+    void stopRecording() { recorder_.close(); }
+    void recordInfo(const std::string& info) { recorder_.record(NetworkRecordKind::INFO, info); }
+
+    // Optional UDP channel of the frequent states (see UdpChannel)
+    //  requestUdp() asks the server for a channel ({"type":"UDP"}), and its answer {"type":"UDP","content":{"port":P,"token":T}}
+    //  is given to openUdp(), which starts the handshake with the host of the WebSocket. Once the channel is established,
+    //  sendState() sends by UDP and the received datagrams reach the message handler; otherwise, or for a message too large
+    //  for one datagram (udp_max_datagram_size), sendState() uses the WebSocket.
+    void requestUdp();
+    void openUdp(unsigned short port, uint64_t token);
+    void sendState(const std::string& message);
+    bool isUdpEstablished() const { return udp_.isEstablished(); }
+    void setUdpLoss(float probability) { udp_.setLoss(probability); }
+    UdpChannel::Statistics udpStatistics() const { return udp_.statistics(); }
+
+    // Simulated latency, jitter, bandwidth, reordering and loss of the received and of the sent messages (see
+    //  NetworkConditioner): the WebSocket is reliable (lost messages are retransmitted), the UDP datagrams are dropped
+    void setNetworkConditions(const NetworkConditions& conditions);
+    NetworkConditions networkConditions() const { return outbound_.conditions(); }
+    NetworkConditioner::Statistics inboundNetworkStatistics() const { return inbound_.statistics(); }
+    NetworkConditioner::Statistics outboundNetworkStatistics() const { return outbound_.statistics(); }
+
 private:
-    WebSocketService();
-    ~WebSocketService();
     
     // Handle incoming messages
-    void readLoop();
+    void readLoop(uint64_t generation);
+    void deliver(const std::string& message);
+    void write(const std::string& message, uint64_t generation);
     
     // Beast objects
     std::unique_ptr<boost::asio::io_context> ioc_;
@@ -47,8 +84,20 @@ private:
     std::thread io_thread_;
     std::thread read_thread_;
     std::atomic<bool> connected_ {false};
+    std::atomic<uint64_t> generation_ {0};  // Connection number: the messages delayed by the conditioners are dropped once it changed
+    std::atomic<bool> logging_ {true};
     
     // Message handling
     std::function<void(const std::string&)> message_handler_;
+    std::function<void(const std::string&)> pong_handler_;
+    NetworkRecorder recorder_;
     std::mutex mutex_;
+    std::mutex write_mutex_;    // Writes (the delayed messages are written by the outbound conditioner), and the replacement and shutdown of ws_
+
+    std::string host_;          // Host of the WebSocket, also used by the UDP channel
+    UdpChannel udp_;
+
+    // Declared last: destroyed first, while the objects used by the delayed messages still exist
+    NetworkConditioner inbound_{"Network inbound"};
+    NetworkConditioner outbound_{"Network outbound"};
 };
\ No newline at end of file
@@ -3,6 +3,9 @@
 
 // Custom scene of this code
 #include "scene.hpp"
+#include "benchmark.hpp"
+#include "login/api_service.hpp"
+#include "login/network_recording.hpp"
 
 
 
@@ -25,13 +28,38 @@ void animation_loop();
 void display_gui_default();
 
 bool vc = false;
+bool show_profiler = false;
 
 timer_fps fps_record;
 
-int main(int, char* argv[])
+int main(int argc, char* argv[])
 {
 	std::cout << "Run " << argv[0] << std::endl;
-
+	Profiler::instance().set_thread_name("Render");
+
+	// Headless benchmark mode (--benchmark): offscreen rendering of a scripted scene, without login nor user input
+	BenchmarkSettings const benchmark_settings = BenchmarkSettings::from_command_line(argc, argv);
+	if (benchmark_settings.enabled) {
+		scene.window.is_headless = true;
+		project::initial_window_size_width = float(benchmark_settings.width);
+		project::initial_window_size_height = float(benchmark_settings.height);
+		project::simulation_in_thread = false; // The benchmark publishes the snapshots itself
+	}
+	// Network recording (--record) and replay of a recording without server (--replay)
+	NetworkReplaySettings const network_settings = NetworkReplaySettings::from_command_line(argc, argv);
+	// Client-side prediction of the local player with server reconciliation (--prediction), for a server applying the sequenced INPUT,
+	//  and UDP channel of the states (--udp) with a simulated loss of the datagrams (--udp-loss p)
+	for (int k = 1; k < argc; ++k) {
+		std::string const arg = argv[k];
+		if (arg == "--prediction") scene.prediction_enabled = true;
+		else if (arg == "--udp") scene.udp_enabled = true;
+		else if (arg == "--udp-loss" && k + 1 < argc) WebSocketService::getInstance().setUdpLoss(float(std::atof(argv[++k])));
+	}
+	// Simulated network conditions of every message (--net-latency, --net-jitter, --net-bandwidth, --net-reorder, --net-loss)
+	//  and rate of the UPDATE messages (--send-rate Hz), also in the "Network conditions" panel
+	WebSocketService::getInstance().setNetworkConditions(NetworkConditions::from_command_line(argc, argv));
+	for (int k = 1; k + 1 < argc; ++k)
+		if (std::string(argv[k]) == "--send-rate") scene.state_send_rate = std::max(0, std::atoi(argv[k + 1]));
 
 
 	// ************************ //
@@ -53,6 +81,29 @@ int main(int, char* argv[])
 	scene.initialize();
 	std::cout << "Initialization finished\n" << std::endl;
 
+	if (benchmark_settings.enabled) {
+		int const exit_code = Benchmark(benchmark_settings).run(scene);
+		cgp::imgui_cleanup();
+		glfwDestroyWindow(scene.window.glfw_window);
+		glfwTerminate();
+		return exit_code;
+	}
+
+
+	if (!network_settings.record.empty())
+		WebSocketService::getInstance().startRecording(network_settings.record);
+
+	// The replay skips the login: the recorded messages are handled as if they came from the server
+	std::unique_ptr<NetworkReplay> replay;
+	if (!network_settings.replay.empty()) {
+		replay = std::make_unique<NetworkReplay>(network_settings);
+		if (!replay->load())
+			return EXIT_FAILURE;
+		scene.current_state = GameState::MAIN_GAME;
+		scene.username = replay->username();
+		replay->start([](const std::string& message) { APIService::getInstance().handleWebSocketMessage(message); });
+	}
+
 
 	// ************************ //
 	//     Animation Loop
@@ -60,6 +111,11 @@ int main(int, char* argv[])
 	std::cout << "Start animation loop ..." << std::endl;
 	fps_record.start();
 
+	// The simulation runs on its own thread, the loop below only renders the published snapshots
+	if (project::simulation_in_thread) {
+		scene.simulation_thread.start(project::simulation_rate, [](float dt) { scene.simulation_step(dt); });
+	}
+
 
 	// Call the main display loop in the function animation_loop
 	//  The following part is simply a loop that call the function "animation_loop"
@@ -67,7 +123,7 @@ int main(int, char* argv[])
 #ifndef __EMSCRIPTEN__
     double lasttime = glfwGetTime();
 	// Default mode to run the animation/display loop with GLFW in C++
-	while (!glfwWindowShouldClose(scene.window.glfw_window)) {
+	while (!glfwWindowShouldClose(scene.window.glfw_window) && !(replay && network_settings.exit_when_done && replay->finished())) {
 		// The real animation loop
 		animation_loop();
 
@@ -83,6 +139,9 @@ int main(int, char* argv[])
 #endif
 
 	std::cout << "\nAnimation loop stopped" << std::endl;
+	scene.simulation_thread.stop();
+	replay.reset();
+	WebSocketService::getInstance().stopRecording();
 
 	// Terminate the Python script
 	system("if [ -f python_script.pid ]; then kill $(cat python_script.pid) && rm python_script.pid; fi");
@@ -97,6 +156,8 @@ int main(int, char* argv[])
 
 void animation_loop()
 {
+	Profiler::instance().begin_frame();
+	PROFILE_SCOPE("animation_loop");
 
 	emscripten_update_window_size(scene.window.width, scene.window.height); // update window size in case of use of emscripten (not used by default)
 
@@ -119,8 +180,9 @@ void animation_loop()
 	imgui_create_frame();
 	ImGui::GetIO().FontGlobalScale = project::gui_scale;
 
+	// The GUI reads and modifies the simulation state
+	std::unique_lock<std::mutex> simulation_lock(scene.simulation_mutex);
 	scene.inputs.mouse.on_gui = ImGui::GetIO().WantCaptureMouse;
-    scene.inputs.time_interval = time_interval;
 
 
     // Only show game UI in main game state
@@ -155,6 +217,9 @@ void animation_loop()
 		scene.display_weapon_info();
 		ImGui::End();
 
+		if (show_profiler)
+			Profiler::instance().display_gui(&show_profiler);
+
 
 		if(scene.showChat){
 			// Set window position BEFORE ImGui::Begin
@@ -178,17 +243,22 @@ void animation_loop()
 			scene.display_chat();
 			ImGui::End();
 		}
-        
-        // Handle camera behavior in main game mode
-        scene.idle_frame();
     }
+	simulation_lock.unlock();
 
+	// Without simulation thread: one step per frame
+	if (!project::simulation_in_thread) {
+		scene.simulation_step(time_interval);
+	}
 
-	// Call the display of the scene
+	// Call the display of the scene (reads the last published snapshot)
 	scene.display_frame();
 
 
-	imgui_render_frame(scene.window.glfw_window);
+	{
+		GPU_PROFILE_SCOPE("ImGui");
+		imgui_render_frame(scene.window.glfw_window);
+	}
 	glfwSwapBuffers(scene.window.glfw_window);
 	glfwPollEvents();
 }
@@ -200,8 +270,12 @@ void initialize_default_shaders()
 	//  By default, it should be "shaders/"
 	std::string default_path_shaders = project::path +"shaders/";
 
+	// Linked programs are cached on disk to skip the compilation at the next launches
+	opengl_shader_structure::program_binary_cache.directory = default_path_shaders + "cache/";
+
 	// Set standard mesh shader for mesh_drawable
 	mesh_drawable::default_shader.load(default_path_shaders +"mesh/mesh.vert.glsl", default_path_shaders +"mesh/mesh.frag.glsl");
+	mesh_drawable::default_shader_variant.load(default_path_shaders +"mesh/mesh.vert.glsl", default_path_shaders +"mesh/mesh.frag.glsl");
 	triangles_drawable::default_shader.load(default_path_shaders +"mesh/mesh.vert.glsl", default_path_shaders +"mesh/mesh.frag.glsl");
 
 	// Set default white texture
@@ -243,6 +317,7 @@ window_structure standard_window_initialization()
 
 	// Create the window using GLFW
 	window_structure window;
+	window.is_headless = scene.window.is_headless;
 	window.create_window(window_width, window_height, "CGP Display", CGP_OPENGL_VERSION_MAJOR, CGP_OPENGL_VERSION_MINOR);
 
 
@@ -251,7 +326,8 @@ window_structure standard_window_initialization()
 
 	// Display window size
 	std::cout << "\nWindow (" << window.width << "px x " << window.height << "px) created" << std::endl;
-	std::cout << "Monitor: " << glfwGetMonitorName(window.monitor) << " - Resolution (" << window.screen_resolution_width << "x" << window.screen_resolution_height << ")\n" << std::endl;
+	if (window.monitor != nullptr)
+		std::cout << "Monitor: " << glfwGetMonitorName(window.monitor) << " - Resolution (" << window.screen_resolution_width << "x" << window.screen_resolution_height << ")\n" << std::endl;
 
 	// Display debug information on command line
 	std::cout << "OpenGL Information:" << std::endl;
@@ -285,6 +361,7 @@ void window_size_callback(GLFWwindow*, int width, int height)
 void mouse_move_callback(GLFWwindow* /*window*/, double xpos, double ypos)
 {
 	vec2 const pos_relative = scene.window.convert_pixel_to_relative_coordinates({ xpos, ypos });
+	std::lock_guard<std::mutex> lock(scene.simulation_mutex);
 	scene.inputs.mouse.position.update(pos_relative);
 	scene.mouse_move_event();
 }
@@ -294,6 +371,7 @@ void mouse_click_callback(GLFWwindow* window, int button, int action, int mods)
 {
 	ImGui_ImplGlfw_MouseButtonCallback(window, button, action, mods);
 
+	std::lock_guard<std::mutex> lock(scene.simulation_mutex);
 	scene.inputs.mouse.click.update_from_glfw_click(button, action);
 	scene.mouse_click_event();
 }
@@ -303,6 +381,7 @@ void mouse_scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 {
 	ImGui_ImplGlfw_ScrollCallback(window, xoffset, yoffset);
 
+	std::lock_guard<std::mutex> lock(scene.simulation_mutex);
 	scene.inputs.mouse.scroll = yoffset;
 	scene.mouse_scroll_event();
 }
@@ -314,6 +393,7 @@ void keyboard_callback(GLFWwindow* window, int key, int scancode, int action, in
 	bool imgui_capture_keyboard = ImGui::GetIO().WantCaptureKeyboard;
 
 	if(!imgui_capture_keyboard){
+		std::lock_guard<std::mutex> lock(scene.simulation_mutex);
 		scene.inputs.keyboard.update_from_glfw_key(key, action);
 		scene.keyboard_event();
 
@@ -362,6 +442,10 @@ void display_gui_default()
 #endif
 		ImGui::SliderFloat("Gui Scale", &project::gui_scale, 0.5f, 2.5f);
 
+		// CPU/GPU timings of the frame (the recording starts with the display of the profiler)
+		if (ImGui::Checkbox("Profiler", &show_profiler) && show_profiler)
+			Profiler::instance().enabled = true;
+
 #ifndef __EMSCRIPTEN__
 		// Arbitrary limits the refresh rate to a maximal frame per seconds.
 		//  This limits the risk of having different behaviors when you use different machine.
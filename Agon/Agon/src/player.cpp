@@ -11,12 +11,12 @@ Player::Player()
     shooting_flag(false), moving_flag(false) { 
 }
 
-void Player::initialise(cgp::input_devices& inputs, cgp::window_structure& window, AudioSystem* audio_sys) {
+void Player::initialise_simulation() {
     hp = 100;
 
     movement_speed = 6.0f;
     height = 1.95f;
-    position = cgp::vec3(-3.f, -3.f, height);
+    position = getSpawnPosition();
     collision_radius = 0.5f;
 
     
@@ -34,108 +34,23 @@ void Player::initialise(cgp::input_devices& inputs, cgp::window_structure& windo
     current_pitch = 0.0f;
     max_pitch_up = 85.0f;     
     max_pitch_down = -85.0f;  
-
-    camera.initialize(inputs, window);
-    camera.set_rotation_axis_z(); 
-    camera.look_at(position, position + cgp::vec3(0.2, 0, 0)); 
-    
-    camera.is_cursor_trapped = true;
-
-    weapon.initialize(audio_sys);
-
-    
-    
-    
-    
-    
-    
-    
-    
-    
 }
 
-void Player::set_initial_model_properties(const cgp::mesh& base_mesh_data, const cgp::rotation_transform& initial_rotation_transform) {
-    initial_model_rotation = initial_rotation_transform; 
-    player_visual_model.initialize_data_on_gpu(base_mesh_data);
-    player_visual_model.model.set_scaling(0.9f);
-    
-    
-    
-    
-}
-
-void Player::update(float dt, const cgp::inputs_keyboard_parameters& keyboard, const cgp::inputs_mouse_parameters& mouse, cgp::mat4& camera_view_matrix) {
+void Player::step(float dt, const PlayerInput& input) {
     if (is_dead) return; 
 
-    static cgp::vec3 forward;
-    static cgp::vec3 right;
-    static cgp::vec3 desired_direction(0, 0, 0);
-    static cgp::vec3 velocity_change;
-
-    
-    shooting_flag = false;
-    moving_flag = false;
-    running_flag = false;
-
-    forward = camera.camera_model.front();
-    right = camera.camera_model.right();
+    cgp::vec3 desired_direction = input.direction;
+    cgp::vec3 velocity_change;
 
-    forward.z = 0;
-    right.z = 0;
+    shooting_flag = input.shoot;
+    moving_flag = cgp::norm(desired_direction) > 0.01f;
+    running_flag = moving_flag && input.run;
 
     
-    if (keyboard.is_pressed(GLFW_KEY_R)) {
-        weapon.reload();
-    }
-    
-    
-    
-    if (mouse.click.left) {
-        shooting_flag = true; 
-    }
-
-    if (keyboard.is_pressed(GLFW_KEY_R)) {
-        weapon.reload();
-    }
-
-    
-    if (cgp::norm(forward) > 0.01f) forward = cgp::normalize(forward);
-    if (cgp::norm(right) > 0.01f) right = cgp::normalize(right);
-
-    
-    desired_direction = { 0,0,0 };
-    if (keyboard.is_pressed(GLFW_KEY_W)) {
-        desired_direction += forward;
-        moving_flag = true; 
-    }
-    if (keyboard.is_pressed(GLFW_KEY_S)) {
-        desired_direction -= forward;
-        moving_flag = true; 
-    }
-    if (keyboard.is_pressed(GLFW_KEY_D)) {
-        desired_direction += right;
-        moving_flag = true; 
-    }
-    if (keyboard.is_pressed(GLFW_KEY_A)) {
-        desired_direction -= right;
-        moving_flag = true; 
-    }
-
-    
-    if (cgp::norm(desired_direction) > 0.01f) {
-        desired_direction = cgp::normalize(desired_direction);
-    }
-
-    
-    float target_speed = keyboard.shift ? max_velocity * 1.8f : max_velocity;
+    float target_speed = input.run ? max_velocity * 1.8f : max_velocity;
     cgp::vec3 target_velocity = desired_direction * target_speed;
     
     
-    if (moving_flag && keyboard.shift) {
-        running_flag = true;
-    }
-
-    
     if (cgp::norm(desired_direction) > 0.01f) {
         
         velocity_change = target_velocity - velocity;
@@ -161,11 +76,6 @@ void Player::update(float dt, const cgp::inputs_keyboard_parameters& keyboard, c
         }
     }
 
-
-
-
-    
-
     
     if (position.z <= height) {
         position.z = height;  
@@ -175,7 +85,7 @@ void Player::update(float dt, const cgp::inputs_keyboard_parameters& keyboard, c
 
     if (isGrounded) {
         verticalVelocity = 0.0f; 
-        if (keyboard.is_pressed(GLFW_KEY_SPACE)) {
+        if (input.jump) {
             verticalVelocity = jumpForce; 
             isGrounded = false;          
         }
@@ -187,7 +97,6 @@ void Player::update(float dt, const cgp::inputs_keyboard_parameters& keyboard, c
     
     position.z += verticalVelocity * dt;
 
-    
     cgp::vec3 intended_position = position;
     intended_position.x += velocity.x * dt;
     intended_position.y += velocity.y * dt;
@@ -230,23 +139,18 @@ void Player::update(float dt, const cgp::inputs_keyboard_parameters& keyboard, c
             position += push_direction * push_strength;
         }
     }
+}
 
-    weapon.update(dt);
-
-    
-    float camera_forward_offset = 0.1f; 
-    camera.camera_model.position_camera = position + camera.camera_model.front() * camera_forward_offset;
-    camera_view_matrix = camera.camera_model.matrix_view();
-
-    
-    cgp::vec3 right_offset = camera.camera_model.right() * 0.2f; 
-    player_visual_model.model.translation = position + right_offset;
-    player_visual_model.model.translation.z -= 0.8f; 
-
-    player_visual_model.model.rotation = cgp::rotation_transform::from_axis_angle({0,0,1}, camera.camera_model.yaw);
-
+PlayerMovementState Player::getMovementState() const {
+    return { position, velocity, verticalVelocity, isGrounded };
 }
 
+void Player::setMovementState(const PlayerMovementState& state) {
+    position = state.position;
+    velocity = state.velocity;
+    verticalVelocity = state.vertical_velocity;
+    isGrounded = state.grounded;
+}
 
 cgp::vec3 Player::compute_push_direction(const cgp::vec3& pos) {
     if (apartment == nullptr) return cgp::vec3(0, 0, 0);
@@ -290,6 +194,11 @@ cgp::vec3 Player::getPosition() const
     return position;
 }
 
+void Player::setPosition(const cgp::vec3& new_position)
+{
+    position = new_position;
+}
+
 
 bool Player::isShooting() const {
     return shooting_flag;
@@ -303,26 +212,6 @@ bool Player::isRunning() const {
     return running_flag;
 }
 
-void Player::handle_mouse_move(cgp::vec2 const& mouse_position_current, cgp::vec2 const& mouse_position_previous, cgp::mat4& camera_view_matrix) {
-    
-    camera.action_mouse_move(camera_view_matrix); 
-
-    
-    float& current_cam_pitch_rad = camera.camera_model.pitch; 
-
-    
-    
-    float local_max_pitch_up_rad = max_pitch_up * cgp::Pi / 180.0f;
-    float local_max_pitch_down_rad = max_pitch_down * cgp::Pi / 180.0f; 
-
-    current_cam_pitch_rad = cgp::clamp(current_cam_pitch_rad, local_max_pitch_down_rad, local_max_pitch_up_rad);
-
-    
-    camera_view_matrix = camera.camera_model.matrix_view();
-
-    
-}
-
 void Player::set_apartment(Apartment* apartment_ptr)
 {
     apartment = apartment_ptr;
@@ -336,23 +225,6 @@ Weapon& Player::getWeaponMutable() {
     return weapon;
 }
 
-HitInfo Player::performShoot(const std::map<std::string, RemotePlayer>& remote_players) {
-    shooting_flag = true; 
-    return weapon.shootWithHitDetection(*this, remote_players);
-}
-
-void Player::draw_model(const cgp::environment_generic_structure& environment) {
-    
-    
-    
-    
-    
-    
-    
-
-    draw(player_visual_model, environment);
-}
-
 
 void Player::updateHealth(int healthChange) {
     hp += healthChange;
@@ -389,7 +261,7 @@ void Player::die() {
 void Player::respawn() {
     is_dead = false;
     hp = 100;
-    position = cgp::vec3(-3.f, -3.f, height); 
+    position = getSpawnPosition();
     velocity = cgp::vec3(0, 0, 0);
     verticalVelocity = 0.0f;
     std::cout << "Player respawned." << std::endl;
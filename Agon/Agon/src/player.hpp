@@ -14,6 +14,23 @@ class AudioSystem;
 
 #include "weapon.hpp"
 
+// Movement command of one simulation step
+//  Built from the keyboard on the client, or received from the network on the server.
+struct PlayerInput {
+    cgp::vec3 direction = { 0, 0, 0 }; // Desired horizontal direction in world space (normalized, or zero to stop)
+    bool run = false;
+    bool jump = false;
+    bool shoot = false;
+};
+
+// Part of the player state computed by Player::step, saved and restored by the client prediction
+struct PlayerMovementState {
+    cgp::vec3 position = { 0, 0, 0 };
+    cgp::vec3 velocity = { 0, 0, 0 };
+    float vertical_velocity = 0.0f;
+    bool grounded = true;
+};
+
 class Player {
 private:
     int hp;
@@ -52,12 +69,15 @@ private:
     // Model for the player
     cgp::mesh_drawable player_visual_model; // Renamed from player_model for clarity if it was generic
     cgp::rotation_transform initial_model_rotation; // To make model stand upright
+    cgp::affine model_placement; // Placement of the model computed by update() (the drawable itself belongs to the render thread)
 
     // State flags
     bool shooting_flag;
     bool moving_flag;
     bool running_flag;
 
+    PlayerInput last_input;     // Input of the last update() (sent to the server by the client prediction)
+
 public:
     // Default constructor
     Player();
@@ -66,8 +86,15 @@ public:
     cgp::camera_controller_first_person_euler camera;
 
     void initialise(cgp::input_devices& inputs, cgp::window_structure& window, AudioSystem* audio_sys = nullptr);
+    void initialise_simulation(); // Physical parameters only (no camera nor audio: used by the server)
     void set_initial_model_properties(const cgp::mesh& base_mesh_data, const cgp::rotation_transform& initial_rotation_transform); // New method
     void update(float dt, const cgp::inputs_keyboard_parameters& keyboard, const cgp::inputs_mouse_parameters& mouse, cgp::mat4& camera_view_matrix);
+    PlayerInput input_from_keyboard(const cgp::inputs_keyboard_parameters& keyboard, const cgp::inputs_mouse_parameters& mouse) const;
+    // Velocity, jump and collisions for one step (shared by the client update and the server simulation)
+    void step(float dt, const PlayerInput& input);
+    const PlayerInput& getLastInput() const { return last_input; }
+    PlayerMovementState getMovementState() const;
+    void setMovementState(const PlayerMovementState& state);
     void handle_mouse_move(cgp::vec2 const& mouse_position_current, cgp::vec2 const& mouse_position_previous, cgp::mat4& camera_view_matrix);
 
     void set_apartment(Apartment* apartment_ptr);
@@ -76,14 +103,19 @@ public:
     Weapon& getWeaponMutable(); // Non-const version for shooting
     
     // Shooting system
-    HitInfo performShoot(const std::map<std::string, RemotePlayer>& remote_players);
+    HitInfo performShoot(const std::map<std::string, RemotePlayer>& remote_players, double render_time = -1.0);
     
     // Model methods
     //void load_model(const std::string& model_path);
     //void draw(const cgp::environment_generic_structure& environment);
-    void draw_model(const cgp::environment_generic_structure& environment); // New method to draw player model
+    void draw_model(cgp::render_queue_structure& queue, const cgp::environment_generic_structure& environment, const cgp::affine& placement); // Draw the player model at the given placement (from the render snapshot)
+    const cgp::affine& getModelPlacement() const { return model_placement; }
 
     cgp::vec3 getPosition() const;
+    void setPosition(const cgp::vec3& new_position);
+    cgp::vec3 getSpawnPosition() const { return cgp::vec3(-3.f, -3.f, height); }
+    float getCollisionRadius() const { return collision_radius; }
+    float getMaxVelocity() const { return max_velocity; }
 
     int getHP() const {return hp;};
     
@@ -0,0 +1,113 @@
+#include "player.hpp"
+#include "weapon.hpp"
+
+// Parts of the player only used by the game client: camera, keyboard and mouse, model drawing, shooting and audio
+//  (player.cpp holds the simulation shared with the server and the bots)
+
+void Player::initialise(cgp::input_devices& inputs, cgp::window_structure& window, AudioSystem* audio_sys) {
+    initialise_simulation();
+
+    camera.initialize(inputs, window);
+    camera.set_rotation_axis_z(); 
+    camera.look_at(position, position + cgp::vec3(0.2, 0, 0)); 
+    
+    camera.is_cursor_trapped = true;
+
+    weapon.initialize(audio_sys);
+}
+
+void Player::set_initial_model_properties(const cgp::mesh& base_mesh_data, const cgp::rotation_transform& initial_rotation_transform) {
+    initial_model_rotation = initial_rotation_transform; 
+    player_visual_model.initialize_data_on_gpu(base_mesh_data, cgp::mesh_drawable::default_shader, cgp::mesh_drawable::default_texture, cgp::mesh_drawable_vertex_layout::compact);
+    player_visual_model.model.set_scaling(0.9f);
+    model_placement = player_visual_model.model;
+    
+    
+    
+    
+}
+
+void Player::update(float dt, const cgp::inputs_keyboard_parameters& keyboard, const cgp::inputs_mouse_parameters& mouse, cgp::mat4& camera_view_matrix) {
+    if (is_dead) return; 
+
+    if (keyboard.is_pressed(GLFW_KEY_R)) {
+        weapon.reload();
+    }
+
+    last_input = input_from_keyboard(keyboard, mouse);
+    step(dt, last_input);
+
+    weapon.update(dt);
+
+    
+    float camera_forward_offset = 0.1f; 
+    camera.camera_model.position_camera = position + camera.camera_model.front() * camera_forward_offset;
+    camera_view_matrix = camera.camera_model.matrix_view();
+
+    
+    cgp::vec3 right_offset = camera.camera_model.right() * 0.2f; 
+    model_placement.translation = position + right_offset;
+    model_placement.translation.z -= 0.8f; 
+
+    model_placement.rotation = cgp::rotation_transform::from_axis_angle({0,0,1}, camera.camera_model.yaw);
+
+}
+
+PlayerInput Player::input_from_keyboard(const cgp::inputs_keyboard_parameters& keyboard, const cgp::inputs_mouse_parameters& mouse) const {
+    PlayerInput input;
+
+    cgp::vec3 forward = camera.camera_model.front();
+    cgp::vec3 right = camera.camera_model.right();
+
+    forward.z = 0;
+    right.z = 0;
+
+    if (cgp::norm(forward) > 0.01f) forward = cgp::normalize(forward);
+    if (cgp::norm(right) > 0.01f) right = cgp::normalize(right);
+
+    
+    if (keyboard.is_pressed(GLFW_KEY_W)) input.direction += forward;
+    if (keyboard.is_pressed(GLFW_KEY_S)) input.direction -= forward;
+    if (keyboard.is_pressed(GLFW_KEY_D)) input.direction += right;
+    if (keyboard.is_pressed(GLFW_KEY_A)) input.direction -= right;
+
+    
+    if (cgp::norm(input.direction) > 0.01f) {
+        input.direction = cgp::normalize(input.direction);
+    }
+
+    input.run = keyboard.shift;
+    input.jump = keyboard.is_pressed(GLFW_KEY_SPACE);
+    input.shoot = mouse.click.left;
+    return input;
+}
+
+void Player::handle_mouse_move(cgp::vec2 const& mouse_position_current, cgp::vec2 const& mouse_position_previous, cgp::mat4& camera_view_matrix) {
+    
+    camera.action_mouse_move(camera_view_matrix); 
+
+    
+    float& current_cam_pitch_rad = camera.camera_model.pitch; 
+
+    
+    
+    float local_max_pitch_up_rad = max_pitch_up * cgp::Pi / 180.0f;
+    float local_max_pitch_down_rad = max_pitch_down * cgp::Pi / 180.0f; 
+
+    current_cam_pitch_rad = cgp::clamp(current_cam_pitch_rad, local_max_pitch_down_rad, local_max_pitch_up_rad);
+
+    
+    camera_view_matrix = camera.camera_model.matrix_view();
+
+    
+}
+
+HitInfo Player::performShoot(const std::map<std::string, RemotePlayer>& remote_players, double render_time) {
+    shooting_flag = true; 
+    return weapon.shootWithHitDetection(*this, remote_players, render_time);
+}
+
+void Player::draw_model(cgp::render_queue_structure& queue, const cgp::environment_generic_structure& environment, const cgp::affine& placement) {
+    player_visual_model.model = placement;
+    queue.add(player_visual_model, environment);
+}
@@ -0,0 +1,74 @@
+#include "prediction.hpp"
+
+static size_t const max_pending_inputs = 256;         // Older inputs are forgotten if the server does not acknowledge them
+static float const position_tolerance = 0.01f;        // Prediction errors below this distance are not corrected
+static float const velocity_tolerance = 0.05f;
+
+uint32_t MovementPrediction::record(float dt, PlayerInput const& input, PlayerMovementState const& predicted) {
+    uint32_t const sequence = next_sequence++;
+    history.push_back({ sequence, dt, input, predicted });
+    if (history.size() > max_pending_inputs)
+        history.pop_front();
+    return sequence;
+}
+
+void MovementPrediction::receive_correction(uint32_t sequence, PlayerMovementState const& state) {
+    std::lock_guard<std::mutex> lock(correction_mutex);
+    // The messages of a WebSocket arrive in order, but a stale acknowledgment is ignored anyway
+    if (has_correction && sequence < correction_sequence) return;
+    has_correction = true;
+    correction_sequence = sequence;
+    correction_state = state;
+}
+
+void MovementPrediction::reconcile(Player& player) {
+    uint32_t sequence;
+    PlayerMovementState server_state;
+    {
+        std::lock_guard<std::mutex> lock(correction_mutex);
+        if (!has_correction) return;
+        has_correction = false;
+        sequence = correction_sequence;
+        server_state = correction_state;
+    }
+
+    // Drop the inputs processed by the server, keeping the prediction made for the acknowledged one
+    bool found = false;
+    PlayerMovementState predicted;
+    while (!history.empty() && history.front().sequence <= sequence) {
+        if (history.front().sequence == sequence) {
+            found = true;
+            predicted = history.front().predicted;
+        }
+        history.pop_front();
+        measures.acknowledged++;
+    }
+
+    // Without the prediction of this input (forgotten, or sent before a reset), the server state is taken as is
+    float const error = found ? cgp::norm(predicted.position - server_state.position) : 0.0f;
+    measures.last_error = error;
+    bool const diverged = !found || error > position_tolerance
+        || cgp::norm(predicted.velocity - server_state.velocity) > velocity_tolerance
+        || predicted.grounded != server_state.grounded;
+    if (!diverged) return;
+
+    // Rewind to the server state, then replay the inputs the server has not processed yet
+    measures.corrections++;
+    player.setMovementState(server_state);
+    for (PendingInput& pending : history) {
+        player.step(pending.dt, pending.input);
+        pending.predicted = player.getMovementState();
+    }
+}
+
+void MovementPrediction::reset() {
+    history.clear();
+    std::lock_guard<std::mutex> lock(correction_mutex);
+    has_correction = false;
+}
+
+MovementPrediction::Statistics MovementPrediction::statistics() const {
+    Statistics result = measures;
+    result.pending = history.size();
+    return result;
+}
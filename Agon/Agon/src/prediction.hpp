@@ -0,0 +1,54 @@
+#pragma once
+
+#include "player.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+// Client-side prediction of the local player with server reconciliation
+//  Each movement step of the local player is applied immediately with Player::step (no round-trip of latency), numbered, sent
+//  to the server as a sequenced INPUT, and kept with the predicted state after it. The server applies the same inputs with
+//  the same dt and answers with its authoritative state after the last input it processed (STATE message). The acknowledged
+//  inputs are then dropped, and if the prediction diverged (collision, respawn, lost or rejected input), the player is
+//  rewound to the server state and the pending inputs are replayed on top of it.
+class MovementPrediction {
+public:
+    // Number the input just applied by the client and keep it until the server acknowledges it (simulation thread)
+    uint32_t record(float dt, PlayerInput const& input, PlayerMovementState const& predicted);
+
+    // Authoritative state after the input `sequence` (from the network thread: applied by the next reconcile)
+    void receive_correction(uint32_t sequence, PlayerMovementState const& state);
+
+    // Apply the last received correction to the player (simulation thread, before the next step)
+    void reconcile(Player& player);
+
+    void reset();
+
+    // Measures since the start (simulation thread)
+    struct Statistics {
+        uint64_t acknowledged = 0;      // Inputs confirmed by the server
+        uint64_t corrections = 0;       // Rewinds because the prediction diverged
+        float last_error = 0.0f;        // Distance between the predicted and the server position at the last acknowledgment
+        size_t pending = 0;             // Inputs not yet acknowledged
+    };
+    Statistics statistics() const;
+
+private:
+    struct PendingInput {
+        uint32_t sequence;
+        float dt;
+        PlayerInput input;
+        PlayerMovementState predicted;  // State after the input
+    };
+
+    std::deque<PendingInput> history;   // Sent inputs not yet acknowledged, in order
+    uint32_t next_sequence = 1;
+    Statistics measures;
+
+    // Last correction received (written by the network thread)
+    mutable std::mutex correction_mutex;
+    bool has_correction = false;
+    uint32_t correction_sequence = 0;
+    PlayerMovementState correction_state;
+};
@@ -0,0 +1,102 @@
+#include "profiler.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+void ProfileTrack::push(ProfileEvent const& event) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (events.size() < capacity) {
+        events.push_back(event);
+        return;
+    }
+    events[next] = event;
+    next = (next + 1) % capacity;
+    wrapped = true;
+}
+
+void ProfileTrack::copy_events(std::vector<ProfileEvent>& events_out, int64_t start, int64_t end) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t const N = events.size();
+    size_t const first = wrapped ? next : 0;
+    for (size_t k = 0; k < N; ++k) {
+        ProfileEvent const& event = events[(first + k) % N];
+        if (end <= start || (event.end >= start && event.start <= end))
+            events_out.push_back(event);
+    }
+}
+
+
+static thread_local ProfileTrack* thread_track = nullptr;
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() {
+    gpu_track.name = "GPU";
+    gpu_track.index = 0;
+}
+
+int64_t Profiler::now() {
+    static auto const origin = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+ProfileTrack& Profiler::current_track() {
+    if (thread_track == nullptr) {
+        std::lock_guard<std::mutex> lock(tracks_mutex);
+        tracks.push_back(std::make_unique<ProfileTrack>());
+        thread_track = tracks.back().get();
+        thread_track->index = int(tracks.size());
+        thread_track->name = "Thread " + std::to_string(tracks.size());
+    }
+    return *thread_track;
+}
+
+void Profiler::set_thread_name(std::string const& name) {
+    ProfileTrack& track = current_track();
+    std::lock_guard<std::mutex> lock(tracks_mutex);
+    track.name = name;
+}
+
+int Profiler::begin_scope() {
+    return current_track().depth++;
+}
+
+void Profiler::end_scope(const char* name, int64_t start, int depth) {
+    ProfileTrack& track = current_track();
+    track.depth = depth;
+    track.push({ name, start, now(), depth });
+}
+
+bool Profiler::export_chrome_trace(std::string const& filename) const {
+    nlohmann::json trace_events = nlohmann::json::array();
+
+    std::vector<ProfileTrack const*> exported_tracks;
+    {
+        std::lock_guard<std::mutex> lock(tracks_mutex);
+        for (auto const& track : tracks) {
+            exported_tracks.push_back(track.get());
+            trace_events.push_back({ {"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", track->index}, {"args", {{"name", track->name}}} });
+        }
+    }
+    exported_tracks.push_back(&gpu_track);
+    trace_events.push_back({ {"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", gpu_track.index}, {"args", {{"name", gpu_track.name}}} });
+
+    std::vector<ProfileEvent> events;
+    for (ProfileTrack const* track : exported_tracks) {
+        events.clear();
+        track->copy_events(events);
+        for (ProfileEvent const& event : events) {
+            trace_events.push_back({ {"name", event.name}, {"ph", "X"}, {"pid", 1}, {"tid", track->index},
+                                     {"ts", event.start * 1e-3}, {"dur", (event.end - event.start) * 1e-3} });
+        }
+    }
+
+    std::ofstream file(filename);
+    if (!file) return false;
+    file << nlohmann::json{ {"traceEvents", trace_events}, {"displayTimeUnit", "ms"} }.dump() << std::endl;
+    return bool(file);
+}
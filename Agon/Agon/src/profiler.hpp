@@ -0,0 +1,152 @@
+#pragma once
+
+#include "cgp/cgp.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Timed scope (times in nanoseconds since the start of the program)
+struct ProfileEvent {
+    const char* name;   // String literal (never copied)
+    int64_t start;
+    int64_t end;
+    int depth;          // Nesting level in its track
+};
+
+// Events of one thread (or of the GPU) in a ring buffer keeping the last ones
+struct ProfileTrack {
+    std::string name;
+    int index = 0;      // Track id in the trace
+
+    // Add an event (the oldest one is overwritten when the buffer is full)
+    void push(ProfileEvent const& event);
+    // Copy the events overlapping [start, end], or all of them if end<=start, in the order of recording
+    void copy_events(std::vector<ProfileEvent>& events_out, int64_t start = 0, int64_t end = 0) const;
+
+    int depth = 0;      // Current nesting level (only used by the owner thread)
+
+    static size_t const capacity = 1 << 15;
+    std::vector<ProfileEvent> events;
+    size_t next = 0;
+    bool wrapped = false;
+    mutable std::mutex mutex; // The track is written by its thread, and read by the GUI and the export
+};
+
+// CPU/GPU frame profiler
+//  CPU: PROFILE_SCOPE("name") times the enclosing block on the current thread. The scopes can be nested, and every thread
+//       records in its own track. When the recording is disabled, a scope only costs the test of an atomic flag.
+//  GPU: GPU_PROFILE_SCOPE("name") also measures the GPU execution of the OpenGL commands of the block with timestamp queries
+//       (render thread only). The results are read a few frames later to never stall the pipeline.
+//  The last frame is displayed in an ImGui flame graph (one row per nesting level, one track per thread and one for the GPU),
+//  and the recorded events can be exported in the Chrome trace format (chrome://tracing, ui.perfetto.dev).
+class Profiler {
+public:
+    static Profiler& instance();
+
+    // Recording state (disabled by default)
+    std::atomic<bool> enabled{false};
+
+    static int64_t now();
+
+    // Name of the calling thread in the flame graph and in the trace
+    void set_thread_name(std::string const& name);
+
+    // To be called by the render thread at the start of each frame: marks the frame boundary and collects the available GPU timings
+    void begin_frame();
+
+    // Scopes (called by ProfileScope / GpuProfileScope)
+    int begin_scope();
+    void end_scope(const char* name, int64_t start, int depth);
+    int gpu_begin(const char* name);  // Returns the query index in the current frame (-1 if not recorded)
+    void gpu_end(int query_index);
+
+    // ImGui window with the flame graph of the last complete frame
+    void display_gui(bool* open);
+
+    // Write all the recorded events as a Chrome trace JSON file
+    bool export_chrome_trace(std::string const& filename) const;
+
+private:
+    Profiler();
+    ProfileTrack& current_track();
+    void collect_gpu_frame(int frame_slot);
+    void display_track(ProfileTrack const& track, std::string const& name, int64_t window_start, int64_t window_end);
+
+    // Tracks of the threads (never destroyed: a thread keeps a pointer to its track)
+    std::vector<std::unique_ptr<ProfileTrack>> tracks;
+    mutable std::mutex tracks_mutex;
+    ProfileTrack gpu_track;
+
+    // Timestamp queries of the last frames
+    struct GpuQuery {
+        const char* name;
+        int64_t cpu_start;   // The GPU event is displayed from the CPU time at which its commands were issued
+        GLuint query_begin = 0;
+        GLuint query_end = 0;
+        int depth;
+    };
+    static int const gpu_frame_latency = 4;
+    std::vector<GpuQuery> gpu_queries[gpu_frame_latency];
+    int gpu_queries_used[gpu_frame_latency] = {};
+    int gpu_frame_slot = 0;
+    int gpu_depth = 0;
+    int gpu_dropped = 0;     // Queries whose result was not yet available after gpu_frame_latency frames
+
+    // Start time of the last frames (the displayed frame is old enough to have its GPU timings)
+    std::vector<int64_t> frame_starts;
+    bool paused = false;
+    int64_t displayed_start = 0;
+    int64_t displayed_end = 0;
+
+    char export_filename[256] = "agon_trace.json";
+    std::string export_status;
+};
+
+// Time the enclosing scope on the calling thread
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name_arg)
+        : name(name_arg), active(Profiler::instance().enabled.load(std::memory_order_relaxed))
+    {
+        if (active) {
+            depth = Profiler::instance().begin_scope();
+            start = Profiler::now();
+        }
+    }
+    ~ProfileScope() {
+        if (active) Profiler::instance().end_scope(name, start, depth);
+    }
+    ProfileScope(ProfileScope const&) = delete;
+    ProfileScope& operator=(ProfileScope const&) = delete;
+
+private:
+    const char* name;
+    bool active;
+    int depth = 0;
+    int64_t start = 0;
+};
+
+// Time the enclosing scope on the CPU, and its OpenGL commands on the GPU
+class GpuProfileScope {
+public:
+    explicit GpuProfileScope(const char* name)
+        : cpu_scope(name), query_index(Profiler::instance().enabled.load(std::memory_order_relaxed) ? Profiler::instance().gpu_begin(name) : -1)
+    {}
+    ~GpuProfileScope() {
+        if (query_index >= 0) Profiler::instance().gpu_end(query_index);
+    }
+    GpuProfileScope(GpuProfileScope const&) = delete;
+    GpuProfileScope& operator=(GpuProfileScope const&) = delete;
+
+private:
+    ProfileScope cpu_scope;
+    int query_index;
+};
+
+#define PROFILE_CONCATENATE_DETAIL(a, b) a##b
+#define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE_DETAIL(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCATENATE(profile_scope_, __LINE__)(name)
+#define GPU_PROFILE_SCOPE(name) GpuProfileScope PROFILE_CONCATENATE(gpu_profile_scope_, __LINE__)(name)
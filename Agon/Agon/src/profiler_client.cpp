@@ -0,0 +1,158 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <string>
+
+// GPU timings and flame graph of the profiler, only used by the game client (the recording of the CPU scopes is in profiler.cpp)
+
+int Profiler::gpu_begin(const char* name) {
+#ifndef __EMSCRIPTEN__
+    std::vector<GpuQuery>& queries = gpu_queries[gpu_frame_slot];
+    int& used = gpu_queries_used[gpu_frame_slot];
+    if (used == int(queries.size())) {
+        GpuQuery query;
+        glGenQueries(1, &query.query_begin);
+        glGenQueries(1, &query.query_end);
+        queries.push_back(query);
+    }
+    GpuQuery& query = queries[used];
+    query.name = name;
+    query.cpu_start = now();
+    query.depth = gpu_depth++;
+    glQueryCounter(query.query_begin, GL_TIMESTAMP);
+    return used++;
+#else
+    // No timestamp queries in WebGL
+    (void)name;
+    return -1;
+#endif
+}
+
+void Profiler::gpu_end(int query_index) {
+#ifndef __EMSCRIPTEN__
+    glQueryCounter(gpu_queries[gpu_frame_slot][query_index].query_end, GL_TIMESTAMP);
+    gpu_depth--;
+#else
+    (void)query_index;
+#endif
+}
+
+void Profiler::collect_gpu_frame(int frame_slot) {
+#ifndef __EMSCRIPTEN__
+    for (int k = 0; k < gpu_queries_used[frame_slot]; ++k) {
+        GpuQuery const& query = gpu_queries[frame_slot][k];
+        GLint available = 0;
+        glGetQueryObjectiv(query.query_end, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == 0) {
+            gpu_dropped++;
+            continue;
+        }
+        GLuint64 time_begin = 0, time_end = 0;
+        glGetQueryObjectui64v(query.query_begin, GL_QUERY_RESULT, &time_begin);
+        glGetQueryObjectui64v(query.query_end, GL_QUERY_RESULT, &time_end);
+        gpu_track.push({ query.name, query.cpu_start, query.cpu_start + int64_t(time_end - time_begin), query.depth });
+    }
+#endif
+    gpu_queries_used[frame_slot] = 0;
+}
+
+void Profiler::begin_frame() {
+    // The slot reused by this frame holds the queries issued gpu_frame_latency frames ago
+    gpu_frame_slot = (gpu_frame_slot + 1) % gpu_frame_latency;
+    collect_gpu_frame(gpu_frame_slot);
+    gpu_depth = 0;
+
+    frame_starts.push_back(now());
+    if (frame_starts.size() > size_t(gpu_frame_latency + 2))
+        frame_starts.erase(frame_starts.begin());
+    if (!paused && frame_starts.size() == size_t(gpu_frame_latency + 2)) {
+        displayed_start = frame_starts[0];
+        displayed_end = frame_starts[1];
+    }
+}
+
+
+// Stable color per scope name
+static ImU32 event_color(const char* name) {
+    size_t const h = std::hash<std::string>()(name);
+    int const r = 90 + int(h % 120);
+    int const g = 90 + int((h / 120) % 120);
+    int const b = 90 + int((h / 14400) % 120);
+    return IM_COL32(r, g, b, 255);
+}
+
+void Profiler::display_track(ProfileTrack const& track, std::string const& name, int64_t window_start, int64_t window_end) {
+    std::vector<ProfileEvent> events;
+    track.copy_events(events, window_start, window_end);
+
+    int max_depth = 0;
+    for (ProfileEvent const& event : events)
+        max_depth = std::max(max_depth, event.depth);
+
+    ImGui::Text("%s", name.c_str());
+    float const row_height = ImGui::GetTextLineHeight() + 4.0f;
+    ImVec2 const origin = ImGui::GetCursorScreenPos();
+    float const width = std::max(ImGui::GetContentRegionAvail().x, 100.0f);
+    float const height = (max_depth + 1) * row_height;
+    ImGui::PushID(track.index);
+    ImGui::InvisibleButton("##track", ImVec2(width, height));
+    ImGui::PopID();
+
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    double const scale = width / double(window_end - window_start);
+    for (ProfileEvent const& event : events) {
+        float const x0 = origin.x + float(std::max<int64_t>(event.start - window_start, 0) * scale);
+        float const x1 = origin.x + float(std::min<int64_t>(event.end - window_start, window_end - window_start) * scale);
+        float const y0 = origin.y + event.depth * row_height;
+        ImVec2 const p0(x0, y0), p1(std::max(x1, x0 + 1.0f), y0 + row_height - 1.0f);
+
+        draw_list->AddRectFilled(p0, p1, event_color(event.name));
+        if (x1 - x0 > 30.0f) {
+            draw_list->PushClipRect(p0, p1, true);
+            draw_list->AddText(ImVec2(x0 + 2.0f, y0 + 2.0f), IM_COL32(0, 0, 0, 255), event.name);
+            draw_list->PopClipRect();
+        }
+        if (ImGui::IsMouseHoveringRect(p0, p1))
+            ImGui::SetTooltip("%s: %.3f ms", event.name, (event.end - event.start) * 1e-6);
+    }
+}
+
+void Profiler::display_gui(bool* open) {
+    ImGui::SetNextWindowSize(ImVec2(700, 400), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Profiler", open)) {
+        ImGui::End();
+        return;
+    }
+
+    bool is_enabled = enabled;
+    if (ImGui::Checkbox("Record", &is_enabled))
+        enabled = is_enabled;
+    ImGui::SameLine();
+    ImGui::Checkbox("Pause", &paused);
+
+    ImGui::InputText("##export_filename", export_filename, sizeof(export_filename));
+    ImGui::SameLine();
+    if (ImGui::Button("Export Chrome trace"))
+        export_status = export_chrome_trace(export_filename) ? std::string("Written ") + export_filename : std::string("Cannot write ") + export_filename;
+    if (!export_status.empty())
+        ImGui::Text("%s", export_status.c_str());
+
+    if (displayed_end > displayed_start) {
+        ImGui::Text("Frame: %.3f ms (GPU queries dropped: %d)", (displayed_end - displayed_start) * 1e-6, gpu_dropped);
+        ImGui::Separator();
+
+        // The names are copied under the lock (a thread can rename its track at any time)
+        std::vector<std::pair<ProfileTrack const*, std::string>> displayed_tracks;
+        {
+            std::lock_guard<std::mutex> lock(tracks_mutex);
+            for (auto const& track : tracks)
+                displayed_tracks.push_back({ track.get(), track->name });
+        }
+        displayed_tracks.push_back({ &gpu_track, gpu_track.name });
+        for (auto const& track : displayed_tracks)
+            display_track(*track.first, track.second, displayed_start, displayed_end);
+    }
+
+    ImGui::End();
+}
@@ -1,79 +1,87 @@
 #pragma once
 
 #include "cgp/cgp.hpp"
+#include <algorithm>
 #include <cmath> 
+#include <deque>
 #include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Model shared by all the remote players: the full mesh and its levels of detail, built and uploaded to the GPU once
+struct RemotePlayerModel {
+    // Levels of detail of the model: level 0 is drawable, the coarser levels are in lod_drawable
+    cgp::mesh_drawable drawable;
+    std::vector<cgp::mesh_drawable> lod_drawable;
+    float bounding_radius = 1.0f;
+
+    // Minimal height on screen (relative to the viewport height) to use each level of detail
+    static cgp::numarray<float> const& lod_screen_size_threshold() {
+        static cgp::numarray<float> const threshold = { 0.30f, 0.15f, 0.07f };
+        return threshold;
+    }
+
+    // Build the simplified versions of the model for the distant players, then upload all the levels (OpenGL thread)
+    void initialize_data_on_gpu(cgp::mesh const& mesh_shape) {
+        if (mesh_shape.position.size() == 0) {
+            std::cerr << "ERROR: Remote player mesh has no vertices, cannot initialize on GPU" << std::endl;
+            return;
+        }
+
+        cgp::numarray<cgp::mesh> const lod = cgp::mesh_lod_chain(mesh_shape, int(lod_screen_size_threshold().size()) + 1);
+        bounding_radius = 0.0f;
+        for (cgp::vec3 const& p : mesh_shape.position)
+            bounding_radius = std::max(bounding_radius, cgp::norm(p));
+
+        drawable.initialize_data_on_gpu(mesh_shape, cgp::mesh_drawable::default_shader, cgp::mesh_drawable::default_texture, cgp::mesh_drawable_vertex_layout::compact);
+        lod_drawable.clear();
+        for (int k = 1; k < lod.size(); ++k) {
+            lod_drawable.push_back(cgp::mesh_drawable());
+            lod_drawable.back().initialize_data_on_gpu(lod[k], cgp::mesh_drawable::default_shader, cgp::mesh_drawable::default_texture, cgp::mesh_drawable_vertex_layout::compact);
+            std::cout << "  LOD " << k << ": " << lod[k].connectivity.size() << " triangles (full: " << mesh_shape.connectivity.size() << ")" << std::endl;
+        }
+    }
+
+    bool initialized() const { return drawable.vao != 0; }
+
+    // Level of detail to use given the size of the model on screen (0 is the full model)
+    int select_lod(cgp::mat4 const& camera_view, cgp::mat4 const& camera_projection, cgp::affine const& model_placement) const {
+        float const radius = bounding_radius * model_placement.scaling;
+        float const screen_size = cgp::mesh_lod_screen_size(model_placement.translation, radius, camera_view, camera_projection);
+        return std::min(cgp::mesh_lod_select(screen_size, lod_screen_size_threshold()), int(lod_drawable.size()));
+    }
+
+    cgp::mesh_drawable const& level(int lod) const { return lod == 0 ? drawable : lod_drawable[lod - 1]; }
+};
 
 struct RemotePlayer {
     cgp::vec3 position;
     cgp::rotation_transform orientation;
-    cgp::mesh_drawable model_drawable;
+    std::shared_ptr<RemotePlayerModel const> model; // Shared with the other remote players (see scene_structure::remote_player_model)
+    cgp::affine placement; // Placement received from the network: written by update_state only, the model is drawn at the placement of the render snapshot
     cgp::rotation_transform initial_model_rotation;
-    bool initialized_on_gpu;
-    cgp::mesh stored_mesh;
+
+    // Placements stamped with the server time of their tick (SNAPSHOT), in increasing time, to be interpolated at the render time
+    std::deque<std::pair<double, cgp::affine>> timed_placement;
+
+    // Number of stamped states kept (about 1 s of snapshots at the default tick rate)
+    static constexpr size_t max_timed_placement = 32;
+
+    // The model is lowered from the eye position to match the ground level of the local player
+    static constexpr float model_height_offset = 0.8f;
 
     RemotePlayer()
         : position({0,0,0}), 
           orientation(), 
-          initial_model_rotation(cgp::rotation_transform::from_axis_angle({1,0,0}, cgp::Pi/2.0f) * cgp::rotation_transform::from_axis_angle({0,0,1}, cgp::Pi)),
-          initialized_on_gpu(false)
-    {}
-
-    void store_mesh_data(cgp::mesh const& mesh_shape) {
-        // Just store the mesh data, don't initialize on GPU yet
-        stored_mesh = mesh_shape;
-        std::cout << "Stored mesh data for remote player (vertices: " << mesh_shape.position.size() << ")" << std::endl;
-    }
-
-    void initialize_data_on_gpu_if_needed() {
-        if (initialized_on_gpu) return;
-        
-        try {
-            std::cout << "RemotePlayer::initialize_data_on_gpu_if_needed called" << std::endl;
-            
-            // Validate mesh data before GPU upload
-            if (stored_mesh.position.size() == 0) {
-                std::cerr << "ERROR: Stored mesh has no vertices, cannot initialize on GPU" << std::endl;
-                return;
-            }
-            
-            std::cout << "Mesh validation passed, calling model_drawable.initialize_data_on_gpu" << std::endl;
-            model_drawable.initialize_data_on_gpu(stored_mesh);
-            model_drawable.model.set_scaling(1.25f);
-            model_drawable.model.translation.z -= 0.8f; 
-            initialized_on_gpu = true;
-            std::cout << "model_drawable.initialize_data_on_gpu completed successfully" << std::endl;
-            
-        } catch (const std::exception& e) {
-            std::cerr << "Exception in RemotePlayer::initialize_data_on_gpu_if_needed: " << e.what() << std::endl;
-        } catch (...) {
-            std::cerr << "Unknown exception in RemotePlayer::initialize_data_on_gpu_if_needed" << std::endl;
-        }
-    }
-
-    void initialize_data_on_gpu(cgp::mesh const& mesh_shape) {
-        try {
-            std::cout << "RemotePlayer::initialize_data_on_gpu called" << std::endl;
-            
-            // Validate mesh data before GPU upload
-            if (mesh_shape.position.size() == 0) {
-                std::cerr << "ERROR: Mesh has no vertices, cannot initialize on GPU" << std::endl;
-                return;
-            }
-            
-            std::cout << "Mesh validation passed, calling model_drawable.initialize_data_on_gpu" << std::endl;
-            model_drawable.initialize_data_on_gpu(mesh_shape);
-            initialized_on_gpu = true;
-            std::cout << "model_drawable.initialize_data_on_gpu completed successfully" << std::endl;
-            
-        } catch (const std::exception& e) {
-            std::cerr << "Exception in RemotePlayer::initialize_data_on_gpu: " << e.what() << std::endl;
-        } catch (...) {
-            std::cerr << "Unknown exception in RemotePlayer::initialize_data_on_gpu" << std::endl;
-        }
+          initial_model_rotation(cgp::rotation_transform::from_axis_angle({1,0,0}, cgp::Pi/2.0f) * cgp::rotation_transform::from_axis_angle({0,0,1}, cgp::Pi))
+    {
+        placement.set_scaling(1.25f);
+        placement.translation.z -= model_height_offset;
     }
 
-    void update_state(const cgp::vec3& position_arg, const cgp::mat4& aim_direction_matrix_arg) {
+    // server_time: time of the tick of the state in ms (negative if the message is not stamped: the state is displayed at once)
+    void update_state(const cgp::vec3& position_arg, const cgp::mat4& aim_direction_matrix_arg, double server_time = -1.0) {
         position = position_arg;
         
         // Validate position values
@@ -130,30 +138,67 @@ struct RemotePlayer {
             orientation = cgp::rotation_transform();
         }
         
-        // Update the model transform safely
+        // Update the model placement safely
         try {
-            model_drawable.model.translation = position;
-            model_drawable.model.translation.z -= 0.8f; // Lower the remote player to match local player ground level
-            model_drawable.model.rotation = orientation;
+            placement.translation = position;
+            placement.translation.z -= model_height_offset; // Lower the remote player to match local player ground level
+            placement.rotation = orientation;
         } catch (const std::exception& e) {
             std::cerr << "Exception setting model transform in RemotePlayer::update_state: " << e.what() << std::endl;
         } 
         // The model rotation now uses direct matrix rotation extraction for unlimited rotation
-    }
 
-    void draw(cgp::environment_generic_structure const& environment) const {
-        // Try to initialize GPU data if not already done (const_cast is safe here for deferred initialization)
-        const_cast<RemotePlayer*>(this)->initialize_data_on_gpu_if_needed();
-        
-        // Only draw if properly initialized on GPU
-        if (initialized_on_gpu) {
-            try {
-                cgp::draw(model_drawable, environment);
-            } catch (const std::exception& e) {
-                std::cerr << "Exception in RemotePlayer::draw: " << e.what() << std::endl;
-            } catch (...) {
-                std::cerr << "Unknown exception in RemotePlayer::draw" << std::endl;
-            }
+        if (server_time < 0.0) {
+            timed_placement.clear();
+            return;
         }
+        // A state older than the last one arrived late (UDP): it is already out of date
+        if (!timed_placement.empty() && server_time <= timed_placement.back().first)
+            return;
+        timed_placement.emplace_back(server_time, placement);
+        if (timed_placement.size() > max_timed_placement)
+            timed_placement.pop_front();
+    }
+
+    // Placement to display at the given server time: interpolated between the two stamped states around it, or the
+    //  closest one outside of the buffer (no extrapolation)
+    cgp::affine placement_at(double render_time) const {
+        if (timed_placement.empty())
+            return placement;
+        size_t k = 0;
+        while (k + 2 < timed_placement.size() && timed_placement[k + 1].first <= render_time)
+            ++k;
+
+        std::pair<double, cgp::affine> const& first = timed_placement[k];
+        if (render_time <= first.first || timed_placement.size() == 1)
+            return first.second;
+        std::pair<double, cgp::affine> const& second = timed_placement[k + 1];
+        if (render_time >= second.first)
+            return second.second;
+
+        float const alpha = float((render_time - first.first) / (second.first - first.first));
+        cgp::affine interpolated = first.second;
+        interpolated.translation = (1.0f - alpha) * first.second.translation + alpha * second.second.translation;
+        interpolated.rotation = cgp::rotation_transform::lerp(first.second.rotation, second.second.rotation, alpha);
+        return interpolated;
+    }
+
+    // Eye position of the player as displayed at the given server time (negative: the last received position),
+    //  used by the hit detection so that the shots are tested where the player is drawn
+    cgp::vec3 position_at(double render_time) const {
+        if (render_time < 0.0)
+            return position;
+        cgp::vec3 displayed = placement_at(render_time).translation;
+        displayed.z += model_height_offset;
+        return displayed;
+    }
+
+    // Add the level of detail to the render queue at the placement given by the render snapshot (called with the remote players lock held)
+    //  The shared model is left untouched: the placement is given to the render queue
+    void draw(cgp::render_queue_structure& queue, cgp::environment_generic_structure const& environment, cgp::mat4 const& camera_view, cgp::mat4 const& camera_projection, cgp::affine const& snapshot_placement) const {
+        if (model == nullptr || !model->initialized()) return;
+
+        int const lod = model->select_lod(camera_view, camera_projection, snapshot_placement);
+        queue.add(model->level(lod), snapshot_placement, environment);
     }
 };
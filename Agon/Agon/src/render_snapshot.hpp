@@ -0,0 +1,55 @@
+#pragma once
+
+#include "cgp/cgp.hpp"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Placement of a remote player at the time of the snapshot
+struct RemotePlayerSnapshot {
+    std::string username;
+    cgp::affine model;
+};
+
+// Everything the render thread needs from the simulation for one frame
+//  Written by the simulation thread only, and never modified once published
+struct RenderSnapshot {
+    uint64_t step = 0; // Index of the simulation step that produced the snapshot (0 = nothing published yet)
+
+    cgp::mat4 camera_view;
+    cgp::vec3 light;
+
+    cgp::affine player_model; // Placement of the local player model
+    std::vector<RemotePlayerSnapshot> remote_players;
+
+    bool fps_mode = true;
+    bool cursor_mode = false;
+    bool capture_cursor = false; // Camera modes driven by the mouse (the cursor is hidden)
+};
+
+// Double buffer between the simulation thread (single writer) and the render thread (single reader)
+//  The writer fills back() without any lock, then publish() swaps the buffers.
+//  The reader copies the front buffer (the lock only covers the copy and the swap, never the simulation or the rendering).
+class RenderSnapshotBuffer {
+public:
+    // Buffer being written by the simulation thread
+    RenderSnapshot& back() { return buffer[1 - front_index]; }
+
+    // Make the back buffer visible to the reader
+    void publish() {
+        std::lock_guard<std::mutex> lock(mutex);
+        front_index = 1 - front_index;
+    }
+
+    // Copy the last published snapshot (the assignment reuses the memory of the destination)
+    void read(RenderSnapshot& snapshot) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot = buffer[front_index];
+    }
+
+private:
+    RenderSnapshot buffer[2];
+    int front_index = 0;
+    mutable std::mutex mutex;
+};
@@ -1,4 +1,5 @@
 #include "scene.hpp"
+#include <cstdlib>
 
 
 using namespace cgp;
@@ -37,16 +38,18 @@ void scene_structure::initialize()
     // Setup WebSocket message handlers
     setupWebSocketHandlers();
 
-    apartment.initialize();
+    apartment.initialize(texture_loader);
 
     player.initialise(inputs, window, &audio_system);
     player.set_apartment(&apartment);
 
     spectator.initialise(inputs, window);
     spectator.set_apartment(&apartment);
+    // Model of the players: optimized for the GPU once, when its binary cache is baked (assets/man.obj.bin), then loaded from the cache
+    cgp::mesh const man_mesh = mesh_load_file_obj_optimized("assets/man.obj"); // Also generates the missing normals and UVs
+
     // Initialize player model data
-    cgp::mesh player_mesh_data = cgp::mesh_load_file_obj("assets/man.obj");
-    player_mesh_data.fill_empty_field(); // Fix mesh validation by generating missing normals and UVs
+    cgp::mesh player_mesh_data = man_mesh;
     player_mesh_data.centered();
     // Rotate the mesh to be upright. Assuming model is oriented along Y and needs to be pitched up.
     player_mesh_data.rotate({1, 0, 0}, cgp::Pi / 2.0f); 
@@ -59,8 +62,7 @@ void scene_structure::initialize()
     player.set_initial_model_properties(player_mesh_data, player_initial_base_rotation);
 
     // The mesh_obj and obj_man below are for a separate model, possibly for debugging or other scene elements.
-    mesh_obj = mesh_load_file_obj("assets/man.obj");
-    mesh_obj.fill_empty_field(); // Fix mesh validation by generating missing normals and UVs
+    mesh_obj = man_mesh;
 
     mesh_obj.centered();
     mesh_obj.scale(0.16f);
@@ -68,6 +70,16 @@ void scene_structure::initialize()
 
     obj_man.initialize_data_on_gpu(mesh_obj);
 
+    // Remote player model: the levels of detail are built once here, not for each player joining the game
+    cgp::mesh remote_player_mesh_data = man_mesh;
+    remote_player_mesh_data.centered();
+    remote_player_mesh_data.scale(0.7f);
+    remote_player_mesh_data.rotate({1, 0, 0}, cgp::Pi / 2.0f);
+    remote_player_mesh_data.rotate({0, 0, 1}, cgp::Pi); // Face forward
+    std::shared_ptr<RemotePlayerModel> model = std::make_shared<RemotePlayerModel>();
+    model->initialize_data_on_gpu(remote_player_mesh_data);
+    remote_player_model = model;
+
     // Initialize crosshair
     crosshair.initialize();
 
@@ -189,7 +201,10 @@ void scene_structure::setupWebSocketHandlers() {
                         std::cout << "Received direct health update: " << healthValue << std::endl;
                         
                         // Server sends absolute health value, set player HP directly
-                        player.setHP(healthValue);
+                        {
+                            std::lock_guard<std::mutex> simulation_lock(simulation_mutex);
+                            player.setHP(healthValue);
+                        }
                         std::cout << "Player health set to: " << player.getHP() << " HP" << std::endl;
                         
                         return; // Health updates don't need further processing
@@ -235,7 +250,10 @@ void scene_structure::setupWebSocketHandlers() {
                         std::cout << "Received health update: " << healthValue << std::endl;
                         
                         // Server sends absolute health value, set player HP directly
-                        player.setHP(healthValue);
+                        {
+                            std::lock_guard<std::mutex> simulation_lock(simulation_mutex);
+                            player.setHP(healthValue);
+                        }
                         std::cout << "Player health set to: " << player.getHP() << " HP" << std::endl;
                         
                         return; // Health updates don't need further processing
@@ -363,12 +381,9 @@ void scene_structure::setupWebSocketHandlers() {
                     return;
                 }
 
-                // Lock before accessing remote_players map - use try_lock to avoid deadlocks
-                std::unique_lock<std::mutex> lock(remote_players_mutex, std::try_to_lock);
-                if (!lock.owns_lock()) {
-                    std::cerr << "Could not acquire lock for remote_players - skipping update" << std::endl;
-                    return;
-                }
+                // Lock before accessing remote_players map. The state is never dropped: the server sends each change
+                //  only once, a skipped state would leave the player at a stale position until it moves again
+                std::lock_guard<std::mutex> lock(remote_players_mutex);
 
                 // Check if player exists, if not, create and initialize
                 auto it = remote_players.find(remote_username);
@@ -376,41 +391,9 @@ void scene_structure::setupWebSocketHandlers() {
                     try {
                         std::cout << "Creating new remote player: " << remote_username << std::endl;
                         
-                        // Create new remote player with very defensive approach
+                        // The new player shares the model loaded in initialize: only its placement is its own
                         RemotePlayer new_player;
-                        
-                        // Try to initialize with the mesh, but if it fails, skip this update
-                        try {
-                            cgp::mesh remote_player_mesh_data = cgp::mesh_load_file_obj("assets/man.obj");
-                            remote_player_mesh_data.fill_empty_field(); // Fix mesh validation by generating missing normals and UVs
-                            if (remote_player_mesh_data.position.size() == 0) {
-                                std::cerr << "Error: Loaded mesh is empty for remote player " << remote_username << std::endl;
-                                return;
-                            }
-                            
-                            remote_player_mesh_data.centered();
-                            remote_player_mesh_data.scale(0.7f);
-                            remote_player_mesh_data.rotate({1, 0, 0}, cgp::Pi / 2.0f); 
-                            remote_player_mesh_data.rotate({0, 0, 1}, cgp::Pi); // Face forward
-                            
-                            std::cout << "About to store mesh data for: " << remote_username << std::endl;
-                            std::cout << "Mesh has " << remote_player_mesh_data.position.size() << " vertices" << std::endl;
-                            
-                            // Instead of initializing on GPU immediately, store the mesh data
-                            // GPU initialization will happen later during the render loop
-                            new_player.store_mesh_data(remote_player_mesh_data);
-                            std::cout << "Mesh data stored for: " << remote_username << std::endl;
-                            
-                            std::cout << "About to set scaling for: " << remote_username << std::endl;
-                            std::cout << "Scaling set for: " << remote_username << std::endl;
-                            
-                            std::cout << "Successfully initialized mesh for remote player: " << remote_username << std::endl;
-                        } catch (const std::exception& mesh_e) {
-                            std::cerr << "Error initializing mesh for remote player " << remote_username << ": " << mesh_e.what() << std::endl;
-                            return; // Skip this update if mesh loading fails
-                        }
-                        
-                        // Insert the new player only if mesh initialization succeeded
+                        new_player.model = remote_player_model;
                         remote_players[remote_username] = std::move(new_player);
                         remote_player_usernames.push_back(remote_username);
                         std::cout << "Successfully created new remote player: " << remote_username << std::endl;
@@ -426,7 +409,9 @@ void scene_structure::setupWebSocketHandlers() {
                 if (player_it != remote_players.end()) {
                     try {
                         std::cout << "Updating state for remote player: " << remote_username << std::endl;
-                        player_it->second.update_state(remote_position, remote_aim_matrix);
+                        // Server time of the tick of a state coming from a SNAPSHOT (interpolated at the render time)
+                        double const remote_time = msg_json.contains("time") && msg_json["time"].is_number() ? msg_json["time"].get<double>() : -1.0;
+                        player_it->second.update_state(remote_position, remote_aim_matrix, remote_time);
                         
                         // Update footstep audio for remote player
                         if (footstep_manager) {
@@ -468,6 +453,27 @@ void scene_structure::setupWebSocketHandlers() {
             }
         });
 
+    // Handler for STATE messages (state of the local player computed by the server, to reconcile the prediction)
+    APIService::getInstance().registerWebSocketHandler(
+        WebSocketMessageType::STATE,
+        [this](const nlohmann::json& msg_json) {
+            try {
+                const nlohmann::json& content = msg_json.at("content");
+                auto read_vec3 = [](const nlohmann::json& value) {
+                    return cgp::vec3(value.at("x").get<float>(), value.at("y").get<float>(), value.at("z").get<float>());
+                };
+                PlayerMovementState state;
+                state.position = read_vec3(content.at("position"));
+                state.velocity = read_vec3(content.at("velocity"));
+                state.vertical_velocity = content.value("verticalVelocity", 0.0f);
+                state.grounded = content.value("grounded", true);
+                // Applied by the simulation thread before its next step
+                movement_prediction.receive_correction(content.at("sequence").get<uint32_t>(), state);
+            } catch (const std::exception& e) {
+                std::cerr << "Error in scene's STATE handler: " << e.what() << std::endl;
+            }
+        });
+
 
     std::cout << "Scene WebSocket handlers registered with APIService." << std::endl;
 }
@@ -507,6 +513,12 @@ void scene_structure::sendChatMessage(const std::string& message) {
 
 void scene_structure::display_frame()
 {
+    PROFILE_SCOPE("display_frame");
+    frame_statistics = cgp::render_queue_structure::statistics_structure();
+
+    // Upload the textures decoded in the background (limited amount of data per frame)
+    texture_loader.update();
+
     if(current_state == GameState::LOGIN){
         login_ui.render(environment);
 
@@ -515,7 +527,9 @@ void scene_structure::display_frame()
             std::cout << "Auth token: " << auth_token << std::endl;
             
             // Connect to WebSocket server using WebSocketService directly
-            std::string ws_url = "ws://10.42.229.253:4500/ws";
+            //  AGON_SERVER_URL selects another server (e.g. ws://localhost:4500/ws for the local agon_server)
+            char const* server_url = std::getenv("AGON_SERVER_URL");
+            std::string ws_url = server_url != nullptr ? server_url : "ws://10.42.229.253:4500/ws";
             if (WebSocketService::getInstance().connect(ws_url, auth_token, login_ui.get_roomid())) {
                 std::cout << "Connected to WebSocket server successfully" << std::endl;
                 roomID = login_ui.get_roomid();
@@ -525,9 +539,16 @@ void scene_structure::display_frame()
         }
 
         if(WebSocketService::getInstance().isConnected() || login_ui.get_email() == "admin"){
+            std::lock_guard<std::mutex> lock(simulation_mutex);
             current_state = GameState::MAIN_GAME;
             login_ui.reset_login_clicked();
             username = login_ui.get_username();
+            movement_prediction.reset();
+            APIService::getInstance().networkClock().reset();
+            // Identifies the local player in a network recording (--record)
+            WebSocketService::getInstance().recordInfo(nlohmann::json{ {"username", username}, {"roomId", roomID} }.dump());
+            if (udp_enabled && WebSocketService::getInstance().isConnected())
+                WebSocketService::getInstance().requestUdp();
             
             // We don't need to send a join notification, the server will broadcast it
             // automatically when we connect to the WebSocket
@@ -556,10 +577,14 @@ void scene_structure::display_frame()
             model_needs_update = false;
         }
 
+        // Everything below is drawn from the last state published by the simulation
+        render_snapshots.read(render_snapshot);
+        if (render_snapshot.step == 0) {
+            return; // No simulation step has run yet
+        }
 
-        // Update the camera view based on the current mode
-        // If in cursor mode, maintain current camera view and make sure cursor is visible
-        if (cursor_mode) {
+        // If in cursor mode, the cursor is visible and the camera is kept fixed by the simulation
+        if (render_snapshot.cursor_mode) {
             glfwSetInputMode(window.glfw_window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
             
                 // For macOS, ensure the cursor is visible by positioning it
@@ -568,86 +593,159 @@ void scene_structure::display_frame()
                 glfwSetCursorPos(window.glfw_window, window.width/2, window.height/2);
                 first_cursor_mode_frame = false;
             }
-        
-            // Do not update camera view to keep it fixed when in cursor mode
-            // environment.camera_view remains at its last value
         }
-        // Not in cursor mode, apply normal camera logic
-        else if (fps_mode) {
-            // Use player's camera view
+        else if (render_snapshot.capture_cursor) {
             glfwSetInputMode(window.glfw_window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-            environment.camera_view = player.camera.camera_model.matrix_view();
         }
-        else if (spectator_mode) {
-            glfwSetInputMode(window.glfw_window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-            environment.camera_view = spectator.camera.camera_model.matrix_view();
+
+        environment.set_camera_view(render_snapshot.camera_view);
+        environment.light = render_snapshot.light;
+
+        // Opaque elements of the scene are gathered in the render queue, and drawn sorted by state
+        //  (one submit per pass to measure them separately in the profiler)
+        {
+            GPU_PROFILE_SCOPE("apartment");
+            apartment.draw(render_queue, environment);
+            render_queue.submit();
+            frame_statistics += render_queue.statistics;
         }
-        else if (follow_player_mode) {
-            glfwSetInputMode(window.glfw_window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-            std::lock_guard<std::mutex> lock(remote_players_mutex);
 
-            if (!remote_player_usernames.empty() && current_followed_index >= 0 && current_followed_index < static_cast<int>(remote_player_usernames.size())) {
-                const std::string& target_username = remote_player_usernames[current_followed_index];
-                auto it = remote_players.find(target_username);
-                if (it != remote_players.end()) {
-                    const RemotePlayer& target = it->second;
-                    // Copier la position et la rotation de la caméra du joueur suivi
-                    spectator.camera.camera_model.position_camera = target.position + cgp::vec3(0, -5.0f, 1.9f);
-                    cgp::vec3 front_direction = target.orientation * cgp::vec3(0, 1, 0); 
-                    spectator.camera.camera_model.look_at(
-                    target.position, 
-                    target.position + front_direction
-                );
-
-                    environment.camera_view = spectator.camera.camera_model.matrix_view();
+        {
+            GPU_PROFILE_SCOPE("players");
+
+            // Draw the local player's model
+            // Model is now always drawn, visible in both FPS and free-camera/orbit mode.
+            player.draw_model(render_queue, environment, render_snapshot.player_model);
+
+            // Draw remote players (the lock only protects the GPU data of the map, the placements come from the snapshot)
+            {
+                std::lock_guard<std::mutex> lock(remote_players_mutex);
+                for (RemotePlayerSnapshot const& remote_snapshot : render_snapshot.remote_players) {
+                    auto it = remote_players.find(remote_snapshot.username);
+                    if (it != remote_players.end()) {
+                        it->second.draw(render_queue, environment, environment.camera_view, environment.camera_projection, remote_snapshot.model);
+                    }
                 }
             }
-        }
-        else {
-            // Use orbit camera view
-            environment.camera_view = camera_control.camera_model.matrix_view();
-        }
-
-        // Set the light to the current position of the camera
-        environment.light = camera_control.camera_model.position();
-
-        apartment.draw(environment);
 
-        // Draw the local player's model
-        // Model is now always drawn, visible in both FPS and free-camera/orbit mode.
-        player.draw_model(environment);
+            // Draw the frame if enabled
+            if (gui.display_frame)
+                render_queue.add(global_frame, environment);
 
-        // Draw remote players
-        {
-            std::lock_guard<std::mutex> lock(remote_players_mutex);
-            for (auto const& remote_pair : remote_players) {
-                const std::string& name = remote_pair.first;
-                const RemotePlayer& remote_player_data = remote_pair.second;
-                if (name != username) { // Don't draw local player again
-                    remote_player_data.draw(environment);
-                }
+            // Draw other scene elements here
+            if (!gui.display_wireframe) {
+                render_queue.add(obj_man, environment);
             }
-        }
 
-        // Draw the frame if enabled
-        if (gui.display_frame)
-            draw(global_frame, environment);
+            render_queue.submit();
+            frame_statistics += render_queue.statistics;
+        }
 
-        // Draw other scene elements here
         if (gui.display_wireframe) {
             draw_wireframe(obj_man, environment);
         }
-        else {
-            draw(obj_man, environment);
-        }
 
         // Render crosshair in FPS mode (overlay on top of everything)
-        if (fps_mode) {
+        if (render_snapshot.fps_mode) {
+            GPU_PROFILE_SCOPE("crosshair");
             crosshair.draw_opengl(environment, window.width, window.height);
         }
     }
 }
 
+void scene_structure::simulation_step(float dt)
+{
+    PROFILE_SCOPE("simulation_step");
+    std::lock_guard<std::mutex> lock(simulation_mutex);
+    if (current_state != GameState::MAIN_GAME) {
+        return;
+    }
+
+    // Clock synchronization with the server (requests from time to time, answered by the TIME messages)
+    NetworkClock& clock = APIService::getInstance().networkClock();
+    if (WebSocketService::getInstance().isConnected() && clock.requestDue()) {
+        WebSocketService::getInstance().send(clock.makeRequest());
+    }
+
+    inputs.time_interval = dt;
+    idle_frame();
+    update_simulation_camera();
+    publish_render_snapshot();
+}
+
+void scene_structure::update_simulation_camera()
+{
+    // In cursor mode, the camera view remains at its last value
+    if (cursor_mode) {
+        return;
+    }
+
+    if (fps_mode) {
+        // Use player's camera view
+        simulation_camera_view = player.camera.camera_model.matrix_view();
+    }
+    else if (spectator_mode) {
+        simulation_camera_view = spectator.camera.camera_model.matrix_view();
+    }
+    else if (follow_player_mode) {
+        std::lock_guard<std::mutex> lock(remote_players_mutex);
+
+        if (!remote_player_usernames.empty() && current_followed_index >= 0 && current_followed_index < static_cast<int>(remote_player_usernames.size())) {
+            const std::string& target_username = remote_player_usernames[current_followed_index];
+            auto it = remote_players.find(target_username);
+            if (it != remote_players.end()) {
+                const RemotePlayer& target = it->second;
+                // Copier la position et la rotation de la caméra du joueur suivi
+                spectator.camera.camera_model.position_camera = target.position + cgp::vec3(0, -5.0f, 1.9f);
+                cgp::vec3 front_direction = target.orientation * cgp::vec3(0, 1, 0); 
+                spectator.camera.camera_model.look_at(
+                target.position, 
+                target.position + front_direction
+            );
+
+                simulation_camera_view = spectator.camera.camera_model.matrix_view();
+            }
+        }
+    }
+    else {
+        // Use orbit camera view
+        simulation_camera_view = camera_control.camera_model.matrix_view();
+    }
+}
+
+void scene_structure::publish_render_snapshot()
+{
+    RenderSnapshot& snapshot = render_snapshots.back();
+
+    snapshot.step = ++simulation_step_count;
+    snapshot.camera_view = simulation_camera_view;
+    // Set the light to the current position of the camera
+    snapshot.light = camera_control.camera_model.position();
+    snapshot.player_model = player.getModelPlacement();
+    snapshot.fps_mode = fps_mode;
+    snapshot.cursor_mode = cursor_mode;
+
+    // The remote players are displayed at the render time of the clock, behind the server by the interpolation delay,
+    //  so that their placement is interpolated between two received states (the last state until the clock is synchronized)
+    const NetworkClock& clock = APIService::getInstance().networkClock();
+    bool const interpolate = clock.isSynchronized();
+    double const render_time = clock.renderTime();
+    snapshot.remote_players.clear();
+    {
+        std::lock_guard<std::mutex> lock(remote_players_mutex);
+        for (auto& remote_pair : remote_players) {
+            if (remote_pair.first != username) { // Don't draw local player again
+                RemotePlayer& remote_player = remote_pair.second;
+                snapshot.remote_players.push_back({ remote_pair.first, interpolate ? remote_player.placement_at(render_time) : remote_player.placement });
+            }
+        }
+    }
+
+    snapshot.capture_cursor = fps_mode || spectator_mode || follow_player_mode;
+
+    render_snapshots.publish();
+}
+
 void scene_structure::display_gui()
 {
     // Display cursor mode status
@@ -680,6 +778,52 @@ void scene_structure::display_gui()
     ImGui::SameLine();
     ImGui::Text("%s",username.c_str());
 
+    const NetworkClock& clock = APIService::getInstance().networkClock();
+    if (clock.isSynchronized()) {
+        ImGui::Text("RTT: %.1f ms (jitter %.1f ms), interpolation delay %.1f ms",
+            clock.roundTripTime(), clock.roundTripJitter(), clock.interpolationDelay());
+    }
+
+    if (prediction_enabled) {
+        MovementPrediction::Statistics const prediction = movement_prediction.statistics();
+        ImGui::Text("Prediction: %d pending, %d corrections, error %.3f m",
+            int(prediction.pending), int(prediction.corrections), prediction.last_error);
+    }
+
+    if (udp_enabled) {
+        UdpChannel::Statistics const udp = WebSocketService::getInstance().udpStatistics();
+        if (WebSocketService::getInstance().isUdpEstablished())
+            ImGui::Text("UDP: %d sent, %d received, %d lost, %d late", int(udp.sent), int(udp.received), int(udp.lost), int(udp.late));
+        else
+            ImGui::Text("UDP: not established (states on the WebSocket)");
+    }
+
+    if (ImGui::CollapsingHeader("Network conditions")) {
+        // Simulated on the received and on the sent messages (latency: one way)
+        NetworkConditions conditions = WebSocketService::getInstance().networkConditions();
+        bool changed = false;
+        changed |= ImGui::SliderFloat("Latency (ms)", &conditions.latency, 0.0f, 500.0f);
+        changed |= ImGui::SliderFloat("Jitter (ms)", &conditions.jitter, 0.0f, 200.0f);
+        changed |= ImGui::SliderFloat("Bandwidth (kbit/s, 0: unlimited)", &conditions.bandwidth, 0.0f, 5000.0f);
+        changed |= ImGui::SliderFloat("Reordering (UDP)", &conditions.reorder, 0.0f, 1.0f);
+        changed |= ImGui::SliderFloat("Loss", &conditions.loss, 0.0f, 1.0f);
+        if (ImGui::Button("Real network")) {
+            conditions = NetworkConditions();
+            changed = true;
+        }
+        if (changed)
+            WebSocketService::getInstance().setNetworkConditions(conditions);
+
+        NetworkConditioner::Statistics const inbound = WebSocketService::getInstance().inboundNetworkStatistics();
+        NetworkConditioner::Statistics const outbound = WebSocketService::getInstance().outboundNetworkStatistics();
+        ImGui::Text("Received: %d delayed (%.1f ms), %d pending, %d dropped, %d retransmitted, %d reordered",
+            int(inbound.delayed), inbound.delay, int(inbound.pending), int(inbound.dropped), int(inbound.retransmitted), int(inbound.reordered));
+        ImGui::Text("Sent: %d delayed (%.1f ms), %d pending, %d dropped, %d retransmitted, %d reordered",
+            int(outbound.delayed), outbound.delay, int(outbound.pending), int(outbound.dropped), int(outbound.retransmitted), int(outbound.reordered));
+
+        ImGui::SliderInt("UPDATE rate (Hz, 0: every step)", &state_send_rate, 0, 60);
+    }
+
     // Crosshair settings
     if (ImGui::CollapsingHeader("Crosshair Settings")) {
         crosshair.display_gui();
@@ -782,18 +926,18 @@ void scene_structure::mouse_move_event()
         // Only process mouse movement if not on GUI
         if (!inputs.mouse.on_gui) {
             // Send the mouse positions to the player for handling
-            player.handle_mouse_move(inputs.mouse.position.current, inputs.mouse.position.previous, environment.camera_view);
+            player.handle_mouse_move(inputs.mouse.position.current, inputs.mouse.position.previous, simulation_camera_view);
         }
     }
     else if (spectator_mode && !inputs.mouse.on_gui){
-        spectator.handle_mouse_move(inputs.mouse.position.current, inputs.mouse.position.previous, environment.camera_view);
+        spectator.handle_mouse_move(inputs.mouse.position.current, inputs.mouse.position.previous, simulation_camera_view);
     }
     else if (follow_player_mode) {
         // Pas de contrôle souris en mode suivi
     }
     else if (!inputs.keyboard.shift) {
         // Standard orbit camera control for non-FPS mode
-        camera_control.action_mouse_move(environment.camera_view);
+        camera_control.action_mouse_move(simulation_camera_view);
     }
 }
 
@@ -801,7 +945,7 @@ void scene_structure::mouse_click_event()
 {
     // Only process camera clicks if not in cursor mode
     if (!cursor_mode) {
-        camera_control.action_mouse_click(environment.camera_view);
+        camera_control.action_mouse_click(simulation_camera_view);
     }
 }
 
@@ -913,6 +1057,7 @@ void scene_structure::keyboard_event()
 
 
 void scene_structure::idle_frame() {
+    PROFILE_SCOPE("idle_frame");
     // Check player HP and handle death automatically
 /*    if (player.getHP() <= 0 && !death_pause) {
         player.die();
@@ -948,7 +1093,29 @@ void scene_structure::idle_frame() {
         if (update_timer >= 0.016f) { // ~60 fps
             // Only update player movement when not in cursor mode
             if (!cursor_mode) {
-                player.update(update_timer, inputs.keyboard, inputs.mouse, environment.camera_view);
+                if (prediction_enabled) {
+                    movement_prediction.reconcile(player);
+                }
+                player.update(update_timer, inputs.keyboard, inputs.mouse, simulation_camera_view);
+
+                // The step just predicted is sent to the server, which applies the same input with the same dt
+                if (prediction_enabled && !player.isDead() && WebSocketService::getInstance().isConnected()) {
+                    const PlayerInput& input = player.getLastInput();
+                    uint32_t const sequence = movement_prediction.record(update_timer, input, player.getMovementState());
+                    nlohmann::json input_payload = {
+                        {"type", "INPUT"},
+                        {"content", {
+                            {"sequence", sequence},
+                            {"dt", update_timer},
+                            {"direction", {{"x", input.direction.x}, {"y", input.direction.y}}},
+                            {"run", input.run},
+                            {"jump", input.jump},
+                            {"shoot", input.shoot}
+                        }}
+                    };
+                    // On the WebSocket even with --udp: the server applies every sequence, a lost input would make the reconciliation snap
+                    WebSocketService::getInstance().send(input_payload.dump());
+                }
             }
             
             // Update footstep audio for local player
@@ -970,11 +1137,20 @@ void scene_structure::idle_frame() {
             
             // Handle player shooting with hit detection
             handlePlayerShooting();
+
+            // UPDATE at every step, or state_send_rate times per second
+            bool send_state = true;
+            if (state_send_rate > 0) {
+                float const period = 1.0f / float(state_send_rate);
+                state_send_timer += update_timer;
+                send_state = state_send_timer >= period;
+                if (send_state) state_send_timer = std::min(state_send_timer - period, period);
+            }
             
             update_timer = 0;
 
             // Send player state update - only if connected and username is set
-            if (WebSocketService::getInstance().isConnected() && !username.empty()) {
+            if (send_state && WebSocketService::getInstance().isConnected() && !username.empty()) {
                 try {
                     nlohmann::json update_payload;
                     update_payload["type"] = "UPDATE";
@@ -995,7 +1171,7 @@ void scene_structure::idle_frame() {
                     }
 
                     // Aim Direction (4x4 matrix from camera view)
-                    cgp::mat4 aim_matrix = environment.camera_view;
+                    cgp::mat4 aim_matrix = simulation_camera_view;
                     nlohmann::json aim_json_matrix = nlohmann::json::array();
                     
                     bool matrix_valid = true;
@@ -1037,7 +1213,7 @@ void scene_structure::idle_frame() {
 
                     // Send the message via WebSocket if still connected
                     if (WebSocketService::getInstance().isConnected()) {
-                        WebSocketService::getInstance().send(update_payload.dump());
+                        WebSocketService::getInstance().sendState(update_payload.dump());
                     }
                 } catch (const std::exception& e) {
                     std::cerr << "Error creating or sending player update: " << e.what() << std::endl;
@@ -1048,7 +1224,7 @@ void scene_structure::idle_frame() {
     else if (spectator_mode) {
         // Only update spectator when not in cursor mode
         if (!cursor_mode) {
-            spectator.update(inputs.time_interval, inputs.keyboard, inputs.mouse, environment.camera_view);
+            spectator.update(inputs.time_interval, inputs.keyboard, inputs.mouse, simulation_camera_view);
         }
     }
     else if (follow_player_mode) {
@@ -1056,7 +1232,7 @@ void scene_structure::idle_frame() {
     }
     else {
         
-        camera_control.idle_frame(environment.camera_view);
+        camera_control.idle_frame(simulation_camera_view);
     }
 }
 
@@ -1104,10 +1280,16 @@ void scene_structure::handlePlayerShooting() {
     // Check if player is trying to shoot and not in cursor mode
     if (!cursor_mode && inputs.mouse.click.left && player.getWeapon().canShoot()) {
         // Perform shooting with hit detection using remote players
-        std::lock_guard<std::mutex> lock(remote_players_mutex);
-        HitInfo hit_result = player.performShoot(remote_players);
+        // The shot is tested against the remote players where they are displayed (see publish_render_snapshot)
+        const NetworkClock& clock = APIService::getInstance().networkClock();
+        double const render_time = clock.isSynchronized() ? clock.renderTime() : -1.0;
+        HitInfo hit_result;
+        {
+            std::lock_guard<std::mutex> lock(remote_players_mutex);
+            hit_result = player.performShoot(remote_players, render_time);
+        }
         
-        // If we hit someone, send the hit information to the server
+        // If we hit someone (sent once the lock is released: the network thread waits for it to apply the states), send the hit information to the server
         if (hit_result.hit) {
             sendHitInfoToServer(hit_result);
         }
@@ -1131,6 +1313,11 @@ void scene_structure::sendHitInfoToServer(const HitInfo& hit_info) {
         hit_message["hit_position"]["x"] = hit_info.hit_position.x;
         hit_message["hit_position"]["y"] = hit_info.hit_position.y;
         hit_message["hit_position"]["z"] = hit_info.hit_position.z;
+
+        // Server time at which the target was displayed when shooting: the server validates the hit at this time
+        if (hit_info.time >= 0.0) {
+            hit_message["time"] = hit_info.time;
+        }
         
         // Send the hit message
         WebSocketService::getInstance().send(hit_message.dump());
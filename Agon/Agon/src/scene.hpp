@@ -17,6 +17,10 @@
 #include <nlohmann/json.hpp>
 #include <map> // Required for std::map
 #include "remote_player.hpp" // Include the new RemotePlayer header
+#include "render_snapshot.hpp"
+#include "simulation_thread.hpp"
+#include "profiler.hpp"
+#include "prediction.hpp"
 
 using cgp::mesh_drawable;
 
@@ -76,6 +80,9 @@ struct scene_structure : cgp::scene_inputs_generic {
     // Apartment
     Apartment apartment;
 
+    // Background decoding and upload of the textures (updated at every frame)
+    opengl_texture_async_loader_structure texture_loader;
+
     // Audio system for footsteps and other sounds
     AudioSystem audio_system;
     std::unique_ptr<FootstepAudioManager> footstep_manager;
@@ -105,16 +112,47 @@ struct scene_structure : cgp::scene_inputs_generic {
     std::mutex chat_mutex;  // For thread safety when adding messages
 
     // Storage for remote players
+    std::shared_ptr<RemotePlayerModel const> remote_player_model; // Model and levels of detail shared by all the remote players (built in initialize)
     std::map<std::string, RemotePlayer> remote_players;
     std::mutex remote_players_mutex; // For thread safety when accessing remote_players
     
     std::vector<std::string> remote_player_usernames;
     int current_followed_index = -1;
 
+    // Client-side prediction (--prediction, for a server applying the sequenced INPUT messages such as agon_server)
+    //  The local player sends its inputs instead of being only reported by UPDATE, and is corrected by the STATE messages.
+    bool prediction_enabled = false;
+    MovementPrediction movement_prediction;
+
+    // UDP channel of the states (--udp): UPDATE is sent by UDP once the server accepted the channel (INPUT stays on the WebSocket)
+    bool udp_enabled = false;
+
+    // UPDATE messages per second (--send-rate, 0: every simulation step), to compare send rates under simulated conditions
+    int state_send_rate = 0;
+    float state_send_timer = 0.0f;
+
     // Shooting system
     void handlePlayerShooting();
     void sendHitInfoToServer(const HitInfo& hit_info);
 
+    // Simulation / render separation
+    //  The simulation (inputs, player physics, audio, network send) runs at a fixed rate in simulation_step, on simulation_thread
+    //  when project::simulation_in_thread is set. At the end of each step it publishes a RenderSnapshot,
+    //  and display_frame only draws from the last published snapshot.
+    //  simulation_mutex protects the simulation state (player, spectator, cameras, inputs, modes) against the input callbacks and the GUI.
+    SimulationThread simulation_thread;
+    std::mutex simulation_mutex;
+    cgp::mat4 simulation_camera_view;     // Camera of the simulation (environment.camera_view is the one of the rendered snapshot)
+    RenderSnapshotBuffer render_snapshots;
+    uint64_t simulation_step_count = 0;
+    RenderSnapshot render_snapshot;       // Snapshot drawn by the current frame (render thread only)
+    cgp::render_queue_structure render_queue; // Draws of the frame sorted by shader/texture/VAO
+    cgp::render_queue_structure::statistics_structure frame_statistics; // Sum of the render queue statistics of the passes of the last frame
+
+    void simulation_step(float dt);       // One fixed step of simulation, then publish the snapshot
+    void update_simulation_camera();
+    void publish_render_snapshot();
+
     // Core functions
     void initialize();    // Standard initialization to be called before the animation loop
     void display_frame(); // The frame display to be called within the animation loop
@@ -0,0 +1,45 @@
+#include "simulation_thread.hpp"
+#include "profiler.hpp"
+
+#include <chrono>
+
+SimulationThread::~SimulationThread() {
+    stop();
+}
+
+void SimulationThread::start(float rate_hz, std::function<void(float)> const& step) {
+    if (running) return;
+    step_function = step;
+    running = true;
+    thread = std::thread(&SimulationThread::loop, this, rate_hz);
+}
+
+void SimulationThread::stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void SimulationThread::loop(float rate_hz) {
+    Profiler::instance().set_thread_name("Simulation");
+
+    using clock = std::chrono::steady_clock;
+    float const dt = 1.0f / rate_hz;
+    clock::duration const period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(dt));
+
+    clock::time_point next_step = clock::now();
+    while (running) {
+        clock::time_point const start = clock::now();
+        step_function(dt);
+        last_step_time = std::chrono::duration<float>(clock::now() - start).count();
+
+        next_step += period;
+        clock::time_point const now = clock::now();
+        if (now - next_step > max_catch_up_steps * period) {
+            // Too late: restart the schedule from now instead of running a burst of steps
+            next_step = now;
+        }
+        std::this_thread::sleep_until(next_step);
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+// Runs a simulation step at a fixed rate on its own thread
+//  The step receives the fixed time step (1/rate). If a step takes longer than the period, the next ones are run
+//  immediately to catch up, up to max_catch_up_steps (after that the lost time is dropped instead of spiraling).
+class SimulationThread {
+public:
+    SimulationThread() = default;
+    SimulationThread(SimulationThread const&) = delete;
+    SimulationThread& operator=(SimulationThread const&) = delete;
+    ~SimulationThread();
+
+    void start(float rate_hz, std::function<void(float)> const& step);
+    void stop();
+    bool is_running() const { return running; }
+
+    // Duration of the last step in seconds (for display)
+    float last_step_duration() const { return last_step_time; }
+
+    int max_catch_up_steps = 5;
+
+private:
+    void loop(float rate_hz);
+
+    std::thread thread;
+    std::function<void(float)> step_function;
+    std::atomic<bool> running{false};
+    std::atomic<float> last_step_time{0.0f};
+};
@@ -17,6 +17,7 @@ struct HitInfo {
     cgp::vec3 hit_position;
     float distance;
     int damage;
+    double time = -1.0; // Server time at which the remote players were displayed (negative: clock not synchronized)
 };
 
 class Weapon {
@@ -50,7 +51,8 @@ public:
     bool canShoot() const;
 
     // New shooting system with hit detection
-    HitInfo shootWithHitDetection(const Player& shooter, const std::map<std::string, RemotePlayer>& remote_players);
+    // render_time: server time at which the remote players are displayed (negative: at their last received position)
+    HitInfo shootWithHitDetection(const Player& shooter, const std::map<std::string, RemotePlayer>& remote_players, double render_time = -1.0);
 
     // Getters
     int getBulletCount() const;
@@ -65,7 +67,7 @@ public:
 private:
     // Helper function for raycasting hit detection with height-based damage
     bool checkPlayerHit(const cgp::vec3& ray_origin, const cgp::vec3& ray_direction, 
-                       const RemotePlayer& target, float& hit_distance, int& damage) const;
+                       const RemotePlayer& target, double render_time, float& hit_distance, int& damage) const;
 };
 
 #endif // !WEAPON_HPP
@@ -27,6 +27,20 @@ namespace cgp
 		
 	}
 
+	affine_rts affine_rts::from_matrix(mat4 const& M)
+	{
+		affine_rts a;
+
+		a.scaling = std::sqrt(M.data.x.x*M.data.x.x + M.data.x.y*M.data.x.y + M.data.x.z*M.data.x.z);
+		if(a.scaling>1e-5f){
+			mat3 R = M.get_block_linear()/a.scaling;
+			a.rotation = rotation_transform::from_matrix(R);
+		}
+		a.translation = M.get_block_translation();
+
+		return a;
+	}
+
 	vec3 operator*(affine_rts const& T, vec3 const& p)
 	{
 		mat3 const R = T.rotation.matrix();
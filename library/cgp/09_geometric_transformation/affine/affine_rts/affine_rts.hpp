@@ -23,6 +23,8 @@ namespace cgp
 		affine_rts& set_rotation(rotation_transform const& rotation);
 
 		mat4 matrix() const;
+
+		static affine_rts from_matrix(mat4 const& M);
 	};
 
 	vec3 operator*(affine_rts const& T, vec3 const& p);
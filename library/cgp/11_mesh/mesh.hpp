@@ -1,4 +1,6 @@
 #pragma once
 
 #include "mesh/mesh.hpp"
+#include "mesh_optimization/mesh_optimization.hpp"
+#include "mesh_simplification/mesh_simplification.hpp"
 #include "primitive/primitive.hpp"
@@ -0,0 +1,392 @@
+#include "mesh_optimization.hpp"
+
+#include "cgp/01_base/base.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <vector>
+
+namespace cgp
+{
+	std::string str(mesh_optimization_report const& report)
+	{
+		std::string s = "N_vertex=" + str(report.number_of_vertex_before) + " -> " + str(report.number_of_vertex) + ", N_triangle=" + str(report.number_of_triangle);
+		s += ", ACMR " + str(report.acmr_before) + " -> " + str(report.acmr_after);
+		if (report.number_of_cluster > 0)
+			s += ", overdraw clusters=" + str(report.number_of_cluster);
+		return s;
+	}
+
+	float mesh_acmr(numarray<uint3> const& connectivity, int cache_size)
+	{
+		int const N_tri = connectivity.size();
+		if (N_tri == 0)
+			return 0.0f;
+
+		// FIFO cache: a hit doesn't modify the order of the cache
+		std::deque<unsigned int> cache;
+		int miss = 0;
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri) {
+			for (int k = 0; k < 3; ++k) {
+				unsigned int const v = connectivity[k_tri][k];
+				if (std::find(cache.begin(), cache.end(), v) == cache.end()) {
+					miss++;
+					cache.push_back(v);
+					if (int(cache.size()) > cache_size)
+						cache.pop_front();
+				}
+			}
+		}
+		return float(miss) / float(N_tri);
+	}
+
+
+	numarray<int> mesh_weld_vertex(mesh& m, numarray<int> const& vertex_group)
+	{
+		int const N_vertex = m.position.size();
+		bool const has_normal = m.normal.size() == N_vertex;
+		bool const has_color = m.color.size() == N_vertex;
+		bool const has_uv = m.uv.size() == N_vertex;
+		bool const has_group = vertex_group.size() == N_vertex;
+
+		// Lexicographic comparison of all the attributes of two vertices (-1: a<b, 0: a==b, 1: a>b)
+		auto compare = [&](int a, int b) -> int {
+			if (has_group && vertex_group[a] != vertex_group[b])
+				return vertex_group[a] < vertex_group[b] ? -1 : 1;
+			float const* data[4] = { &m.position[a].x, has_normal ? &m.normal[a].x : nullptr, has_color ? &m.color[a].x : nullptr, has_uv ? &m.uv[a].x : nullptr };
+			float const* data_b[4] = { &m.position[b].x, has_normal ? &m.normal[b].x : nullptr, has_color ? &m.color[b].x : nullptr, has_uv ? &m.uv[b].x : nullptr };
+			int const dimension[4] = { 3, 3, 3, 2 };
+			for (int k = 0; k < 4; ++k) {
+				if (data[k] == nullptr)
+					continue;
+				for (int i = 0; i < dimension[k]; ++i)
+					if (data[k][i] != data_b[k][i])
+						return data[k][i] < data_b[k][i] ? -1 : 1;
+			}
+			return 0;
+		};
+
+		std::vector<int> order(N_vertex);
+		for (int k = 0; k < N_vertex; ++k)
+			order[k] = k;
+		// Stable sort: the first vertex of a set of identical vertices is the one with the smallest index
+		std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return compare(a, b) < 0; });
+
+		std::vector<int> representative(N_vertex);
+		for (int k = 0; k < N_vertex; ++k) {
+			if (k > 0 && compare(order[k - 1], order[k]) == 0)
+				representative[order[k]] = representative[order[k - 1]];
+			else
+				representative[order[k]] = order[k];
+		}
+
+		numarray<int> vertex_remap;
+		vertex_remap.resize(N_vertex);
+		int next_index = 0;
+		for (int kv = 0; kv < N_vertex; ++kv) {
+			int const r = representative[kv];
+			vertex_remap[kv] = (r == kv) ? next_index++ : vertex_remap[r];
+		}
+
+		for (uint3& tri : m.connectivity)
+			for (int k = 0; k < 3; ++k)
+				tri[k] = vertex_remap[tri[k]];
+		m.position = mesh_apply_vertex_remap(m.position, vertex_remap);
+		if (has_normal)
+			m.normal = mesh_apply_vertex_remap(m.normal, vertex_remap);
+		if (has_color)
+			m.color = mesh_apply_vertex_remap(m.color, vertex_remap);
+		if (has_uv)
+			m.uv = mesh_apply_vertex_remap(m.uv, vertex_remap);
+
+		return vertex_remap;
+	}
+
+
+	// Parameters of the vertex cache optimization (values from T. Forsyth, "Linear-Speed Vertex Cache Optimisation")
+	static int const forsyth_cache_size = 32;
+	static float const forsyth_cache_decay_power = 1.5f;
+	static float const forsyth_last_triangle_score = 0.75f;
+	static float const forsyth_valence_boost_scale = 2.0f;
+	static float const forsyth_valence_boost_power = 0.5f;
+
+	// Score of a vertex given its position in the LRU cache (-1 if not in cache) and its number of remaining triangles
+	static float forsyth_vertex_score(int cache_position, int remaining_triangle)
+	{
+		if (remaining_triangle == 0)
+			return -1.0f;
+
+		float score = 0.0f;
+		if (cache_position >= 0) {
+			if (cache_position < 3) {
+				// The 3 vertices of the last triangle have a fixed score to avoid favoring the same triangle strip direction
+				score = forsyth_last_triangle_score;
+			}
+			else {
+				float const scaler = 1.0f / float(forsyth_cache_size - 3);
+				score = std::pow(1.0f - float(cache_position - 3) * scaler, forsyth_cache_decay_power);
+			}
+		}
+		// Boost the vertices with few remaining triangles to avoid leaving isolated triangles
+		score += forsyth_valence_boost_scale * std::pow(float(remaining_triangle), -forsyth_valence_boost_power);
+		return score;
+	}
+
+	void mesh_optimize_vertex_cache(numarray<uint3>& connectivity, int number_of_vertex)
+	{
+		int const N_tri = connectivity.size();
+		int const N_vertex = number_of_vertex;
+		if (N_tri == 0)
+			return;
+
+		// Vertex to triangle adjacency (compressed storage)
+		std::vector<int> adjacency_offset(N_vertex + 1, 0);
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri)
+			for (int k = 0; k < 3; ++k)
+				adjacency_offset[connectivity[k_tri][k] + 1]++;
+		for (int kv = 0; kv < N_vertex; ++kv)
+			adjacency_offset[kv + 1] += adjacency_offset[kv];
+		std::vector<int> adjacency(adjacency_offset[N_vertex]);
+		std::vector<int> remaining_triangle(N_vertex, 0);
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri) {
+			for (int k = 0; k < 3; ++k) {
+				int const v = connectivity[k_tri][k];
+				adjacency[adjacency_offset[v] + remaining_triangle[v]] = k_tri;
+				remaining_triangle[v]++;
+			}
+		}
+
+		// Initial scores
+		std::vector<int> cache_position(N_vertex, -1);
+		std::vector<float> vertex_score(N_vertex);
+		for (int kv = 0; kv < N_vertex; ++kv)
+			vertex_score[kv] = forsyth_vertex_score(-1, remaining_triangle[kv]);
+
+		std::vector<float> triangle_score(N_tri);
+		std::vector<char> triangle_added(N_tri, 0);
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri)
+			triangle_score[k_tri] = vertex_score[connectivity[k_tri][0]] + vertex_score[connectivity[k_tri][1]] + vertex_score[connectivity[k_tri][2]];
+
+		// Remove a triangle from the list of remaining triangles of a vertex
+		auto remove_triangle_from_vertex = [&](int v, int k_tri) {
+			int const first = adjacency_offset[v];
+			int const last = first + remaining_triangle[v];
+			for (int k = first; k < last; ++k) {
+				if (adjacency[k] == k_tri) {
+					std::swap(adjacency[k], adjacency[last - 1]);
+					break;
+				}
+			}
+			remaining_triangle[v]--;
+		};
+
+		numarray<uint3> optimized;
+		optimized.resize(N_tri);
+
+		std::vector<int> cache;       // LRU cache, the most recent vertex first
+		std::vector<int> cache_next;
+		cache.reserve(forsyth_cache_size + 3);
+		cache_next.reserve(forsyth_cache_size + 3);
+
+		int best_triangle = -1;
+		int scan_position = 0; // Used to find a new starting triangle when the cache doesn't give any candidate
+		for (int k_output = 0; k_output < N_tri; ++k_output) {
+
+			if (best_triangle < 0) {
+				float best_score = -1.0f;
+				for (int k_tri = scan_position; k_tri < N_tri; ++k_tri) {
+					if (!triangle_added[k_tri] && triangle_score[k_tri] > best_score) {
+						best_score = triangle_score[k_tri];
+						best_triangle = k_tri;
+					}
+				}
+				while (scan_position < N_tri && triangle_added[scan_position])
+					scan_position++;
+			}
+
+			// Emit the triangle
+			uint3 const tri = connectivity[best_triangle];
+			optimized[k_output] = tri;
+			triangle_added[best_triangle] = 1;
+			for (int k = 0; k < 3; ++k)
+				remove_triangle_from_vertex(tri[k], best_triangle);
+
+			// Update the LRU cache: the vertices of the triangle are placed first
+			cache_next.clear();
+			for (int k = 0; k < 3; ++k)
+				cache_next.push_back(int(tri[k]));
+			for (int v : cache)
+				if (v != int(tri[0]) && v != int(tri[1]) && v != int(tri[2]))
+					cache_next.push_back(v);
+			std::swap(cache, cache_next);
+
+			// Update the scores of the vertices in the cache (and the ones leaving it), then of their triangles
+			for (int k = 0; k < int(cache.size()); ++k) {
+				int const v = cache[k];
+				int const position = k < forsyth_cache_size ? k : -1;
+				cache_position[v] = position;
+				vertex_score[v] = forsyth_vertex_score(position, remaining_triangle[v]);
+			}
+
+			best_triangle = -1;
+			float best_score = -1.0f;
+			for (int v : cache) {
+				int const first = adjacency_offset[v];
+				for (int k = first; k < first + remaining_triangle[v]; ++k) {
+					int const k_tri = adjacency[k];
+					uint3 const& t = connectivity[k_tri];
+					float const score = vertex_score[t[0]] + vertex_score[t[1]] + vertex_score[t[2]];
+					triangle_score[k_tri] = score;
+					if (score > best_score) {
+						best_score = score;
+						best_triangle = k_tri;
+					}
+				}
+			}
+
+			if (int(cache.size()) > forsyth_cache_size)
+				cache.resize(forsyth_cache_size);
+		}
+
+		connectivity = optimized;
+	}
+
+
+	int mesh_optimize_overdraw(numarray<uint3>& connectivity, numarray<vec3> const& position, float acmr_threshold)
+	{
+		int const N_tri = connectivity.size();
+		if (N_tri == 0)
+			return 0;
+
+		// Split in clusters at the triangles for which the 3 vertices miss the cache
+		int const cache_size = 16;
+		std::deque<unsigned int> cache;
+		std::vector<int> cluster_start;
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri) {
+			int miss = 0;
+			for (int k = 0; k < 3; ++k) {
+				unsigned int const v = connectivity[k_tri][k];
+				if (std::find(cache.begin(), cache.end(), v) == cache.end()) {
+					miss++;
+					cache.push_back(v);
+					if (int(cache.size()) > cache_size)
+						cache.pop_front();
+				}
+			}
+			if (k_tri == 0 || miss == 3)
+				cluster_start.push_back(k_tri);
+		}
+		int const N_cluster = int(cluster_start.size());
+		cluster_start.push_back(N_tri);
+		if (N_cluster < 2)
+			return 0;
+
+		// Centroid of the mesh
+		vec3 mesh_center;
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri)
+			for (int k = 0; k < 3; ++k)
+				mesh_center += position[connectivity[k_tri][k]];
+		mesh_center /= float(3 * N_tri);
+
+		// Sort key of each cluster: clusters far from the center and facing outward are drawn first (they are likely to occlude the others)
+		std::vector<float> cluster_key(N_cluster);
+		for (int k_cluster = 0; k_cluster < N_cluster; ++k_cluster) {
+			vec3 center;
+			vec3 normal;
+			float area = 0.0f;
+			for (int k_tri = cluster_start[k_cluster]; k_tri < cluster_start[k_cluster + 1]; ++k_tri) {
+				vec3 const& p0 = position[connectivity[k_tri][0]];
+				vec3 const& p1 = position[connectivity[k_tri][1]];
+				vec3 const& p2 = position[connectivity[k_tri][2]];
+				vec3 const n = cross(p1 - p0, p2 - p0); // norm = 2*area
+				float const a = norm(n);
+				center += a * (p0 + p1 + p2) / 3.0f;
+				normal += n;
+				area += a;
+			}
+			if (area > 0.0f)
+				center /= area;
+			float const n_norm = norm(normal);
+			cluster_key[k_cluster] = n_norm > 0.0f ? dot(center - mesh_center, normal / n_norm) : 0.0f;
+		}
+
+		std::vector<int> cluster_order(N_cluster);
+		for (int k = 0; k < N_cluster; ++k)
+			cluster_order[k] = k;
+		std::stable_sort(cluster_order.begin(), cluster_order.end(), [&](int a, int b) { return cluster_key[a] > cluster_key[b]; });
+
+		numarray<uint3> sorted;
+		sorted.resize(N_tri);
+		int k_output = 0;
+		for (int k_cluster : cluster_order)
+			for (int k_tri = cluster_start[k_cluster]; k_tri < cluster_start[k_cluster + 1]; ++k_tri)
+				sorted[k_output++] = connectivity[k_tri];
+
+		// Keep the new order only if the vertex cache efficiency is preserved
+		if (mesh_acmr(sorted) > acmr_threshold * mesh_acmr(connectivity))
+			return 0;
+
+		connectivity = sorted;
+		return N_cluster;
+	}
+
+
+	numarray<int> mesh_optimize_vertex_fetch(mesh& m)
+	{
+		int const N_vertex = m.position.size();
+		numarray<int> vertex_remap;
+		vertex_remap.resize(N_vertex);
+		vertex_remap.fill(-1);
+
+		// New index given by the order of first use
+		int next_index = 0;
+		for (uint3& tri : m.connectivity) {
+			for (int k = 0; k < 3; ++k) {
+				int& new_index = vertex_remap[tri[k]];
+				if (new_index < 0)
+					new_index = next_index++;
+				tri[k] = new_index;
+			}
+		}
+		for (int kv = 0; kv < N_vertex; ++kv)
+			if (vertex_remap[kv] < 0)
+				vertex_remap[kv] = next_index++;
+
+		m.position = mesh_apply_vertex_remap(m.position, vertex_remap);
+		if (m.normal.size() == N_vertex)
+			m.normal = mesh_apply_vertex_remap(m.normal, vertex_remap);
+		if (m.color.size() == N_vertex)
+			m.color = mesh_apply_vertex_remap(m.color, vertex_remap);
+		if (m.uv.size() == N_vertex)
+			m.uv = mesh_apply_vertex_remap(m.uv, vertex_remap);
+
+		return vertex_remap;
+	}
+
+
+	mesh_optimization_report mesh_optimize(mesh& m, bool optimize_overdraw, numarray<int>* vertex_remap, numarray<int> const& vertex_group)
+	{
+		mesh_optimization_report report;
+		report.number_of_vertex_before = m.position.size();
+		report.number_of_triangle = m.connectivity.size();
+		report.acmr_before = mesh_acmr(m.connectivity);
+
+		numarray<int> const remap_weld = mesh_weld_vertex(m, vertex_group);
+		report.number_of_vertex = m.position.size();
+
+		mesh_optimize_vertex_cache(m.connectivity, m.position.size());
+		if (optimize_overdraw)
+			report.number_of_cluster = mesh_optimize_overdraw(m.connectivity, m.position);
+
+		numarray<int> const remap_fetch = mesh_optimize_vertex_fetch(m);
+		if (vertex_remap != nullptr) {
+			vertex_remap->resize(remap_weld.size());
+			for (int k = 0; k < remap_weld.size(); ++k)
+				(*vertex_remap)[k] = remap_fetch[remap_weld[k]];
+		}
+
+		report.acmr_after = mesh_acmr(m.connectivity);
+		return report;
+	}
+}
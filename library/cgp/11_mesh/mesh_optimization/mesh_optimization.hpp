@@ -0,0 +1,74 @@
+#pragma once
+
+#include "../mesh/mesh.hpp"
+
+#include <algorithm>
+
+
+namespace cgp
+{
+	/** Statistics of a mesh optimization pass */
+	struct mesh_optimization_report {
+		int number_of_vertex_before = 0; // Number of vertices before the merge of the duplicated vertices
+		int number_of_vertex = 0;
+		int number_of_triangle = 0;
+		float acmr_before = 0.0f; // ACMR of the input connectivity
+		float acmr_after = 0.0f;  // ACMR of the optimized connectivity
+		int number_of_cluster = 0; // Number of clusters sorted for the overdraw (0 if not applied)
+	};
+	std::string str(mesh_optimization_report const& report);
+
+	/** Average Cache Miss Ratio: average number of vertices transformed per triangle, simulated with a FIFO post-transform cache of the given size
+	* Values are in [~0.5, 3]: 3 means that every vertex is transformed for each triangle, ~0.5-0.7 is close to optimal for a regular mesh */
+	float mesh_acmr(numarray<uint3> const& connectivity, int cache_size = 16);
+
+	/** Merge the vertices sharing exactly the same attributes (position, normal, color, uv)
+	* Loaders duplicate the vertices at each face corner to store per-corner normal/uv, which prevents any reuse in the post-transform cache
+	* vertex_group (optional): only the vertices with the same group value are merged (ex. to keep vertices with different skinning weights)
+	* Return the correspondance new_index = vertex_remap[old_index] */
+	numarray<int> mesh_weld_vertex(mesh& m, numarray<int> const& vertex_group = numarray<int>());
+
+	/** Reorder the triangles to improve the locality of the vertices in the post-transform cache (linear-speed greedy algorithm from T. Forsyth)
+	* The vertex indices are not modified, only the order of the triangles */
+	void mesh_optimize_vertex_cache(numarray<uint3>& connectivity, int number_of_vertex);
+
+	/** Reorder clusters of triangles to reduce the overdraw: the clusters facing outward the mesh are drawn first
+	* The clusters are split where the post-transform cache is fully missed (expect an input optimized for the vertex cache)
+	* The new order is kept only if the ACMR doesn't exceed acmr_threshold times the ACMR of the input
+	* Return the number of clusters (0 if the order is not modified) */
+	int mesh_optimize_overdraw(numarray<uint3>& connectivity, numarray<vec3> const& position, float acmr_threshold = 1.05f);
+
+	/** Reorder the vertices in their order of first use in the connectivity to improve the locality of the vertex fetch
+	* All per-vertex buffers of the mesh (position, normal, color, uv) are reordered, unused vertices are placed at the end
+	* Return the correspondance new_index = vertex_remap[old_index] to reorder any additional per-vertex data (see mesh_apply_vertex_remap) */
+	numarray<int> mesh_optimize_vertex_fetch(mesh& m);
+
+	/** Reorder a per-vertex buffer with the correspondance returned by mesh_optimize_vertex_fetch or mesh_weld_vertex (merged vertices are expected to share the same value) */
+	template <typename T>
+	numarray<T> mesh_apply_vertex_remap(numarray<T> const& value, numarray<int> const& vertex_remap);
+
+	/** Apply the full optimization stage: merge of the duplicated vertices, vertex cache, (optional) overdraw, then vertex fetch
+	* Meant to be run once when the asset is converted/baked, not at every loading
+	* vertex_remap (optional): filled with the correspondance of the vertices new_index = vertex_remap[old_index]
+	* vertex_group (optional): see mesh_weld_vertex */
+	mesh_optimization_report mesh_optimize(mesh& m, bool optimize_overdraw = false, numarray<int>* vertex_remap = nullptr, numarray<int> const& vertex_group = numarray<int>());
+}
+
+
+namespace cgp
+{
+	template <typename T>
+	numarray<T> mesh_apply_vertex_remap(numarray<T> const& value, numarray<int> const& vertex_remap)
+	{
+		assert_cgp(value.size() == vertex_remap.size(), "Incorrect size of the per-vertex buffer to remap");
+		int N_new = 0;
+		for (int k = 0; k < vertex_remap.size(); ++k)
+			N_new = std::max(N_new, vertex_remap[k] + 1);
+
+		numarray<T> remapped;
+		remapped.resize(N_new);
+		for (int k = 0; k < value.size(); ++k)
+			remapped[vertex_remap[k]] = value[k];
+		return remapped;
+	}
+}
@@ -0,0 +1,301 @@
+#include "mesh_simplification.hpp"
+
+#include "cgp/01_base/base.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <map>
+#include <queue>
+#include <vector>
+
+namespace cgp
+{
+	// Symmetric 4x4 matrix Q such that the error of a position p is (p,1)^T Q (p,1) = sum of the squared distances to the accumulated planes
+	//  Stored as the upper triangular part: a00 a01 a02 a03 a11 a12 a13 a22 a23 a33
+	using quadric = std::array<double, 10>;
+
+	// Weight of the planes orthogonal to the boundary edges, preserves the silhouette of open meshes
+	static double const simplification_boundary_weight = 10.0;
+
+	static quadric quadric_plane(vec3 const& n, float d, double weight)
+	{
+		double const a = n.x, b = n.y, c = n.z, e = d;
+		return { weight * a * a, weight * a * b, weight * a * c, weight * a * e, weight * b * b, weight * b * c, weight * b * e, weight * c * c, weight * c * e, weight * e * e };
+	}
+
+	static void quadric_add(quadric& q, quadric const& to_add)
+	{
+		for (int k = 0; k < 10; ++k)
+			q[k] += to_add[k];
+	}
+
+	static double quadric_error(quadric const& q, vec3 const& p)
+	{
+		double const x = p.x, y = p.y, z = p.z;
+		double const error = q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+			+ q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+			+ q[7] * z * z + 2 * q[8] * z
+			+ q[9];
+		return std::max(error, 0.0);
+	}
+
+	// Normalize the vector v in n, return false for a degenerate vector
+	static bool safe_normal(vec3 const& v, vec3& n)
+	{
+		float const L = norm(v);
+		if (L < 1e-12f)
+			return false;
+		n = v / L;
+		return true;
+	}
+
+	// Candidate collapse of the vertex "from" onto the vertex "to"
+	//  The version of the two vertices are stored to discard the candidates that are out of date (lazy deletion in the priority queue)
+	struct simplification_collapse {
+		double error;
+		int from;
+		int to;
+		int version_from;
+		int version_to;
+		bool operator<(simplification_collapse const& other) const { return error > other.error; } // smallest error on top of the queue
+	};
+
+	mesh mesh_simplify(mesh const& m, int target_triangle, float max_error)
+	{
+		int const N_vertex_input = m.position.size();
+		if (N_vertex_input == 0 || m.connectivity.size() <= target_triangle)
+			return m;
+
+		// Merge the vertices with the same position (split normals/uv would prevent the collapse along the seams)
+		std::map<std::array<float, 3>, int> position_index;
+		std::vector<int> input_to_vertex(N_vertex_input);
+		std::vector<int> vertex_to_input; // first input vertex of each position
+		for (int k = 0; k < N_vertex_input; ++k) {
+			vec3 const& p = m.position[k];
+			auto const it = position_index.insert({ {p.x, p.y, p.z}, int(vertex_to_input.size()) });
+			if (it.second)
+				vertex_to_input.push_back(k);
+			input_to_vertex[k] = it.first->second;
+		}
+		int const N_vertex = vertex_to_input.size();
+
+		std::vector<vec3> position(N_vertex);
+		for (int kv = 0; kv < N_vertex; ++kv)
+			position[kv] = m.position[vertex_to_input[kv]];
+
+		std::vector<uint3> triangle;
+		triangle.reserve(m.connectivity.size());
+		for (uint3 const& f : m.connectivity) {
+			uint3 const t = { unsigned(input_to_vertex[f[0]]), unsigned(input_to_vertex[f[1]]), unsigned(input_to_vertex[f[2]]) };
+			if (t[0] != t[1] && t[1] != t[2] && t[0] != t[2])
+				triangle.push_back(t);
+		}
+		int const N_tri = triangle.size();
+
+		// Vertex to triangle adjacency (dead triangles are skipped when iterating)
+		std::vector<std::vector<int> > vertex_triangle(N_vertex);
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri)
+			for (int k = 0; k < 3; ++k)
+				vertex_triangle[triangle[k_tri][k]].push_back(k_tri);
+
+		// Initial quadrics: planes of the adjacent triangles and of the boundary edges
+		std::vector<quadric> Q(N_vertex, quadric{});
+		std::map<std::pair<int, int>, int> edge_count;
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri) {
+			uint3 const& t = triangle[k_tri];
+			for (int k = 0; k < 3; ++k) {
+				int const a = t[k], b = t[(k + 1) % 3];
+				edge_count[{std::min(a, b), std::max(a, b)}]++;
+			}
+			vec3 n;
+			if (!safe_normal(cross(position[t[1]] - position[t[0]], position[t[2]] - position[t[0]]), n))
+				continue;
+			quadric const q = quadric_plane(n, -dot(n, position[t[0]]), 1.0);
+			for (int k = 0; k < 3; ++k)
+				quadric_add(Q[t[k]], q);
+		}
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri) {
+			uint3 const& t = triangle[k_tri];
+			vec3 n;
+			if (!safe_normal(cross(position[t[1]] - position[t[0]], position[t[2]] - position[t[0]]), n))
+				continue;
+			for (int k = 0; k < 3; ++k) {
+				int const a = t[k], b = t[(k + 1) % 3];
+				vec3 n_boundary;
+				if (edge_count[{std::min(a, b), std::max(a, b)}] != 1 || !safe_normal(cross(position[b] - position[a], n), n_boundary))
+					continue;
+				quadric const q = quadric_plane(n_boundary, -dot(n_boundary, position[a]), simplification_boundary_weight);
+				quadric_add(Q[a], q);
+				quadric_add(Q[b], q);
+			}
+		}
+
+		std::vector<char> triangle_alive(N_tri, 1);
+		std::vector<char> vertex_alive(N_vertex, 1);
+		std::vector<int> version(N_vertex, 0);
+
+		// Alive vertices sharing a triangle with the vertex v
+		auto one_ring = [&](int v) {
+			std::vector<int> ring;
+			for (int k_tri : vertex_triangle[v]) {
+				if (!triangle_alive[k_tri])
+					continue;
+				for (int k = 0; k < 3; ++k)
+					if (triangle[k_tri][k] != v)
+						ring.push_back(triangle[k_tri][k]);
+			}
+			std::sort(ring.begin(), ring.end());
+			ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+			return ring;
+		};
+
+		// Push the best direction of collapse of the edge (a,b)
+		std::priority_queue<simplification_collapse> queue;
+		auto push_edge = [&](int a, int b) {
+			quadric q = Q[a];
+			quadric_add(q, Q[b]);
+			double const error_to_b = quadric_error(q, position[b]);
+			double const error_to_a = quadric_error(q, position[a]);
+			if (error_to_b <= error_to_a)
+				queue.push({ error_to_b, a, b, version[a], version[b] });
+			else
+				queue.push({ error_to_a, b, a, version[b], version[a] });
+		};
+		for (auto const& edge : edge_count)
+			push_edge(edge.first.first, edge.first.second);
+
+		// Check that the collapse from->to doesn't flip any triangle and keeps a manifold topology
+		auto is_valid_collapse = [&](int from, int to) {
+			int shared_triangle = 0;
+			for (int k_tri : vertex_triangle[from]) {
+				if (!triangle_alive[k_tri])
+					continue;
+				uint3 const& t = triangle[k_tri];
+				if (t[0] == to || t[1] == to || t[2] == to) {
+					shared_triangle++;
+					continue;
+				}
+				vec3 p[3] = { position[t[0]], position[t[1]], position[t[2]] };
+				vec3 const n_before = cross(p[1] - p[0], p[2] - p[0]);
+				for (int k = 0; k < 3; ++k)
+					if (t[k] == from)
+						p[k] = position[to];
+				vec3 const n_after = cross(p[1] - p[0], p[2] - p[0]);
+				if (dot(n_before, n_after) <= 0.2f * norm(n_before) * norm(n_after))
+					return false;
+			}
+
+			// Link condition: the two vertices can't have more common neighbors than the triangles along their edge
+			std::vector<int> const ring_from = one_ring(from);
+			std::vector<int> const ring_to = one_ring(to);
+			std::vector<int> common;
+			std::set_intersection(ring_from.begin(), ring_from.end(), ring_to.begin(), ring_to.end(), std::back_inserter(common));
+			return int(common.size()) <= shared_triangle;
+		};
+
+		vec3 p_min, p_max;
+		m.get_bounding_box_position(p_min, p_max);
+		double const error_limit = double(max_error) * norm(p_max - p_min);
+
+		int N_tri_alive = N_tri;
+		while (N_tri_alive > target_triangle && !queue.empty()) {
+			simplification_collapse const collapse = queue.top();
+			queue.pop();
+
+			int const from = collapse.from;
+			int const to = collapse.to;
+			if (!vertex_alive[from] || !vertex_alive[to] || version[from] != collapse.version_from || version[to] != collapse.version_to)
+				continue;
+			if (std::sqrt(collapse.error) > error_limit)
+				break;
+			if (!is_valid_collapse(from, to))
+				continue;
+
+			for (int k_tri : vertex_triangle[from]) {
+				if (!triangle_alive[k_tri])
+					continue;
+				uint3& t = triangle[k_tri];
+				if (t[0] == to || t[1] == to || t[2] == to) {
+					triangle_alive[k_tri] = 0;
+					N_tri_alive--;
+					continue;
+				}
+				for (int k = 0; k < 3; ++k)
+					if (t[k] == from)
+						t[k] = to;
+				vertex_triangle[to].push_back(k_tri);
+			}
+			vertex_alive[from] = 0;
+			quadric_add(Q[to], Q[from]);
+			version[to]++;
+
+			for (int v : one_ring(to))
+				push_edge(to, v);
+		}
+
+		// Compact the remaining vertices and triangles
+		mesh simplified;
+		std::vector<int> new_index(N_vertex, -1);
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri) {
+			if (!triangle_alive[k_tri])
+				continue;
+			uint3 f;
+			for (int k = 0; k < 3; ++k) {
+				int const v = triangle[k_tri][k];
+				if (new_index[v] < 0) {
+					new_index[v] = simplified.position.size();
+					int const k_input = vertex_to_input[v];
+					simplified.position.push_back(position[v]);
+					if (m.uv.size() == N_vertex_input)
+						simplified.uv.push_back(m.uv[k_input]);
+					if (m.color.size() == N_vertex_input)
+						simplified.color.push_back(m.color[k_input]);
+				}
+				f[k] = new_index[v];
+			}
+			simplified.connectivity.push_back(f);
+		}
+		if (m.normal.size() == N_vertex_input)
+			simplified.normal_update();
+
+		return simplified;
+	}
+
+	numarray<mesh> mesh_lod_chain(mesh const& m, int number_of_level, float triangle_ratio, float max_error)
+	{
+		numarray<mesh> lod;
+		lod.push_back(m);
+		for (int k_level = 1; k_level < number_of_level; ++k_level) {
+			mesh const& previous = lod[k_level - 1];
+			int const N_tri_previous = previous.connectivity.size();
+			mesh simplified = mesh_simplify(previous, int(triangle_ratio * N_tri_previous), max_error);
+
+			// Stop when the simplification is blocked by the error limit
+			if (simplified.connectivity.size() > 0.9f * N_tri_previous || simplified.connectivity.size() == 0)
+				break;
+			lod.push_back(simplified);
+		}
+		return lod;
+	}
+
+	float mesh_lod_screen_size(vec3 const& center, float radius, mat4 const& camera_view, mat4 const& camera_projection)
+	{
+		vec4 const p = camera_view * vec4(center, 1.0f);
+		float const depth = -p.z;
+		if (depth <= radius)
+			return 1e6f;
+		// The element (1,1) of the projection matrix is cot(fov_y/2): a height h at the given depth covers h*P(1,1)/(2*depth) of the screen height
+		return radius * camera_projection(1, 1) / depth;
+	}
+
+	int mesh_lod_select(float screen_size, numarray<float> const& screen_size_threshold)
+	{
+		int const N = screen_size_threshold.size();
+		for (int k = 0; k < N; ++k)
+			if (screen_size >= screen_size_threshold[k])
+				return k;
+		return N;
+	}
+}
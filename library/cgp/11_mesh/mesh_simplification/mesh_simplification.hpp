@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../mesh/mesh.hpp"
+
+
+namespace cgp
+{
+	/** Simplify a mesh by successive edge collapses ordered by their quadric error (M. Garland and P. Heckbert, "Surface Simplification Using Quadric Error Metrics")
+	* The vertices sharing the same position are merged before the simplification: the normals are recomputed, and the uv/color of the first vertex of each position are kept
+	* The collapses are constrained to the initial vertex positions, and are rejected if they flip a triangle or change the topology of the surface
+	* target_triangle: number of triangles to reach (the result may have more triangles if no valid collapse remains)
+	* max_error: maximal distance of a collapse expressed relatively to the diagonal of the bounding box (the simplification stops before exceeding it) */
+	mesh mesh_simplify(mesh const& m, int target_triangle, float max_error = 0.05f);
+
+	/** Compute a chain of levels of detail: level 0 is the input mesh, and each level is simplified from the previous one to triangle_ratio of its number of triangles
+	* The chain stops earlier if a simplification doesn't remove enough triangles */
+	numarray<mesh> mesh_lod_chain(mesh const& m, int number_of_level, float triangle_ratio = 0.5f, float max_error = 0.05f);
+
+	/** Approximated height of a bounding sphere on screen, relatively to the height of the viewport (1 = the sphere fills the screen vertically)
+	* Return a large value if the camera is inside the sphere */
+	float mesh_lod_screen_size(vec3 const& center, float radius, mat4 const& camera_view, mat4 const& camera_projection);
+
+	/** Index of the level of detail to use given the size on screen
+	* screen_size_threshold[k]: minimal screen size to use the level k (decreasing values)
+	* Return screen_size_threshold.size() below the last threshold (i.e. N thresholds select between N+1 levels) */
+	int mesh_lod_select(float screen_size, numarray<float> const& screen_size_threshold);
+}
@@ -1,5 +1,6 @@
 #pragma once
 
 #include "opengl_buffer/opengl_buffer.hpp"
+#include "stream_buffer/stream_buffer.hpp"
 #include "vbo/vbo.hpp"
 #include "ebo/ebo.hpp"
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include "stream_buffer.hpp"
+#include "../../debug/debug.hpp"
+#include "cgp/01_base/base.hpp"
+
+#include <cstring>
+
+namespace cgp
+{
+	void opengl_stream_buffer_structure::initialize(size_t region_size_arg, int number_of_regions_arg)
+	{
+		assert_cgp(region_size_arg > 0 && number_of_regions_arg > 0, "Stream buffer should have a non zero size");
+		if (id != 0)
+			clear();
+
+		region_size = region_size_arg;
+		number_of_regions = number_of_regions_arg;
+		current_region = -1;
+		number_of_stall = 0;
+		fence.assign(number_of_regions, nullptr);
+
+		GLsizeiptr const total_size = GLsizeiptr(region_size * number_of_regions);
+		glGenBuffers(1, &id);              opengl_check;
+		glBindBuffer(GL_ARRAY_BUFFER, id); opengl_check;
+#if !defined(__EMSCRIPTEN__) && CGP_OPENGL_VERSION_MAJOR==4 && CGP_OPENGL_VERSION_MINOR>=4
+		GLbitfield const flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, total_size, nullptr, flags); opengl_check;
+		persistent_data = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, total_size, flags)); opengl_check;
+#else
+		glBufferData(GL_ARRAY_BUFFER, total_size, nullptr, GL_STREAM_DRAW); opengl_check;
+#endif
+		glBindBuffer(GL_ARRAY_BUFFER, 0);  opengl_check;
+	}
+
+	size_t opengl_stream_buffer_structure::next_region()
+	{
+		assert_cgp(id != 0, "Stream buffer used before its initialization");
+
+#ifndef __EMSCRIPTEN__
+		// The region filled previously is released once the commands issued until now (the draw calls reading it) are completed
+		if (current_region >= 0 && fence[current_region] == nullptr) {
+			fence[current_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0); opengl_check;
+		}
+#endif
+
+		current_region = (current_region + 1) % number_of_regions;
+
+#ifndef __EMSCRIPTEN__
+		GLsync& region_fence = fence[current_region];
+		if (region_fence != nullptr) {
+			GLenum status = glClientWaitSync(region_fence, 0, 0);
+			if (status == GL_TIMEOUT_EXPIRED) {
+				number_of_stall++;
+				do {
+					status = glClientWaitSync(region_fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1ms
+				} while (status == GL_TIMEOUT_EXPIRED);
+			}
+			glDeleteSync(region_fence); opengl_check;
+			region_fence = nullptr;
+		}
+#endif
+
+		return current_region * region_size;
+	}
+
+	size_t opengl_stream_buffer_structure::write(void const* data, size_t size_byte)
+	{
+		assert_cgp(size_byte <= region_size, "Cannot write more data than the size of a region in the stream buffer");
+
+		size_t const offset = next_region();
+		if (persistent_data != nullptr) {
+			std::memcpy(persistent_data + offset, data, size_byte);
+			return offset;
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, id); opengl_check;
+#ifndef __EMSCRIPTEN__
+		// The fence guarantees the region is not read anymore: no implicit synchronization is needed
+		void* region = glMapBufferRange(GL_ARRAY_BUFFER, GLintptr(offset), GLsizeiptr(size_byte), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT); opengl_check;
+		if (region != nullptr) {
+			std::memcpy(region, data, size_byte);
+			glUnmapBuffer(GL_ARRAY_BUFFER); opengl_check;
+		}
+		else {
+			glBufferSubData(GL_ARRAY_BUFFER, GLintptr(offset), GLsizeiptr(size_byte), data); opengl_check;
+		}
+#else
+		glBufferSubData(GL_ARRAY_BUFFER, GLintptr(offset), GLsizeiptr(size_byte), data); opengl_check;
+#endif
+		glBindBuffer(GL_ARRAY_BUFFER, 0); opengl_check;
+
+		return offset;
+	}
+
+	size_t opengl_stream_buffer_structure::copy_from_buffer(GLuint source_buffer, size_t size_byte)
+	{
+		assert_cgp(size_byte <= region_size, "Cannot copy more data than the size of a region in the stream buffer");
+
+		size_t const offset = next_region();
+		glBindBuffer(GL_COPY_READ_BUFFER, source_buffer); opengl_check;
+		glBindBuffer(GL_COPY_WRITE_BUFFER, id);           opengl_check;
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, GLintptr(offset), GLsizeiptr(size_byte)); opengl_check;
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);             opengl_check;
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);            opengl_check;
+
+		return offset;
+	}
+
+	void opengl_stream_buffer_structure::clear()
+	{
+#ifndef __EMSCRIPTEN__
+		for (GLsync& f : fence) {
+			if (f != nullptr)
+				glDeleteSync(f);
+			f = nullptr;
+		}
+#endif
+		fence.clear();
+
+		if (persistent_data != nullptr) {
+			glBindBuffer(GL_ARRAY_BUFFER, id); opengl_check;
+			glUnmapBuffer(GL_ARRAY_BUFFER);    opengl_check;
+			glBindBuffer(GL_ARRAY_BUFFER, 0);  opengl_check;
+			persistent_data = nullptr;
+		}
+		if (id != 0) {
+			glDeleteBuffers(1, &id); opengl_check;
+		}
+
+		id = 0;
+		region_size = 0;
+		number_of_regions = 0;
+		current_region = -1;
+	}
+}
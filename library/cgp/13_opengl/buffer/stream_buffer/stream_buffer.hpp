@@ -0,0 +1,53 @@
+#pragma once
+
+#include "cgp/opengl_include.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace cgp
+{
+	// Ring of regions in a single GL_ARRAY_BUFFER used to stream per-frame dynamic data (ex. skinned positions)
+	//  Each call to write() fills the next region while the GPU may still read the previous ones.
+	//  A fence is placed on a region once it has been used, and write() only waits for this fence when the ring wraps around
+	//   (with 3 regions, the CPU stalls only if the GPU is more than 2 updates late).
+	//  The storage is persistently mapped when the OpenGL version provides glBufferStorage (>=4.4),
+	//   otherwise each region is mapped without synchronization (GL_MAP_UNSYNCHRONIZED_BIT) as the fences already guarantee it is not in use.
+	//  Under Emscripten (no buffer mapping in WebGL), the regions are filled with glBufferSubData.
+	struct opengl_stream_buffer_structure
+	{
+		GLuint id = 0;
+		size_t region_size = 0;      // Size in bytes of one region
+		int number_of_regions = 0;
+		int current_region = -1;     // Region filled by the last call to write()
+
+		// Number of calls to write() that had to wait for the GPU (should remain 0 in normal condition)
+		int number_of_stall = 0;
+
+		opengl_stream_buffer_structure() = default;
+		opengl_stream_buffer_structure(opengl_stream_buffer_structure const&) = delete;
+		opengl_stream_buffer_structure& operator=(opengl_stream_buffer_structure const&) = delete;
+
+		// Allocate the buffer storage (region_size x number_of_regions bytes)
+		void initialize(size_t region_size, int number_of_regions = 3);
+
+		// Copy the data in the next region and return the offset of this region in the buffer (in bytes)
+		//  size_byte must be <= region_size
+		size_t write(void const* data, size_t size_byte);
+
+		// Copy the content of another buffer in the next region and return its offset (used to convert an existing VBO)
+		size_t copy_from_buffer(GLuint source_buffer, size_t size_byte);
+
+		// Release the buffer and the fences
+		void clear();
+
+		bool is_persistent() const { return persistent_data != nullptr; }
+
+	private:
+		// Move to the next region, waiting for the GPU to release it if needed
+		size_t next_region();
+
+		std::vector<GLsync> fence;
+		unsigned char* persistent_data = nullptr;
+	};
+}
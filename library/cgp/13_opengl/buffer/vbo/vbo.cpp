@@ -63,9 +63,32 @@ namespace cgp
 		details.size_element = 4;
 		details.type_element = GL_FLOAT;
 	}
+	void opengl_vbo_structure::initialize_data_on_gpu(numarray<unsigned char> const& data, GLuint stride, GLuint div)
+	{
+		if(id!=0){
+			warning_initialize_non_empty();
+		}
+		assert_cgp(stride>0 && data.size()%stride==0, "Interleaved data size should be a multiple of the stride");
+
+		divisor = div;
+		glGenBuffers(1, &id);                                                                 opengl_check;
+		glBindBuffer(GL_ARRAY_BUFFER, id);                                                    opengl_check;
+		glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(data.size()), data.data.data(), GL_STATIC_DRAW); opengl_check;
+		glBindBuffer(GL_ARRAY_BUFFER, 0);                                                     opengl_check;
+		size = data.size()/stride;
+		type = GL_ARRAY_BUFFER;
+
+		details.size_byte = data.size();
+		details.size_element = stride;
+		details.type_element = GL_UNSIGNED_BYTE;
+	}
 	void opengl_vbo_structure::update(numarray<vec2> const& data, int size_elements_update)
 	{
 		assert_cgp(size_elements_update <= data.size(), "Cannot update VBO with more elements than data");
+		if (update_mode == opengl_vbo_update_mode::stream) {
+			stream_offset = stream->write(ptr(data), size_elements_update == -1 ? size_in_memory(data) : 2 * sizeof(float) * size_elements_update);
+			return;
+		}
 		glBindBuffer(GL_ARRAY_BUFFER, id); opengl_check;
 		if (size_elements_update == -1) {
 			glBufferSubData(GL_ARRAY_BUFFER, 0, size_in_memory(data), ptr(data));  opengl_check;
@@ -77,6 +100,10 @@ namespace cgp
 	void opengl_vbo_structure::update(numarray<vec3> const& data, int size_elements_update)
 	{
 		assert_cgp(size_elements_update <= data.size(), "Cannot update VBO with more elements than data");
+		if (update_mode == opengl_vbo_update_mode::stream) {
+			stream_offset = stream->write(ptr(data), size_elements_update == -1 ? size_in_memory(data) : 3 * sizeof(float) * size_elements_update);
+			return;
+		}
 		glBindBuffer(GL_ARRAY_BUFFER, id); opengl_check;
 		if (size_elements_update == -1) {
 			glBufferSubData(GL_ARRAY_BUFFER, 0, size_in_memory(data), ptr(data));  opengl_check;
@@ -88,6 +115,10 @@ namespace cgp
 	void opengl_vbo_structure::update(numarray<vec4> const& data, int size_elements_update)
 	{
 		assert_cgp(size_elements_update <= data.size(), "Cannot update VBO with more elements than data");
+		if (update_mode == opengl_vbo_update_mode::stream) {
+			stream_offset = stream->write(ptr(data), size_elements_update == -1 ? size_in_memory(data) : 4 * sizeof(float) * size_elements_update);
+			return;
+		}
 		glBindBuffer(GL_ARRAY_BUFFER, id); opengl_check;
 		if (size_elements_update == -1) {
 			glBufferSubData(GL_ARRAY_BUFFER, 0, size_in_memory(data), ptr(data));  opengl_check;
@@ -97,16 +128,64 @@ namespace cgp
 		}
 	}
 
+	void opengl_vbo_structure::set_update_mode(opengl_vbo_update_mode mode, int number_of_regions)
+	{
+		if (mode == update_mode)
+			return;
+		assert_cgp(mode == opengl_vbo_update_mode::stream, "A VBO in stream mode cannot be switched back to the sub_data mode (clear and initialize it again)");
+		assert_cgp(id != 0, "The VBO must be initialized before setting its update mode");
+
+		// The current content becomes the first region of the ring buffer
+		stream = std::make_shared<opengl_stream_buffer_structure>();
+		stream->initialize(details.size_byte, number_of_regions);
+		stream_offset = stream->copy_from_buffer(id, details.size_byte);
+
+		glDeleteBuffers(1, &id); opengl_check;
+		id = stream->id;
+		update_mode = mode;
+	}
+
+	void opengl_vbo_structure::clear()
+	{
+		if (stream != nullptr) {
+			stream->clear();
+			stream = nullptr;
+			id = 0;
+		}
+		update_mode = opengl_vbo_update_mode::sub_data;
+		stream_offset = 0;
+		opengl_gpu_buffer::clear();
+	}
+
 
 	void opengl_set_vao_location(opengl_vbo_structure const& vbo, GLuint location_index)
 	{
 		vbo.bind();
 		glEnableVertexAttribArray(location_index); opengl_check
-		glVertexAttribPointer(location_index, vbo.details.size_element, vbo.details.type_element, GL_FALSE, 0, nullptr); opengl_check
+		glVertexAttribPointer(location_index, vbo.details.size_element, vbo.details.type_element, GL_FALSE, 0, reinterpret_cast<void const*>(vbo.stream_offset)); opengl_check
+		vbo.unbind();
+		if (vbo.divisor>0) { glVertexAttribDivisor(location_index, vbo.divisor);                                         opengl_check; }
+	}
+
+
+	void opengl_set_vao_location_interleaved(opengl_vbo_structure const& vbo, GLuint location_index, GLint size_element, GLenum type_element, bool normalized, size_t offset)
+	{
+		vbo.bind();
+		glEnableVertexAttribArray(location_index); opengl_check
+		glVertexAttribPointer(location_index, size_element, type_element, normalized ? GL_TRUE : GL_FALSE, GLsizei(vbo.details.size_element), reinterpret_cast<void const*>(offset)); opengl_check
 		vbo.unbind();
 		if (vbo.divisor>0) { glVertexAttribDivisor(location_index, vbo.divisor);                                         opengl_check; }
 	}
 
+	void opengl_update_vao_location_stream(opengl_vbo_structure const& vbo, GLuint location_index)
+	{
+		if (vbo.update_mode != opengl_vbo_update_mode::stream)
+			return;
+		vbo.bind();
+		glVertexAttribPointer(location_index, vbo.details.size_element, vbo.details.type_element, GL_FALSE, 0, reinterpret_cast<void const*>(vbo.stream_offset)); opengl_check
+		vbo.unbind();
+	}
+
 
 	static void warning_initialize_non_empty()
 	{
@@ -1,20 +1,33 @@
 #pragma once
 
 #include "../opengl_buffer/opengl_buffer.hpp"
+#include "../stream_buffer/stream_buffer.hpp"
 #include "cgp/02_numarray/numarray.hpp"
 #include "cgp/05_vec/vec.hpp"
 #include "cgp/06_mat/mat.hpp"
 
+#include <memory>
 
 
 namespace cgp
 {
+	// How the content of a VBO is re-written by update()
+	//  sub_data: glBufferSubData in the same storage (the driver may stall if the GPU is still reading the previous content)
+	//  stream: the data is written in the next region of a ring buffer (opengl_stream_buffer_structure), for data updated every frame.
+	//          The VAO must then point to the current region before each draw call (see opengl_update_vao_location_stream)
+	enum class opengl_vbo_update_mode { sub_data, stream };
+
 	struct opengl_vbo_structure : opengl_gpu_buffer
 	{
 		void initialize_data_on_gpu(numarray<vec3> const& data, GLuint divisor = 0);
 		void initialize_data_on_gpu(numarray<vec2> const& data, GLuint divisor = 0);
 		void initialize_data_on_gpu(numarray<vec4> const& data, GLuint divisor = 0);
 
+		/** Initialize the VBO from raw interleaved data (several attributes per vertex, each vertex taking stride bytes)
+		* The layout of the attributes is given when setting the VAO locations with opengl_set_vao_location_interleaved
+		* - details.size_element stores the stride, and details.type_element is GL_UNSIGNED_BYTE */
+		void initialize_data_on_gpu(numarray<unsigned char> const& data, GLuint stride, GLuint divisor = 0);
+
 		/** Re-write data on the VBO. (without re-allocation) in calling glBufferSubData
 		* - size_elements_update: 
 		*   number of elements to sent from data
@@ -23,10 +36,31 @@ namespace cgp
 		void update(numarray<vec3> const& data, int size_elements_update = -1);
 		void update(numarray<vec4> const& data, int size_elements_update = -1);
 
+		/** Switch an initialized VBO to the stream update mode (its current content is kept)
+		* - In stream mode, the elements that are not sent by update() (size_elements_update < size) have undefined values */
+		void set_update_mode(opengl_vbo_update_mode mode, int number_of_regions = 3);
+
+		// Release the GPU memory (including the stream buffer)
+		void clear();
+
 		GLuint divisor;
+
+		opengl_vbo_update_mode update_mode = opengl_vbo_update_mode::sub_data;
+		std::shared_ptr<opengl_stream_buffer_structure> stream; // Ring buffer used in stream mode (shared by the copies of the VBO)
+		size_t stream_offset = 0; // Offset in bytes of the current region in stream mode
 	};
 
 	/** Call glVertexAttribPointer and set the correspondance between VBO and the location in the shader */
 	void opengl_set_vao_location(opengl_vbo_structure const& vbo, GLuint location_index);
 
+	/** Set the correspondance between one attribute of an interleaved VBO and the location in the shader
+	* - size_element, type_element: number and type of components of the attribute (ex. 4, GL_INT_2_10_10_10_REV)
+	* - normalized: fixed-point components are converted to [-1,1] (signed) or [0,1] (unsigned)
+	* - offset: offset in bytes of the attribute in the vertex */
+	void opengl_set_vao_location_interleaved(opengl_vbo_structure const& vbo, GLuint location_index, GLint size_element, GLenum type_element, bool normalized, size_t offset);
+
+	/** Point the attribute of the currently bound VAO to the current region of a VBO in stream mode (no effect in sub_data mode)
+	* - Must be called after binding the VAO and before the draw call, as the region changes at each update */
+	void opengl_update_vao_location_stream(opengl_vbo_structure const& vbo, GLuint location_index);
+
 }
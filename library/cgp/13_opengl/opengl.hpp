@@ -7,5 +7,6 @@
 #include "uniform/uniform.hpp"
 #include "shaders/shaders.hpp"
 #include "texture/texture.hpp"
+#include "texture_async_loader/texture_async_loader.hpp"
 #include "fbo/fbo.hpp"
 #include "emscripten/emscripten.hpp"
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "program_binary_cache.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/03_files/files.hpp"
+#include "cgp/13_opengl/debug/debug.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Constants of GL_ARB_get_program_binary (not defined in the OpenGL 3.3 headers)
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+namespace cgp
+{
+#ifndef __EMSCRIPTEN__
+	typedef void (APIENTRYP program_binary_get_function)(GLuint program, GLsizei buffer_size, GLsizei* length, GLenum* binary_format, void* binary);
+	typedef void (APIENTRYP program_binary_set_function)(GLuint program, GLenum binary_format, const void* binary, GLsizei length);
+	typedef void (APIENTRYP program_parameteri_function)(GLuint program, GLenum pname, GLint value);
+#endif
+
+	// Header of a cached binary file
+	static char const program_binary_magic[8] = { 'C','G','P','P','R','O','G','1' };
+
+	// 64-bit FNV-1a hash
+	static uint64_t hash_fnv1a(std::string const& text, uint64_t hash = 14695981039346656037ull)
+	{
+		for (unsigned char c : text) {
+			hash ^= c;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	static void create_directory(std::string const& path)
+	{
+		if (check_path_exist(path))
+			return;
+#ifdef _WIN32
+		_mkdir(path.c_str());
+#else
+		mkdir(path.c_str(), 0755);
+#endif
+	}
+
+	void program_binary_cache_structure::initialize(void* (*get_proc_address)(const char* name))
+	{
+#ifndef __EMSCRIPTEN__
+		GLint number_of_format = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &number_of_format);
+		glGetError(); // GL_NUM_PROGRAM_BINARY_FORMATS is an invalid enum if the extension is not supported
+
+		get_program_binary = nullptr;
+		program_binary = nullptr;
+		program_parameteri = nullptr;
+		if (number_of_format > 0) {
+			get_program_binary = get_proc_address("glGetProgramBinary");
+			program_binary = get_proc_address("glProgramBinary");
+			program_parameteri = get_proc_address("glProgramParameteri");
+		}
+
+		auto gl_string = [](GLenum name) {
+			GLubyte const* s = glGetString(name);
+			return s == nullptr ? std::string() : std::string(reinterpret_cast<char const*>(s));
+		};
+		driver_string = gl_string(GL_VENDOR) + "|" + gl_string(GL_RENDERER) + "|" + gl_string(GL_VERSION);
+#else
+		(void)get_proc_address;
+#endif
+	}
+
+	bool program_binary_cache_structure::is_active() const
+	{
+		return directory.size() > 0 && get_program_binary != nullptr && program_binary != nullptr && program_parameteri != nullptr;
+	}
+
+	std::string program_binary_cache_structure::filename(std::string const& vertex_shader_text, std::string const& fragment_shader_text) const
+	{
+		uint64_t hash = hash_fnv1a(vertex_shader_text);
+		hash = hash_fnv1a(std::string(1, '\0') + fragment_shader_text, hash);
+		hash = hash_fnv1a(std::string(1, '\0') + driver_string, hash);
+
+		std::ostringstream s;
+		s << std::hex << hash;
+
+		std::string path = directory;
+		if (path.size() > 0 && path.back() != '/' && path.back() != '\\')
+			path += '/';
+		return path + s.str() + ".bin";
+	}
+
+	GLuint program_binary_cache_structure::load(std::string const& vertex_shader_text, std::string const& fragment_shader_text) const
+	{
+#ifndef __EMSCRIPTEN__
+		if (!is_active())
+			return 0;
+
+		std::string const path = filename(vertex_shader_text, fragment_shader_text);
+		if (!check_file_exist(path))
+			return 0;
+
+		std::vector<char> const data = read_from_file_binary(path);
+		size_t const header_size = sizeof(program_binary_magic) + sizeof(uint32_t);
+		if (data.size() <= header_size || std::memcmp(data.data(), program_binary_magic, sizeof(program_binary_magic)) != 0)
+			return 0;
+
+		uint32_t binary_format = 0;
+		std::memcpy(&binary_format, data.data() + sizeof(program_binary_magic), sizeof(uint32_t));
+
+		GLuint const program = glCreateProgram();
+		reinterpret_cast<program_binary_set_function>(program_binary)(program, GLenum(binary_format), data.data() + header_size, GLsizei(data.size() - header_size));
+
+		// The binary is rejected if the driver has been updated
+		GLint is_linked = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &is_linked);
+		if (is_linked == GL_FALSE) {
+			glGetError();
+			glDeleteProgram(program);
+			return 0;
+		}
+		return program;
+#else
+		(void)vertex_shader_text; (void)fragment_shader_text;
+		return 0;
+#endif
+	}
+
+	void program_binary_cache_structure::prepare_before_link(GLuint program) const
+	{
+#ifndef __EMSCRIPTEN__
+		if (is_active())
+			reinterpret_cast<program_parameteri_function>(program_parameteri)(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#else
+		(void)program;
+#endif
+	}
+
+	void program_binary_cache_structure::save(std::string const& vertex_shader_text, std::string const& fragment_shader_text, GLuint program) const
+	{
+#ifndef __EMSCRIPTEN__
+		if (!is_active())
+			return;
+
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0)
+			return;
+
+		std::vector<char> binary(length);
+		GLenum binary_format = 0;
+		GLsizei written = 0;
+		reinterpret_cast<program_binary_get_function>(get_program_binary)(program, length, &written, &binary_format, binary.data());
+		if (written <= 0)
+			return;
+
+		create_directory(directory);
+		std::string const path = filename(vertex_shader_text, fragment_shader_text);
+		std::ofstream stream(path, std::ios::binary);
+		if (!stream.is_open()) {
+			std::cout << "Warning: cannot write the shader program cache file " << path << std::endl;
+			return;
+		}
+		uint32_t const format = binary_format;
+		stream.write(program_binary_magic, sizeof(program_binary_magic));
+		stream.write(reinterpret_cast<char const*>(&format), sizeof(uint32_t));
+		stream.write(binary.data(), written);
+#else
+		(void)vertex_shader_text; (void)fragment_shader_text; (void)program;
+#endif
+	}
+}
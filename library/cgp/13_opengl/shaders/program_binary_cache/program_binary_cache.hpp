@@ -0,0 +1,47 @@
+#pragma once
+
+#include "cgp/opengl_include.hpp"
+
+#include <string>
+
+namespace cgp
+{
+	// On-disk cache of linked shader programs (glGetProgramBinary / glProgramBinary)
+	//  Each program is stored in the file [directory]/[key].bin, where the key is a hash of the shader sources and of the driver (vendor, renderer, version)
+	//  The binary is only valid for the exact driver that produced it: a program rejected by glProgramBinary is compiled again and its file is replaced.
+	//  The entry points are queried at runtime (core in OpenGL 4.1, extension GL_ARB_get_program_binary for OpenGL 3.3),
+	//   the cache is inactive if the driver doesn't expose any binary format.
+	// Usage:
+	//   opengl_shader_structure::program_binary_cache.directory = "cache/";  (empty directory = cache disabled)
+	struct program_binary_cache_structure
+	{
+		// Directory where the binaries are stored (created if needed). Empty = cache disabled
+		std::string directory;
+
+		// Query the program binary functions of the current context
+		//  Called by the window initialization once the OpenGL context is created
+		void initialize(void* (*get_proc_address)(const char* name));
+
+		// True if the functions are available and the directory is set
+		bool is_active() const;
+
+		// Create a program from the cached binary of these sources. Return 0 if there is no valid cached binary
+		GLuint load(std::string const& vertex_shader_text, std::string const& fragment_shader_text) const;
+
+		// Must be called before linking a program to be able to save its binary afterward
+		void prepare_before_link(GLuint program) const;
+
+		// Write the binary of the linked program in the cache
+		void save(std::string const& vertex_shader_text, std::string const& fragment_shader_text, GLuint program) const;
+
+		// Filename of the cached binary for the given sources (depends on the current driver)
+		std::string filename(std::string const& vertex_shader_text, std::string const& fragment_shader_text) const;
+
+
+		// Internal: entry points queried from the context
+		void* get_program_binary = nullptr;
+		void* program_binary = nullptr;
+		void* program_parameteri = nullptr;
+		std::string driver_string;
+	};
+}
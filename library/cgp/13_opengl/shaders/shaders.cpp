@@ -4,11 +4,45 @@
 #include "cgp/03_files/files.hpp"
 #include "cgp/13_opengl/debug/debug.hpp"
 #include <iostream>
+#include <map>
 
 namespace cgp
 {
     // Initialization of the static variable for the cache
     cache_uniform_location_structure opengl_shader_structure::cache_uniform_location;
+    program_binary_cache_structure opengl_shader_structure::program_binary_cache;
+
+    // Programs already created, indexed by their sources: identical sources are compiled and linked only once
+    static std::map<std::string, GLuint> shared_program;
+
+    static std::string shared_program_key(std::string const& vertex_shader_text, std::string const& fragment_shader_text)
+    {
+        return vertex_shader_text + '\0' + fragment_shader_text;
+    }
+
+    // Return an existing program with these sources (already loaded, or read from the program binary cache). Return 0 if none is found.
+    static GLuint find_existing_program(std::string const& vertex_shader_text, std::string const& fragment_shader_text, std::string& origin)
+    {
+        std::string const key = shared_program_key(vertex_shader_text, fragment_shader_text);
+        auto const it = shared_program.find(key);
+        if (it != shared_program.end() && glIsProgram(it->second)) {
+            origin = "shared with a previous shader";
+            return it->second;
+        }
+
+        GLuint const program_id = opengl_shader_structure::program_binary_cache.load(vertex_shader_text, fragment_shader_text);
+        if (program_id != 0) {
+            origin = "loaded from the program cache";
+            shared_program[key] = program_id;
+        }
+        return program_id;
+    }
+
+    static void register_new_program(std::string const& vertex_shader_text, std::string const& fragment_shader_text, GLuint program_id)
+    {
+        shared_program[shared_program_key(vertex_shader_text, fragment_shader_text)] = program_id;
+        opengl_shader_structure::program_binary_cache.save(vertex_shader_text, fragment_shader_text, program_id);
+    }
 
 
     /** Load and compile shaders from glsl file sources
@@ -63,6 +97,19 @@ namespace cgp
     }
 
 
+    std::string opengl_shader_insert_defines(std::string const& shader_text, std::string const& defines)
+    {
+        // The #version directive must remain the first line of the shader
+        size_t const version = shader_text.find("#version");
+        if (version == std::string::npos)
+            return defines + shader_text;
+        size_t const end_line = shader_text.find('\n', version);
+        if (end_line == std::string::npos)
+            return shader_text + "\n" + defines;
+        return shader_text.substr(0, end_line + 1) + defines + shader_text.substr(end_line + 1);
+    }
+
+
     GLint opengl_shader_structure::query_uniform_location(std::string const& uniform_name) const
     {
         return cache_uniform_location.query(id, uniform_name);
@@ -153,6 +200,14 @@ namespace cgp
     
 	GLuint opengl_load_shader_from_text(std::string const& vertex_shader_txt, std::string const& fragment_shader_txt, bool* load_shader_ok)
 	{
+        std::string origin;
+        GLuint const existing_program_id = find_existing_program(vertex_shader_txt, fragment_shader_txt, origin);
+        if (existing_program_id != 0) {
+            if (load_shader_ok != nullptr)
+                *load_shader_ok = true;
+            return existing_program_id;
+        }
+
         GLuint vertex_shader_id; 
         GLuint fragment_shader_id; 
         bool vertex_ok = compile_shader(GL_VERTEX_SHADER, vertex_shader_txt, vertex_shader_id);
@@ -177,6 +232,7 @@ namespace cgp
         glAttachShader( program_id, fragment_shader_id );
 
         // Link Program
+        opengl_shader_structure::program_binary_cache.prepare_before_link(program_id);
         glLinkProgram( program_id );
 
         bool link_ok = check_link(vertex_shader_id, fragment_shader_id, program_id);
@@ -190,6 +246,10 @@ namespace cgp
         // Shader can be detached.
         glDetachShader( program_id, vertex_shader_id);
         glDetachShader( program_id, fragment_shader_id);
+        glDeleteShader( vertex_shader_id);
+        glDeleteShader( fragment_shader_id);
+
+        register_new_program(vertex_shader_txt, fragment_shader_txt, program_id);
 
         if (load_shader_ok != nullptr)
             *load_shader_ok = true;
@@ -235,6 +295,15 @@ namespace cgp
         }
 #endif
         
+        // Reuse an existing program with the same sources
+        std::string origin;
+        GLuint const existing_program_id = find_existing_program(vertex_shader_text, fragment_shader_text, origin);
+        if (existing_program_id != 0) {
+            std::string msg = "  [info] Shader " + origin + " [ID=" + str(existing_program_id) + "]\n";
+            msg            += "         (" + vertex_shader_path + ", " + fragment_shader_path + ")\n";
+            std::cout << msg << std::endl;
+            return existing_program_id;
+        }
 
 
         // Compile the programs
@@ -267,6 +336,7 @@ namespace cgp
         glAttachShader(program_id, fragment_shader_id);
 
         // Link Program
+        opengl_shader_structure::program_binary_cache.prepare_before_link(program_id);
         glLinkProgram(program_id);
 
         bool const shader_program_valid = check_link(vertex_shader_id, fragment_shader_id, program_id);
@@ -279,6 +349,10 @@ namespace cgp
         // Shader can be detached.
         glDetachShader(program_id, vertex_shader_id);
         glDetachShader(program_id, fragment_shader_id);
+        glDeleteShader(vertex_shader_id);
+        glDeleteShader(fragment_shader_id);
+
+        register_new_program(vertex_shader_text, fragment_shader_text, program_id);
 
 
         // Debug info
@@ -3,6 +3,7 @@
 #include "cgp/opengl_include.hpp"
 
 #include "cache_uniform_location/cache_uniform_location.hpp"
+#include "program_binary_cache/program_binary_cache.hpp"
 
 
 namespace cgp
@@ -23,6 +24,8 @@ namespace cgp
 		//      # opengl 300 es
 		//      # precision mediump float;
 		// This function raises an error if the shader cannot be loaded succesfully and the program stop indicating an error.
+		// Shaders with identical sources share the same program (the sources are compiled and linked only once),
+		//  and the linked program is read from/written to the program_binary_cache when it is active.
 		void load(std::string const& vertex_shader_path, std::string const& fragment_shader_path, bool adapt_opengles=true);
 
 		// Load a new shader from inline text
@@ -39,6 +42,9 @@ namespace cgp
 		// Debug information of the current cache storage between uniform name and location
 		static std::string debug_dump_cache_uniform_location();
 
+		// On-disk cache of the linked programs, shared by all the shaders (disabled until its directory is set)
+		static program_binary_cache_structure program_binary_cache;
+
 	private:
 		// Global caching system to store the correspondance between a uniform name and its location for a given shader
 		// Usage: location = cache_uniform_location.query(shaderID, uniformName)
@@ -48,6 +54,10 @@ namespace cgp
 		static cache_uniform_location_structure cache_uniform_location;
 	};
 
+	// Insert preprocessor definitions (ex. "#define USE_TEXTURE 1\n") in a shader source, right after its #version line
+	//  Used to compile variants of the same shader where some options are known at compile time
+	std::string opengl_shader_insert_defines(std::string const& shader_text, std::string const& defines);
+
 
 
 
@@ -12,6 +12,7 @@ namespace cgp
         case GL_RGB32F:
             return GL_RGB;
         case GL_RGBA8:
+        case GL_RGBA32F:
             return GL_RGBA;
         case GL_DEPTH_COMPONENT:
             return GL_DEPTH_COMPONENT24;
@@ -30,6 +31,7 @@ namespace cgp
         case GL_RGBA8:
             return GL_UNSIGNED_BYTE;
         case GL_RGB32F:
+        case GL_RGBA32F:
             return GL_FLOAT;
         case GL_DEPTH_COMPONENT:
             return GL_UNSIGNED_INT;
@@ -126,6 +128,21 @@ namespace cgp
 
     }
 
+    void opengl_texture_image_structure::initialize_texture_2d_on_gpu(grid_2D<vec4> const& im, GLint wrap_s, GLint wrap_t, bool is_mippmap, GLint texture_mag_filter, GLint texture_min_filter)
+    {
+        // Store parameters
+        width = im.dimension.x;
+        height = im.dimension.y;
+        format = GL_RGBA32F;
+        texture_type = GL_TEXTURE_2D;
+
+        // Initialize texture data on GPU
+        id = opengl_initialize_texture_2d_on_gpu(width, height, ptr(im.data),
+            wrap_s, wrap_t, texture_type, format, format_to_data_type(format), format_to_component(format),
+            is_mippmap, texture_mag_filter, texture_min_filter);
+
+    }
+
     void opengl_texture_image_structure::initialize_texture_2d_on_gpu(int width_arg, int height_arg, GLint format_arg, GLenum texture_type_arg, GLint wrap_s, GLint wrap_t, GLint texture_mag_filter, GLint texture_min_filter)
     {
         // Store parameters
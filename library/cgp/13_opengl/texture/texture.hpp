@@ -18,7 +18,7 @@ namespace cgp
 		int width;  // image width
 		int height; // image height
 
-		GLint format; // GL_RGB8, GL_RGBA8, GL_RGBF32
+		GLint format; // GL_RGB8, GL_RGBA8, GL_RGBF32, GL_RGBA32F
 
 		GLenum texture_type; // = GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP
 
@@ -43,6 +43,10 @@ namespace cgp
 		// Initialize a GL_TEXTURE_2D from a float grid
 		void initialize_texture_2d_on_gpu(grid_2D<vec3> const& im, GLint wrap_s = GL_CLAMP_TO_EDGE, GLint wrap_t = GL_CLAMP_TO_EDGE, bool is_mipmap = true, GLint texture_mag_filter = GL_LINEAR, GLint texture_min_filter = GL_LINEAR_MIPMAP_LINEAR);
 
+		// Initialize a GL_TEXTURE_2D from a float grid with 4 components (GL_RGBA32F)
+		//  Can be used to store generic float data read with texelFetch (use GL_NEAREST filtering and no mipmap in this case)
+		void initialize_texture_2d_on_gpu(grid_2D<vec4> const& im, GLint wrap_s = GL_CLAMP_TO_EDGE, GLint wrap_t = GL_CLAMP_TO_EDGE, bool is_mipmap = true, GLint texture_mag_filter = GL_LINEAR, GLint texture_min_filter = GL_LINEAR_MIPMAP_LINEAR);
+
 		// Initialize a CUBEMAP on GPU from 6 squared images
 		void initialize_cubemap_on_gpu(image_structure const& x_neg, image_structure const& x_pos, image_structure const& y_neg, image_structure const& y_pos, image_structure const& z_neg, image_structure const& z_pos);
 
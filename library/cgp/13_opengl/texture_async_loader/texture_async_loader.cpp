@@ -0,0 +1,250 @@
+#include "texture_async_loader.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/03_files/files.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace cgp
+{
+	opengl_texture_async_loader_structure::~opengl_texture_async_loader_structure()
+	{
+		// Only stop the threads: the OpenGL context may already be destroyed at this point
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+		condition_decode.notify_all();
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	opengl_texture_image_structure opengl_texture_async_loader_structure::load_texture_2d(std::string const& filename, GLint wrap_s, GLint wrap_t, bool is_mipmap, GLint texture_mag_filter, GLint texture_min_filter, vec3 const& placeholder_color)
+	{
+		opengl_texture_image_structure texture;
+
+#ifdef __EMSCRIPTEN__
+		texture.load_and_initialize_texture_2d_on_gpu(filename, wrap_s, wrap_t, is_mipmap, texture_mag_filter, texture_min_filter);
+#else
+		numarray<unsigned char> const placeholder_data = {
+			(unsigned char)(255 * placeholder_color.x), (unsigned char)(255 * placeholder_color.y), (unsigned char)(255 * placeholder_color.z) };
+		image_structure const placeholder(1, 1, image_color_type::rgb, placeholder_data);
+		texture.initialize_texture_2d_on_gpu(placeholder, wrap_s, wrap_t, false, GL_NEAREST, GL_NEAREST);
+
+		auto request = std::make_shared<request_structure>();
+		request->filename = filename;
+		request->texture_id = texture.id;
+		request->wrap_s = wrap_s;
+		request->wrap_t = wrap_t;
+		request->is_mipmap = is_mipmap;
+		request->texture_mag_filter = texture_mag_filter;
+		request->texture_min_filter = texture_min_filter;
+
+		if (workers.size() == 0)
+			start_workers();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			decode_queue.push_back(request);
+			pending++;
+		}
+		condition_decode.notify_one();
+#endif
+
+		return texture;
+	}
+
+	void opengl_texture_async_loader_structure::start_workers()
+	{
+		int N = number_of_threads;
+		if (N <= 0)
+			N = std::max(1, std::min(4, int(std::thread::hardware_concurrency()) - 1));
+
+		stop = false;
+		for (int k = 0; k < N; ++k)
+			workers.push_back(std::thread(&opengl_texture_async_loader_structure::worker_loop, this));
+	}
+
+	void opengl_texture_async_loader_structure::worker_loop()
+	{
+		while (true) {
+			std::shared_ptr<request_structure> request;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition_decode.wait(lock, [this]() { return stop || !decode_queue.empty(); });
+				if (stop)
+					return;
+				request = decode_queue.front();
+				decode_queue.pop_front();
+			}
+
+			// Decoding: the only step that takes time, done without holding the lock
+			try {
+				if (check_file_exist(request->filename)) {
+					request->image = image_load_file(request->filename);
+					request->is_valid = request->image.width > 0 && request->image.height > 0;
+				}
+			}
+			catch (std::exception const& e) {
+				std::cerr << "Error while decoding the texture " << request->filename << ": " << e.what() << std::endl;
+			}
+			if (!request->is_valid)
+				warning_cgp("Could not load the texture file " + request->filename, "The placeholder color is kept");
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				upload_queue.push_back(request);
+			}
+			condition_decoded.notify_all();
+		}
+	}
+
+	// Replace the storage of the texture by the decoded image
+	//  data: pointer to the pixels in the CPU memory, or offset in the currently bound GL_PIXEL_UNPACK_BUFFER
+	static void texture_specify_image(opengl_texture_async_loader_structure::request_structure const& request, void const* data)
+	{
+		image_structure const& image = request.image;
+		GLint const format = (image.color_type == image_color_type::rgba ? GL_RGBA8 : GL_RGB8);
+		GLenum const gl_format = (image.color_type == image_color_type::rgba ? GL_RGBA : GL_RGB);
+
+		// The rows of the image are tightly packed
+		GLint previous_alignment = 4;
+		glGetIntegerv(GL_UNPACK_ALIGNMENT, &previous_alignment); opengl_check;
+
+		glBindTexture(GL_TEXTURE_2D, request.texture_id); opengl_check;
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1); opengl_check;
+		glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, gl_format, GL_UNSIGNED_BYTE, data); opengl_check;
+		glPixelStorei(GL_UNPACK_ALIGNMENT, previous_alignment); opengl_check;
+
+		if (request.is_mipmap) {
+			glGenerateMipmap(GL_TEXTURE_2D); opengl_check;
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, request.texture_mag_filter); opengl_check;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, request.texture_min_filter); opengl_check;
+		glBindTexture(GL_TEXTURE_2D, 0); opengl_check;
+	}
+
+	void opengl_texture_async_loader_structure::update()
+	{
+		upload(size_t(std::max(upload_budget, 1)));
+	}
+
+	void opengl_texture_async_loader_structure::upload(size_t budget)
+	{
+		while (budget > 0) {
+
+			// Start the copy of the next decoded image
+			if (uploading == nullptr) {
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					if (upload_queue.empty())
+						return;
+					uploading = upload_queue.front();
+					upload_queue.pop_front();
+				}
+				uploaded_bytes = 0;
+
+				// The texture may have been deleted while the image was decoded
+				if (!uploading->is_valid || !glIsTexture(uploading->texture_id)) {
+					uploading = nullptr;
+					std::lock_guard<std::mutex> lock(mutex);
+					pending--;
+					continue;
+				}
+
+				if (pbo == 0) {
+					glGenBuffers(1, &pbo); opengl_check;
+				}
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo); opengl_check;
+				glBufferData(GL_PIXEL_UNPACK_BUFFER, uploading->image.data.size(), nullptr, GL_STREAM_DRAW); opengl_check;
+				pbo_data = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, uploading->image.data.size(), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT)); opengl_check;
+				// The PBO must not stay bound: any other call to glTexImage2D would interpret its pointer as an offset in the PBO
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); opengl_check;
+
+				// Direct upload from the CPU memory if the PBO can't be mapped
+				if (pbo_data == nullptr) {
+					texture_specify_image(*uploading, ptr(uploading->image.data));
+					uploading = nullptr;
+					std::lock_guard<std::mutex> lock(mutex);
+					pending--;
+					continue;
+				}
+			}
+
+			image_structure const& image = uploading->image;
+			size_t const size = image.data.size();
+
+			// Copy a slice of the image in the PBO
+			size_t const slice = std::min(budget, size - uploaded_bytes);
+			std::memcpy(pbo_data + uploaded_bytes, ptr(image.data) + uploaded_bytes, slice);
+			uploaded_bytes += slice;
+			budget -= slice;
+			if (uploaded_bytes < size)
+				return;
+
+			// The full image is in the PBO: replace the placeholder by the image (the transfer from the PBO is handled asynchronously by the driver)
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo); opengl_check;
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER); opengl_check;
+			pbo_data = nullptr;
+			if (glIsTexture(uploading->texture_id))
+				texture_specify_image(*uploading, nullptr);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); opengl_check;
+
+			uploading = nullptr;
+			std::lock_guard<std::mutex> lock(mutex);
+			pending--;
+		}
+	}
+
+	int opengl_texture_async_loader_structure::number_of_pending() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return pending;
+	}
+
+	bool opengl_texture_async_loader_structure::is_finished() const
+	{
+		return number_of_pending() == 0;
+	}
+
+	void opengl_texture_async_loader_structure::finish()
+	{
+		while (!is_finished()) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition_decoded.wait(lock, [this]() { return !upload_queue.empty() || uploading != nullptr || pending == 0; });
+			}
+			upload(size_t(-1));
+		}
+	}
+
+	void opengl_texture_async_loader_structure::clear()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+		condition_decode.notify_all();
+		for (std::thread& worker : workers)
+			worker.join();
+		workers.clear();
+
+		if (pbo_data != nullptr) {
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo); opengl_check;
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER); opengl_check;
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); opengl_check;
+			pbo_data = nullptr;
+		}
+		if (pbo != 0) {
+			glDeleteBuffers(1, &pbo); opengl_check;
+			pbo = 0;
+		}
+
+		decode_queue.clear();
+		upload_queue.clear();
+		uploading = nullptr;
+		pending = 0;
+		stop = false;
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "cgp/opengl_include.hpp"
+#include "cgp/13_opengl/texture/texture.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace cgp {
+
+	// Helper structure to load textures without blocking the rendering thread
+	//  - The texture is created immediately with a 1x1 placeholder color, and its ID is definitive: it can be given to a mesh_drawable right away
+	//  - The image files are decoded on worker threads
+	//  - The decoded images are copied in a Pixel Buffer Object by slices of at most upload_budget bytes at each call to update(),
+	//      then the texture storage is replaced by the image from the PBO (the placeholder remains visible until the full image is available)
+	//  - Note: the width/height of the opengl_texture_image_structure returned by load_texture_2d remain the ones of the placeholder
+	//
+	//  Usage:
+	//
+	//  // Initialization stage
+	//  | opengl_texture_async_loader_structure texture_loader;
+	//  | opengl_texture_image_structure texture = texture_loader.load_texture_2d("assets/image.jpg");
+	//  | shape.initialize_data_on_gpu(mesh, mesh_drawable::default_shader, texture);
+	//  | ...
+	//  // At each frame (on the OpenGL thread)
+	//  | texture_loader.update();
+	//
+	//  Under Emscripten the images are loaded synchronously by load_texture_2d.
+
+	struct opengl_texture_async_loader_structure {
+
+		// Maximal number of bytes copied to the GPU at each call to update()
+		int upload_budget = 2 * 1024 * 1024;
+
+		// Number of worker threads decoding the images (set before the first call to load_texture_2d, 0 = automatic)
+		int number_of_threads = 0;
+
+		opengl_texture_async_loader_structure() = default;
+		opengl_texture_async_loader_structure(opengl_texture_async_loader_structure const&) = delete;
+		opengl_texture_async_loader_structure& operator=(opengl_texture_async_loader_structure const&) = delete;
+		~opengl_texture_async_loader_structure();
+
+		// Create a GL_TEXTURE_2D filled with the placeholder color, and request the loading of the image file in the background
+		opengl_texture_image_structure load_texture_2d(std::string const& filename, GLint wrap_s = GL_CLAMP_TO_EDGE, GLint wrap_t = GL_CLAMP_TO_EDGE, bool is_mipmap = true, GLint texture_mag_filter = GL_LINEAR, GLint texture_min_filter = GL_LINEAR_MIPMAP_LINEAR, vec3 const& placeholder_color = { 0.5f, 0.5f, 0.5f });
+
+		// Upload the decoded images to the GPU within the upload budget (must be called from the OpenGL thread, typically once per frame)
+		void update();
+
+		// Number of requested textures that are not yet on the GPU
+		int number_of_pending() const;
+		bool is_finished() const;
+
+		// Block until all the requested textures are on the GPU
+		void finish();
+
+		// Stop the worker threads and release the PBO (the pending requests are cancelled, the textures keep their placeholder)
+		void clear();
+
+
+		// Internal data
+		struct request_structure {
+			std::string filename;
+			GLuint texture_id = 0;
+			GLint wrap_s, wrap_t;
+			bool is_mipmap;
+			GLint texture_mag_filter, texture_min_filter;
+			image_structure image;
+			bool is_valid = false; // false if the file could not be decoded
+		};
+
+		std::vector<std::thread> workers;
+		mutable std::mutex mutex;
+		std::condition_variable condition_decode;   // signaled when a file is requested
+		std::condition_variable condition_decoded;  // signaled when a file is decoded
+		std::deque<std::shared_ptr<request_structure> > decode_queue;
+		std::deque<std::shared_ptr<request_structure> > upload_queue;
+		int pending = 0;
+		bool stop = false;
+
+		// Image being copied in the PBO
+		std::shared_ptr<request_structure> uploading;
+		size_t uploaded_bytes = 0;
+		GLuint pbo = 0;
+		unsigned char* pbo_data = nullptr;
+
+	private:
+		void start_workers();
+		void worker_loop();
+		void upload(size_t budget);
+	};
+
+}
@@ -16,7 +16,7 @@ namespace cgp
     *          The function should only be called once.
     * The function initialize both GLFW and GLAD for OpenGL function access
     */
-    static GLFWwindow* glfw_create_window(int width = 0, int height = 0, std::string const& window_title = "cgp Display", int opengl_version_major = 3, int opengl_version_minor = 3, GLFWmonitor* monitor = nullptr, GLFWwindow* share = nullptr);
+    static GLFWwindow* glfw_create_window(int width = 0, int height = 0, std::string const& window_title = "cgp Display", int opengl_version_major = 3, int opengl_version_minor = 3, GLFWmonitor* monitor = nullptr, GLFWwindow* share = nullptr, bool headless = false);
 
 
 
@@ -54,7 +54,7 @@ namespace cgp
         std::cerr<<"\t Description - "<<description<<std::endl;
     }
 
-	GLFWwindow* glfw_create_window(int width, int height, std::string const& window_title, int opengl_version_major, int opengl_version_minor, GLFWmonitor* monitor, GLFWwindow* share)
+	GLFWwindow* glfw_create_window(int width, int height, std::string const& window_title, int opengl_version_major, int opengl_version_minor, GLFWmonitor* monitor, GLFWwindow* share, bool headless)
 	{
 
 
@@ -71,6 +71,15 @@ namespace cgp
         glfwWindowHint(GLFW_SAMPLES, 8); // Multisampling
         glfwWindowHint(GLFW_FLOATING, GLFW_FALSE); // Windows is not always on top
 
+        if (headless) {
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            glfwWindowHint(GLFW_FOCUSED, GLFW_FALSE);
+            glfwWindowHint(GLFW_SAMPLES, 0); // Multisampled default framebuffers are not supported by all offscreen surfaces
+#ifdef GLFW_EGL_CONTEXT_API
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+#endif
+        }
+
 #ifdef __APPLE__
         glfwWindowHint(GLFW_COCOA_RETINA_FRAMEBUFFER, GLFW_FALSE); // To avoid HiDPI issues with pixel size on Mac
 #endif 
@@ -84,6 +93,15 @@ namespace cgp
         // Creation of the window
         GLFWwindow* window = glfwCreateWindow(width, height, window_title.c_str(), monitor, share);
 
+#ifdef GLFW_OSMESA_CONTEXT_API
+        // EGL not available: software context with OSMesa
+        if (window == nullptr && headless) {
+            std::cout << "Failed to create the EGL context of the headless window, try with OSMesa" << std::endl;
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+            window = glfwCreateWindow(width, height, window_title.c_str(), monitor, share);
+        }
+#endif
+
         if( window==nullptr ) {
             std::cerr<<"Failed to create GLFW Window"<<std::endl;
             std::cerr<<"\t Possible error cause: Incompatible OpenGL version (requesting OpenGL "<<opengl_version_major<<"."<<opengl_version_minor<<")"<<std::endl;
@@ -96,11 +114,15 @@ namespace cgp
 
 #ifndef __EMSCRIPTEN__
         // Initialize GLAD to get access to OpenGL functions
-        const int glad_init_value = gladLoadGL();
+        //  The functions of EGL/OSMesa contexts are not accessible through libGL: they are queried via GLFW
+        const int glad_init_value = headless ? gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress)) : gladLoadGL();
         if( glad_init_value == 0 ) {
             std::cout<<"Failed to Init GLAD"<<std::endl;
             abort();
         }
+
+        // Query the program binary functions (not part of the OpenGL 3.3 loader)
+        opengl_shader_structure::program_binary_cache.initialize(reinterpret_cast<void* (*)(const char*)>(glfwGetProcAddress));
 #endif
 
 
@@ -110,7 +132,8 @@ namespace cgp
 
         // Ask GLFW to limit its refresh to the monitor frequency 
         //  typically limits refresh rates to 60fps
-        glfwSwapInterval(1); 
+        //  (no synchronization for the offscreen rendering)
+        glfwSwapInterval(headless ? 0 : 1);
 
         return window;
 	}
@@ -121,6 +144,12 @@ namespace cgp
         // Set GLFW callback to catch and display error
         glfwSetErrorCallback(glfw_error_callback);
 
+#ifdef GLFW_PLATFORM_NULL
+        // Headless window: no connection to a display server
+        if (is_headless && glfwPlatformSupported(GLFW_PLATFORM_NULL) == GLFW_TRUE)
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+
         // Initialize GLFW
         const int glfw_init_value = glfwInit();
         if( glfw_init_value != GLFW_TRUE ) {
@@ -135,12 +164,13 @@ namespace cgp
 
     void window_structure::create_window(int width_arg, int height_arg, std::string const& window_title, int opengl_version_major, int opengl_version_minor)
     {
-        glfw_window = glfw_create_window(width_arg, height_arg, window_title, opengl_version_major, opengl_version_minor);
+        glfw_window = glfw_create_window(width_arg, height_arg, window_title, opengl_version_major, opengl_version_minor, nullptr, nullptr, is_headless);
 
         monitor = glfwGetPrimaryMonitor();
-        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-        screen_resolution_width = mode->width;
-        screen_resolution_height = mode->height;
+        const GLFWvidmode* mode = monitor != nullptr ? glfwGetVideoMode(monitor) : nullptr;
+        // No monitor (headless window): the resolution is the one of the window
+        screen_resolution_width = mode != nullptr ? mode->width : width_arg;
+        screen_resolution_height = mode != nullptr ? mode->height : height_arg;
 
         glfwGetWindowPos(glfw_window, &x_pos, &y_pos);
         glfwGetWindowSize(glfw_window, &width, &height);
@@ -17,6 +17,11 @@ namespace cgp
 		int screen_resolution_width=0, screen_resolution_height=0;
 		bool is_full_screen = false;
 
+		// Create a hidden window for offscreen rendering (ex. benchmarks on a machine without display or GPU)
+		//  To be set before initialize_glfw(). With GLFW 3.4+ no display server is needed (null platform),
+		//  and the context is created with EGL, or OSMesa if EGL is not available (ex. Mesa llvmpipe).
+		bool is_headless = false;
+
 		/** Initialize GLFW 
 		 * This function should be called at the beginning of the program before any OpenGL calls. */
 		void initialize_glfw();
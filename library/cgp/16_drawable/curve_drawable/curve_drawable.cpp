@@ -94,6 +94,7 @@ namespace cgp
 		// ********************************** //
 		int const N_points_display = N_points < 0 ? drawable.vbo_position.size : N_points;
 		glBindVertexArray(drawable.vao); opengl_check;
+		opengl_update_vao_location_stream(drawable.vbo_position, 0); // VBO in stream mode: point to the region written by its last update
 		if (drawable.display_type == curve_drawable_display_type::Curve) {
 			glDrawArrays(GL_LINE_STRIP, 0, N_points_display); opengl_check;
 		}
@@ -7,7 +7,7 @@
 
 namespace cgp
 {
-	void material_mesh_drawable_phong::send_opengl_uniform(opengl_shader_structure const& shader, bool expected) const
+	void material_mesh_drawable_phong::send_opengl_uniform(opengl_shader_structure const& shader, bool expected, bool send_texture_settings) const
 	{
 		opengl_uniform(shader, "material.color", color, expected);
 		opengl_uniform(shader, "material.alpha", alpha, expected);
@@ -17,6 +17,8 @@ namespace cgp
 		opengl_uniform(shader, "material.phong.specular", phong.specular, expected);
 		opengl_uniform(shader, "material.phong.specular_exponent", phong.specular_exponent, expected);
 
+		if (!send_texture_settings)
+			return;
 		opengl_uniform(shader, "material.texture_settings.use_texture", texture_settings.active, expected);
 		opengl_uniform(shader, "material.texture_settings.texture_inverse_v", texture_settings.inverse_v, expected);
 		opengl_uniform(shader, "material.texture_settings.two_sided", texture_settings.two_sided, expected);
@@ -24,7 +24,8 @@ namespace cgp
 		phong_parameters phong;                       // Phong parameters
 		texture_settings_parameters texture_settings; // Specific settings for the texture (the texture id is stored directly in the mesh_drawable)
 
-		void send_opengl_uniform(opengl_shader_structure const& shader, bool expected = true) const;
+		// send_texture_settings=false when the texture settings are compiled in the shader (see mesh_drawable_shader_variant)
+		void send_opengl_uniform(opengl_shader_structure const& shader, bool expected = true, bool send_texture_settings = true) const;
 	};
 
 	//void opengl_uniform(opengl_shader_structure const& shader, material_mesh_drawable_phong const& material, bool expected = true);
@@ -1,6 +1,11 @@
 #include "mesh_drawable.hpp"
 
 #include "cgp/01_base/base.hpp"
+#include "cgp/03_files/files.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
 
 #if defined(__linux__) || defined(__EMSCRIPTEN__)
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -10,10 +15,23 @@ namespace cgp
 {
 	opengl_shader_structure mesh_drawable::default_shader;
 	opengl_texture_image_structure mesh_drawable::default_texture;
+	mesh_drawable_shader_variant mesh_drawable::default_shader_variant;
 
 	static void warning_initialize_non_empty();
 
-	void mesh_drawable::initialize_data_on_gpu(mesh const& data, opengl_shader_structure const& shader_arg, opengl_texture_image_structure const& texture_arg)
+	// Description of the interleaved vertex of the compact layout (offsets and stride in bytes)
+	struct compact_vertex_format {
+		GLuint stride = 0;
+		size_t offset_position = 0;
+		size_t offset_normal = 0;
+		size_t offset_uv = 0;
+		size_t offset_color = 0;
+		bool half_uv = true;
+		bool has_color = true;
+	};
+	static numarray<unsigned char> compact_vertex_pack(mesh const& data, compact_vertex_format& format);
+
+	void mesh_drawable::initialize_data_on_gpu(mesh const& data, opengl_shader_structure const& shader_arg, opengl_texture_image_structure const& texture_arg, mesh_drawable_vertex_layout vertex_layout_arg)
 	{
 		// Error detection before sending the data to avoid unexpected behavior
 		// *********************************************************************** //
@@ -21,7 +39,7 @@ namespace cgp
 		opengl_check;
 
 		// Check if this mesh_drawable is already initialized
-		if (vao != 0 || vbo_position.size != 0)
+		if (vao != 0 || vbo_position.size != 0 || vbo_interleaved.size != 0)
 			warning_initialize_non_empty();
 
 		if (data.position.size() == 0) {
@@ -42,15 +60,26 @@ namespace cgp
 		model = affine();
 		material = material_mesh_drawable_phong();
 		supplementary_model_matrix = mat4::build_identity();
+		vertex_layout = vertex_layout_arg;
+		has_uniform_vertex_color = false;
 
 
 		// Send the data to the GPU
 		// ******************************************** //
 
-		vbo_position.initialize_data_on_gpu(data.position);
-		vbo_normal.initialize_data_on_gpu(data.normal);
-		vbo_color.initialize_data_on_gpu(data.color);
-		vbo_uv.initialize_data_on_gpu(data.uv);
+		compact_vertex_format format;
+		if (vertex_layout == mesh_drawable_vertex_layout::separate) {
+			vbo_position.initialize_data_on_gpu(data.position);
+			vbo_normal.initialize_data_on_gpu(data.normal);
+			vbo_color.initialize_data_on_gpu(data.color);
+			vbo_uv.initialize_data_on_gpu(data.uv);
+		}
+		else {
+			numarray<unsigned char> const interleaved = compact_vertex_pack(data, format);
+			vbo_interleaved.initialize_data_on_gpu(interleaved, format.stride);
+			has_uniform_vertex_color = !format.has_color;
+			uniform_vertex_color = data.color[0];
+		}
 
 		ebo_connectivity.initialize_data_on_gpu(data.connectivity);
 
@@ -59,10 +88,19 @@ namespace cgp
 		//   - Preset shader location for default mesh shaders {position:0, normal:1, color:2, uv:3}
 		glGenVertexArrays(1, &vao); opengl_check;
 		glBindVertexArray(vao); opengl_check;
-		opengl_set_vao_location(vbo_position, 0);
-		opengl_set_vao_location(vbo_normal, 1);
-		opengl_set_vao_location(vbo_color, 2);
-		opengl_set_vao_location(vbo_uv, 3);
+		if (vertex_layout == mesh_drawable_vertex_layout::separate) {
+			opengl_set_vao_location(vbo_position, 0);
+			opengl_set_vao_location(vbo_normal, 1);
+			opengl_set_vao_location(vbo_color, 2);
+			opengl_set_vao_location(vbo_uv, 3);
+		}
+		else {
+			opengl_set_vao_location_interleaved(vbo_interleaved, 0, 3, GL_FLOAT, false, format.offset_position);
+			opengl_set_vao_location_interleaved(vbo_interleaved, 1, 4, GL_INT_2_10_10_10_REV, true, format.offset_normal);
+			if (format.has_color)
+				opengl_set_vao_location_interleaved(vbo_interleaved, 2, 4, GL_UNSIGNED_BYTE, true, format.offset_color);
+			opengl_set_vao_location_interleaved(vbo_interleaved, 3, 2, format.half_uv ? GL_HALF_FLOAT : GL_FLOAT, false, format.offset_uv);
+		}
 		glBindVertexArray(0); opengl_check;
 	}
 
@@ -117,6 +155,7 @@ namespace cgp
 		vbo_normal.clear();
 		vbo_color.clear();
 		vbo_uv.clear();
+		vbo_interleaved.clear();
 		for(int k=0; k<supplementary_vbo.size(); ++k)
 			supplementary_vbo[k].clear();
 		ebo_connectivity.clear();
@@ -130,6 +169,8 @@ namespace cgp
 		material = material_mesh_drawable_phong();
 		texture = opengl_texture_image_structure();
 		supplementary_texture.clear();
+		vertex_layout = mesh_drawable_vertex_layout::separate;
+		has_uniform_vertex_color = false;
 
 		opengl_check;
 	}
@@ -154,35 +195,39 @@ namespace cgp
 		// ********************************** //
 		// If there is not vertices or not triangles, returns
 		//  (no error + does not display anything)
-		if (drawable.vbo_position.size == 0 || drawable.ebo_connectivity.size == 0)
+		if ((drawable.vbo_position.size == 0 && drawable.vbo_interleaved.size == 0) || drawable.ebo_connectivity.size == 0)
 			return;
 
 		assert_cgp(drawable.shader.id != 0, "Try to draw mesh_drawable without shader ");
 		assert_cgp(!glIsShader(drawable.shader.id), "Try to draw mesh_drawable with incorrect shader ");
 		assert_cgp(drawable.texture.id != 0, "Try to draw mesh_drawable without texture ");
 
+		// The default shader is replaced by its variant matching the texture settings (no runtime branch in the fragment shader)
+		bool use_variant = false;
+		opengl_shader_structure const& shader = mesh_drawable_shader(drawable, &use_variant);
+
 		// Set the current shader
 		// ********************************** //
-		glUseProgram(drawable.shader.id); opengl_check;
+		glUseProgram(shader.id); opengl_check;
 
 		// Send uniforms for this shader
 		// ********************************** //
 
 		// send the uniform values for the model and material of the mesh_drawable
-		drawable.send_opengl_uniform(expected_uniforms);
+		drawable.send_opengl_uniform(shader, expected_uniforms, !use_variant);
 
 		// send the uniform values for the environment
-		environment.send_opengl_uniform(drawable.shader, expected_uniforms && environment.default_expected_uniform);
+		environment.send_opengl_uniform(shader, expected_uniforms && environment.default_expected_uniform);
 
 		// [Optionnal] send any additional uniform for this specidic draw call
-		additional_uniforms.send_opengl_uniform(drawable.shader, expected_uniforms);
+		additional_uniforms.send_opengl_uniform(shader, expected_uniforms);
 
 
 		// Set textures
 		// ********************************** //
 		glActiveTexture(GL_TEXTURE0); opengl_check;
 		drawable.texture.bind();
-		opengl_uniform(drawable.shader, "image_texture", 0, expected_uniforms);  opengl_check;
+		opengl_uniform(shader, "image_texture", 0, expected_uniforms && !(use_variant && !drawable.material.texture_settings.active));  opengl_check;
 
 		//Set any additional texture
 		int texture_count = 1;
@@ -193,7 +238,7 @@ namespace cgp
 
 			glActiveTexture(GL_TEXTURE0 + texture_count); opengl_check;
 			additional_texture.bind();
-			opengl_uniform(drawable.shader, additional_texture_name, texture_count, expected_uniforms);
+			opengl_uniform(shader, additional_texture_name, texture_count, expected_uniforms);
 
 			texture_count++;
 		}
@@ -205,6 +250,20 @@ namespace cgp
 		glBindVertexArray(drawable.vao);                                     opengl_check;
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, drawable.ebo_connectivity.id); opengl_check;
 
+		// VBOs in stream mode: point to the region written by their last update
+		if (drawable.vertex_layout == mesh_drawable_vertex_layout::separate) {
+			opengl_update_vao_location_stream(drawable.vbo_position, 0);
+			opengl_update_vao_location_stream(drawable.vbo_normal, 1);
+			opengl_update_vao_location_stream(drawable.vbo_color, 2);
+			opengl_update_vao_location_stream(drawable.vbo_uv, 3);
+		}
+
+		// Constant color attribute when it is not stored per-vertex (not part of the VAO state)
+		if (drawable.has_uniform_vertex_color) {
+			vec3 const& c = drawable.uniform_vertex_color;
+			glVertexAttrib3f(2, c.x, c.y, c.z); opengl_check;
+		}
+
 
 		// Draw call
 		// ********************************** //
@@ -223,6 +282,14 @@ namespace cgp
 		glUseProgram(0);
 	}
 
+	opengl_shader_structure const& mesh_drawable_shader(mesh_drawable const& drawable, bool* is_variant)
+	{
+		bool const use_variant = drawable.shader.id == mesh_drawable::default_shader.id && mesh_drawable::default_shader_variant.is_loaded();
+		if (is_variant != nullptr)
+			*is_variant = use_variant;
+		return use_variant ? mesh_drawable::default_shader_variant.get(drawable.material.texture_settings) : drawable.shader;
+	}
+
 	void draw_wireframe(mesh_drawable const& drawable, environment_generic_structure const& environment, vec3 const& color, int instance_count, bool expected_uniforms, uniform_generic_structure const& additional_uniforms)
 	{
 #ifndef __EMSCRIPTEN__ 		// Polygon Mode not available in WebGL
@@ -243,14 +310,155 @@ namespace cgp
 
 
 	void mesh_drawable::send_opengl_uniform(bool expected) const
+	{
+		send_opengl_uniform(shader, expected, true);
+	}
+
+	void mesh_drawable::send_opengl_uniform(opengl_shader_structure const& shader_target, bool expected, bool send_texture_settings) const
 	{
 		// Final model matrix in the shader is: hierarchy_transform_model * model
 		mat4 const model_shader = hierarchy_transform_model.matrix() * supplementary_model_matrix * model.matrix();
 
 		// set the Model matrix
-		opengl_uniform(shader, "model", model_shader, expected);
+		opengl_uniform(shader_target, "model", model_shader, expected);
 
 		// set the material
-		material.send_opengl_uniform(shader, expected);
+		material.send_opengl_uniform(shader_target, expected, send_texture_settings);
 	}
+
+
+	void mesh_drawable_shader_variant::load(std::string const& vertex_shader_path, std::string const& fragment_shader_path)
+	{
+		vertex_shader_text = read_text_file(vertex_shader_path);
+		fragment_shader_text = read_text_file(fragment_shader_path);
+	}
+
+	bool mesh_drawable_shader_variant::is_loaded() const
+	{
+		return fragment_shader_text.size() > 0;
+	}
+
+	opengl_shader_structure const& mesh_drawable_shader_variant::get(texture_settings_parameters const& texture_settings)
+	{
+		int const index = (texture_settings.active ? 1 : 0) + (texture_settings.inverse_v ? 2 : 0) + (texture_settings.two_sided ? 4 : 0);
+		opengl_shader_structure& shader = variant[index];
+		if (shader.id == 0) {
+			std::string const defines = std::string("#define MATERIAL_VARIANT\n")
+				+ "#define USE_TEXTURE " + str(texture_settings.active ? 1 : 0) + "\n"
+				+ "#define TEXTURE_INVERSE_V " + str(texture_settings.inverse_v ? 1 : 0) + "\n"
+				+ "#define TWO_SIDED " + str(texture_settings.two_sided ? 1 : 0) + "\n";
+			shader.load_from_inline_text(vertex_shader_text, opengl_shader_insert_defines(fragment_shader_text, defines));
+		}
+		return shader;
+	}
+
+
+	// Conversion of a float to a 16-bit IEEE half-float (round to nearest)
+	static uint16_t float_to_half(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		uint32_t const sign = (bits >> 16) & 0x8000u;
+		int const exponent = int((bits >> 23) & 0xFFu) - 127 + 15;
+		uint32_t mantissa = bits & 0x7FFFFFu;
+
+		if (((bits >> 23) & 0xFFu) == 0xFFu) // Inf or NaN
+			return uint16_t(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+		if (exponent >= 31) // Overflow: Inf
+			return uint16_t(sign | 0x7C00u);
+		if (exponent <= 0) { // Subnormal half or zero
+			if (exponent < -10)
+				return uint16_t(sign);
+			mantissa |= 0x800000u;
+			int const shift = 14 - exponent;
+			uint32_t half_mantissa = mantissa >> shift;
+			if ((mantissa >> (shift - 1)) & 1u)
+				half_mantissa++;
+			return uint16_t(sign | half_mantissa);
+		}
+		uint32_t half = sign | (uint32_t(exponent) << 10) | (mantissa >> 13);
+		if (mantissa & 0x1000u) // Round to nearest (the carry may increase the exponent)
+			half++;
+		return uint16_t(half);
+	}
+	static float half_to_float(uint16_t half)
+	{
+		uint32_t const sign = uint32_t(half & 0x8000u) << 16;
+		uint32_t const exponent = (half >> 10) & 0x1Fu;
+		uint32_t const mantissa = half & 0x3FFu;
+		float value;
+		if (exponent == 0)
+			value = std::ldexp(float(mantissa), -24);
+		else if (exponent == 31)
+			value = mantissa ? std::numeric_limits<float>::quiet_NaN() : std::numeric_limits<float>::infinity();
+		else
+			value = std::ldexp(float(mantissa | 0x400u), int(exponent) - 25);
+		return sign ? -value : value;
+	}
+
+	// Signed normalized 10-10-10-2 packing of a unit vector (w=0)
+	static uint32_t pack_normal_10_10_10_2(vec3 const& normal)
+	{
+		float const n_norm = norm(normal);
+		vec3 const n = n_norm > 1e-8f ? normal / n_norm : vec3{ 0,0,1 };
+
+		uint32_t packed = 0;
+		for (int k = 0; k < 3; ++k) {
+			float const v = std::max(-1.0f, std::min(1.0f, n[k]));
+			int const q = int(std::round(v * 511.0f));
+			packed |= (uint32_t(q) & 0x3FFu) << (10 * k);
+		}
+		return packed;
+	}
+
+	static numarray<unsigned char> compact_vertex_pack(mesh const& data, compact_vertex_format& format)
+	{
+		// Maximal error accepted on the uv coordinates stored as half-float (in texture repetitions)
+		float const uv_half_tolerance = 1.0f / 2048.0f;
+
+		int const N = data.position.size();
+
+		format.has_color = false;
+		for (int k = 1; k < N && !format.has_color; ++k)
+			format.has_color = !is_equal(data.color[k], data.color[0]);
+
+		format.half_uv = true;
+		for (int k = 0; k < N && format.half_uv; ++k)
+			for (int i = 0; i < 2; ++i)
+				if (std::abs(half_to_float(float_to_half(data.uv[k][i])) - data.uv[k][i]) > uv_half_tolerance)
+					format.half_uv = false;
+
+		format.offset_position = 0;
+		format.offset_normal = 3 * sizeof(float);
+		format.offset_uv = format.offset_normal + sizeof(uint32_t);
+		format.offset_color = format.offset_uv + (format.half_uv ? 2 * sizeof(uint16_t) : 2 * sizeof(float));
+		format.stride = GLuint(format.offset_color + (format.has_color ? 4 : 0));
+
+		numarray<unsigned char> buffer;
+		buffer.resize(N * format.stride);
+		for (int k = 0; k < N; ++k) {
+			unsigned char* vertex = &buffer[k * format.stride];
+
+			std::memcpy(vertex + format.offset_position, &data.position[k], 3 * sizeof(float));
+
+			uint32_t const normal = pack_normal_10_10_10_2(data.normal[k]);
+			std::memcpy(vertex + format.offset_normal, &normal, sizeof(normal));
+
+			if (format.half_uv) {
+				uint16_t const uv[2] = { float_to_half(data.uv[k].x), float_to_half(data.uv[k].y) };
+				std::memcpy(vertex + format.offset_uv, uv, sizeof(uv));
+			}
+			else {
+				std::memcpy(vertex + format.offset_uv, &data.uv[k], 2 * sizeof(float));
+			}
+
+			if (format.has_color) {
+				for (int i = 0; i < 3; ++i)
+					vertex[format.offset_color + i] = static_cast<unsigned char>(std::round(255.0f * std::max(0.0f, std::min(1.0f, data.color[k][i]))));
+				vertex[format.offset_color + 3] = 255;
+			}
+		}
+		return buffer;
+	}
+
 }
@@ -10,6 +10,34 @@
 
 namespace cgp
 {
+	// Organization of the per-vertex data of a mesh_drawable on the GPU
+	//  separate: one float VBO per attribute (vbo_position, vbo_normal, vbo_color, vbo_uv) - the VBOs can be updated
+	//  compact: a single interleaved VBO with quantized attributes - for static meshes only (cannot be updated)
+	//     position: 3 floats, normal: 10-10-10-2 signed normalized, uv: 2 half-floats (2 floats if the half-float precision is not sufficient),
+	//     color: 4 unsigned bytes, or no buffer at all if the color is the same for all vertices
+	enum class mesh_drawable_vertex_layout { separate, compact };
+
+	// Set of programs compiled from the same mesh shader sources, one per combination of texture settings
+	//  The fragment shader receives the settings as preprocessor values instead of uniforms:
+	//    #define MATERIAL_VARIANT
+	//    #define USE_TEXTURE [0/1]
+	//    #define TEXTURE_INVERSE_V [0/1]
+	//    #define TWO_SIDED [0/1]
+	//  Each variant is compiled at its first use.
+	struct mesh_drawable_shader_variant
+	{
+		std::string vertex_shader_text;
+		std::string fragment_shader_text;
+		opengl_shader_structure variant[8];
+
+		// Read the shader files (the variants are not compiled yet)
+		void load(std::string const& vertex_shader_path, std::string const& fragment_shader_path);
+		bool is_loaded() const;
+
+		// Program corresponding to the texture settings (compiled if needed)
+		opengl_shader_structure const& get(texture_settings_parameters const& texture_settings);
+	};
+
 	// Main structure used to draw a mesh
 	struct mesh_drawable
 	{
@@ -17,6 +45,7 @@ namespace cgp
 		// ********************************* //
 		static opengl_shader_structure default_shader; // default mesh shader shared by all mesh_drawable 
 		opengl_shader_structure shader; // Actual shader (used if defined)
+		static mesh_drawable_shader_variant default_shader_variant; // variants of the default shader (used instead of default_shader when loaded)
 
 		// Texture image
 		// ********************************* //
@@ -32,6 +61,12 @@ namespace cgp
 		opengl_vbo_structure vbo_uv;
 		std::vector<opengl_vbo_structure> supplementary_vbo; // optional supplementary vbo (per-vertex or per-instance)
 
+		// Interleaved VBO used in the compact vertex layout (vbo_position, vbo_normal, vbo_color, vbo_uv are then empty)
+		mesh_drawable_vertex_layout vertex_layout = mesh_drawable_vertex_layout::separate;
+		opengl_vbo_structure vbo_interleaved;
+		bool has_uniform_vertex_color = false; // compact layout only: the color is not stored per-vertex but set as a constant attribute
+		vec3 uniform_vertex_color;
+
 		// Indexed connectivity
 		// ********************************* //
 		opengl_ebo_structure ebo_connectivity;
@@ -66,13 +101,16 @@ namespace cgp
 		// ************************************************* //
 
 		// Fill the VBO and VAO of the class using the data provided from the mesh
-		void initialize_data_on_gpu(mesh const& data, opengl_shader_structure const& shader = default_shader, opengl_texture_image_structure const& texture = default_texture);
+		//  Use vertex_layout=compact for static meshes to reduce the GPU memory and the vertex fetch bandwidth (the vertex buffers cannot be updated)
+		void initialize_data_on_gpu(mesh const& data, opengl_shader_structure const& shader = default_shader, opengl_texture_image_structure const& texture = default_texture, mesh_drawable_vertex_layout vertex_layout = mesh_drawable_vertex_layout::separate);
 
 		// Clear the GPU memory from the VBO and VAO data
 		void clear();
 
 		// Send the uniforms to the shader (called automatically during the draw stage)
 		void send_opengl_uniform(bool expected = true) const;
+		// Send the uniforms to a given shader, send_texture_settings=false when the texture settings are compiled in the shader variant
+		void send_opengl_uniform(opengl_shader_structure const& shader, bool expected, bool send_texture_settings) const;
 
 		// Additional method allowing to fill an additional VBO
 		template<typename T>
@@ -84,6 +122,10 @@ namespace cgp
 	};
 
 
+	// Shader used to draw the mesh_drawable: the variant of the default shader matching its texture settings when the variants are loaded
+	//  is_variant (optional) is set to true if the texture settings are compiled in the returned shader
+	opengl_shader_structure const& mesh_drawable_shader(mesh_drawable const& drawable, bool* is_variant = nullptr);
+
 	// Main function used to draw a shape.
 	//  draw([mesh_drawable], environment);
 	void draw(mesh_drawable const& drawable, environment_generic_structure const& environment = environment_generic_structure(), int instance_count=1, bool expected_uniforms=true, uniform_generic_structure const& additional_uniforms = uniform_generic_structure(), GLenum draw_mode=GL_TRIANGLES);
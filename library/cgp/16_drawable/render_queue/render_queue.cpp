@@ -0,0 +1,170 @@
+#include "render_queue.hpp"
+
+#include "cgp/01_base/base.hpp"
+
+#include <algorithm>
+
+namespace cgp
+{
+	static void add_stream_location(std::vector<render_queue_structure::stream_location>& stream, opengl_vbo_structure const& vbo, GLuint location)
+	{
+		if (vbo.update_mode == opengl_vbo_update_mode::stream)
+			stream.push_back({ location, vbo.id, GLint(vbo.details.size_element), vbo.details.type_element, vbo.stream_offset });
+	}
+
+	void render_queue_structure::add(mesh_drawable const& drawable, environment_generic_structure const& environment, int instance_count, GLenum draw_mode)
+	{
+		add(drawable, drawable.model, environment, instance_count, draw_mode);
+	}
+
+	void render_queue_structure::add(mesh_drawable const& drawable, affine const& model, environment_generic_structure const& environment, int instance_count, GLenum draw_mode)
+	{
+		// Same early exit as draw(): nothing to display
+		if ((drawable.vbo_position.size == 0 && drawable.vbo_interleaved.size == 0) || drawable.ebo_connectivity.size == 0)
+			return;
+
+		assert_cgp(drawable.shader.id != 0, "Try to add a mesh_drawable without shader in the render queue");
+		assert_cgp(drawable.texture.id != 0, "Try to add a mesh_drawable without texture in the render queue");
+
+		if (number_of_items == items.size())
+			items.push_back(item_structure());
+		item_structure& item = items[number_of_items];
+		number_of_items++;
+
+		item.shader = &mesh_drawable_shader(drawable, &item.shader_variant);
+		item.texture = drawable.texture;
+		item.supplementary_texture = drawable.supplementary_texture.empty() ? nullptr : &drawable.supplementary_texture;
+		item.vao = drawable.vao;
+		item.ebo = drawable.ebo_connectivity.id;
+		item.number_of_elements = GLsizei(drawable.ebo_connectivity.size * 3);
+
+		item.stream.clear();
+		if (drawable.vertex_layout == mesh_drawable_vertex_layout::separate) {
+			add_stream_location(item.stream, drawable.vbo_position, 0);
+			add_stream_location(item.stream, drawable.vbo_normal, 1);
+			add_stream_location(item.stream, drawable.vbo_color, 2);
+			add_stream_location(item.stream, drawable.vbo_uv, 3);
+		}
+
+		item.has_uniform_vertex_color = drawable.has_uniform_vertex_color;
+		item.uniform_vertex_color = drawable.uniform_vertex_color;
+		item.model = drawable.hierarchy_transform_model.matrix() * drawable.supplementary_model_matrix * model.matrix();
+		item.material = drawable.material;
+		item.environment = &environment;
+		item.instance_count = instance_count;
+		item.draw_mode = draw_mode;
+		item.transparent = drawable.material.alpha < 1.0f;
+	}
+
+	void render_queue_structure::submit(bool expected_uniforms)
+	{
+		opengl_check;
+		statistics = statistics_structure();
+
+		// Sort: opaque elements grouped by shader, texture, VAO - then the transparent ones in their order of addition
+		order.resize(number_of_items);
+		for (size_t k = 0; k < number_of_items; ++k)
+			order[k] = (unsigned int)(k);
+		std::sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b) {
+			item_structure const& A = items[a];
+			item_structure const& B = items[b];
+			if (A.transparent != B.transparent)
+				return B.transparent;
+			if (!A.transparent) {
+				if (A.shader->id != B.shader->id) return A.shader->id < B.shader->id;
+				if (A.texture.id != B.texture.id) return A.texture.id < B.texture.id;
+				if (A.vao != B.vao) return A.vao < B.vao;
+			}
+			return a < b;
+		});
+
+		GLuint current_shader = 0;
+		GLuint current_texture = 0;
+		GLuint current_vao = 0;
+		environment_generic_structure const* current_environment = nullptr;
+		opengl_texture_image_structure const* last_texture = nullptr;
+
+		glActiveTexture(GL_TEXTURE0); opengl_check;
+		for (unsigned int const index : order)
+		{
+			item_structure const& item = items[index];
+			opengl_shader_structure const& shader = *item.shader;
+
+			// Program and the uniforms shared by all its draws
+			bool const shader_changed = shader.id != current_shader;
+			if (shader_changed) {
+				glUseProgram(shader.id); opengl_check;
+				opengl_uniform(shader, "image_texture", 0, expected_uniforms && !(item.shader_variant && !item.material.texture_settings.active)); opengl_check;
+				current_shader = shader.id;
+				statistics.program_changes++;
+			}
+			if (shader_changed || item.environment != current_environment) {
+				item.environment->send_opengl_uniform(shader, expected_uniforms && environment_generic_structure::default_expected_uniform);
+				current_environment = item.environment;
+			}
+
+			// Textures
+			if (item.texture.id != current_texture) {
+				item.texture.bind();
+				current_texture = item.texture.id;
+				last_texture = &item.texture;
+				statistics.texture_changes++;
+			}
+			if (item.supplementary_texture != nullptr) {
+				int texture_count = 1;
+				for (auto const& element : *item.supplementary_texture) {
+					glActiveTexture(GL_TEXTURE0 + texture_count); opengl_check;
+					element.second.bind();
+					opengl_uniform(shader, element.first, texture_count, expected_uniforms);
+					texture_count++;
+				}
+				glActiveTexture(GL_TEXTURE0); opengl_check;
+			}
+
+			// Vertex data
+			if (item.vao != current_vao) {
+				glBindVertexArray(item.vao);                     opengl_check;
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, item.ebo); opengl_check;
+				current_vao = item.vao;
+				statistics.vao_changes++;
+			}
+			if (item.stream.size() > 0) {
+				for (stream_location const& s : item.stream) {
+					glBindBuffer(GL_ARRAY_BUFFER, s.buffer); opengl_check;
+					glVertexAttribPointer(s.location, s.size_element, s.type_element, GL_FALSE, 0, reinterpret_cast<void const*>(s.offset)); opengl_check;
+				}
+				glBindBuffer(GL_ARRAY_BUFFER, 0); opengl_check;
+			}
+			if (item.has_uniform_vertex_color) {
+				vec3 const& c = item.uniform_vertex_color;
+				glVertexAttrib3f(2, c.x, c.y, c.z); opengl_check;
+			}
+
+			// Per-draw uniforms
+			opengl_uniform(shader, "model", item.model, expected_uniforms);
+			item.material.send_opengl_uniform(shader, expected_uniforms, !item.shader_variant);
+
+			// Draw call
+			if (item.instance_count <= 1) {
+				glDrawElements(item.draw_mode, item.number_of_elements, GL_UNSIGNED_INT, nullptr); opengl_check;
+			}
+			else {
+				glDrawElementsInstanced(item.draw_mode, item.number_of_elements, GL_UNSIGNED_INT, nullptr, item.instance_count); opengl_check;
+			}
+			statistics.draw_calls++;
+		}
+
+		// Clean state once for the whole queue
+		glBindVertexArray(0);
+		if (last_texture != nullptr)
+			last_texture->unbind();
+		glUseProgram(0);
+
+		clear();
+	}
+
+	void render_queue_structure::clear()
+	{
+		number_of_items = 0;
+	}
+}
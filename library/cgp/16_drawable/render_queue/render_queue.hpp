@@ -0,0 +1,97 @@
+#pragma once
+
+#include "cgp/16_drawable/mesh_drawable/mesh_drawable.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace cgp
+{
+	// Deferred drawing of mesh_drawable sorted to minimize the OpenGL state changes
+	//  add() records everything needed to draw the mesh_drawable at its current state (model matrix, material, shader, texture, VAO),
+	//  submit() sorts the recorded draws by shader, then texture, then VAO, and issues them in a single pass:
+	//   the program, texture and VAO are only bound when they change, and the environment uniforms are only sent once per program.
+	//  Drawables with transparency (material.alpha<1) are drawn after the opaque ones, in the order they were added.
+	//
+	//  Usage:
+	//  | render_queue_structure queue; // kept from frame to frame to reuse its memory
+	//  | ...
+	//  | queue.add(shape_1, environment);
+	//  | queue.add(shape_2, environment);
+	//  | queue.submit(); // draw and empty the queue
+	//
+	//  Notes:
+	//   - The placement, material and buffers of the mesh_drawable can be modified after add(), but the mesh_drawable itself
+	//     (its shader and supplementary textures are referenced, not copied) and the environment must remain valid until submit().
+	//   - The uniforms of the environment are assumed to be constant between add() and submit().
+	struct render_queue_structure
+	{
+		// Record the draw of the mesh_drawable with its current parameters
+		void add(mesh_drawable const& drawable, environment_generic_structure const& environment, int instance_count = 1, GLenum draw_mode = GL_TRIANGLES);
+
+		// Record the draw of the mesh_drawable at the given placement (used instead of drawable.model)
+		//  The same drawable can be added several times at different placements (ex. a model shared by several characters)
+		void add(mesh_drawable const& drawable, affine const& model, environment_generic_structure const& environment, int instance_count = 1, GLenum draw_mode = GL_TRIANGLES);
+
+		// Draw all the recorded elements, then clear the queue
+		void submit(bool expected_uniforms = true);
+
+		// Remove the recorded elements without drawing them
+		void clear();
+
+		int size() const { return int(number_of_items); }
+
+		// Statistics of the last submit
+		struct statistics_structure {
+			int draw_calls = 0;
+			int program_changes = 0;
+			int texture_changes = 0;
+			int vao_changes = 0;
+
+			// Sum of the statistics of several submits (ex. a frame drawn in several passes)
+			statistics_structure& operator+=(statistics_structure const& s) {
+				draw_calls += s.draw_calls;
+				program_changes += s.program_changes;
+				texture_changes += s.texture_changes;
+				vao_changes += s.vao_changes;
+				return *this;
+			}
+		};
+		statistics_structure statistics;
+
+
+		// Internal data
+		// Attribute of a VBO in stream mode: the VAO must point to its current region
+		struct stream_location {
+			GLuint location;
+			GLuint buffer;
+			GLint size_element;
+			GLenum type_element;
+			size_t offset;
+		};
+		struct item_structure {
+			opengl_shader_structure const* shader = nullptr; // Shader of the drawable, or one of the default shader variants
+			bool shader_variant = false; // Texture settings compiled in the shader (not sent as uniforms)
+			opengl_texture_image_structure texture;
+			std::map<std::string, opengl_texture_image_structure> const* supplementary_texture = nullptr; // nullptr if the drawable has none
+			GLuint vao = 0;
+			GLuint ebo = 0;
+			GLsizei number_of_elements = 0;
+			std::vector<stream_location> stream;
+			bool has_uniform_vertex_color = false;
+			vec3 uniform_vertex_color;
+			mat4 model;
+			material_mesh_drawable_phong material;
+			environment_generic_structure const* environment = nullptr;
+			int instance_count = 1;
+			GLenum draw_mode = GL_TRIANGLES;
+			bool transparent = false;
+		};
+
+		// The items are never destroyed: their memory is reused at the next frame
+		std::vector<item_structure> items;
+		size_t number_of_items = 0;
+		std::vector<unsigned int> order;
+	};
+}
@@ -0,0 +1,146 @@
+#include "mesh_binary.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "../obj/obj.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+
+#include <sys/stat.h>
+
+namespace cgp
+{
+	static char const mesh_binary_magic[8] = { 'C','G','P','M','E','S','H','\0' };
+	static uint32_t const mesh_binary_version = 1;
+	static uint32_t const mesh_binary_endianness = 0x01020304;
+
+	struct mesh_binary_header {
+		char magic[8];
+		uint32_t version;
+		uint32_t endianness;
+		uint64_t source_key;
+	};
+
+	// Each array is stored as (number of elements, size of one element) followed by its raw data
+	template <typename T>
+	static void mesh_binary_write(std::ofstream& stream, numarray<T> const& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written as raw data");
+		uint64_t const header[2] = { uint64_t(value.size()), uint64_t(sizeof(T)) };
+		stream.write(reinterpret_cast<char const*>(header), sizeof(header));
+		if (value.size() > 0)
+			stream.write(reinterpret_cast<char const*>(value.data.data()), std::streamsize(value.size() * sizeof(T)));
+	}
+
+	template <typename T>
+	static bool mesh_binary_read(std::ifstream& stream, size_t remaining_size, numarray<T>& value)
+	{
+		uint64_t header[2] = { 0, 0 };
+		if (!stream.read(reinterpret_cast<char*>(header), sizeof(header)))
+			return false;
+		// The size is checked against the file before the allocation (truncated or corrupted file)
+		if (header[1] != sizeof(T) || header[0] > (remaining_size - sizeof(header)) / sizeof(T))
+			return false;
+		value.resize(int(header[0]));
+		if (header[0] > 0)
+			stream.read(reinterpret_cast<char*>(value.data.data()), std::streamsize(header[0] * sizeof(T)));
+		return bool(stream);
+	}
+
+	void mesh_save_file_binary(std::string const& filename, mesh const& m, uint64_t source_key)
+	{
+		std::ofstream stream(filename, std::ios::binary);
+		if (!stream.is_open()) {
+			std::cerr << "Cannot write the mesh binary file " << filename << std::endl;
+			return;
+		}
+
+		mesh_binary_header header;
+		std::memcpy(header.magic, mesh_binary_magic, sizeof(header.magic));
+		header.version = mesh_binary_version;
+		header.endianness = mesh_binary_endianness;
+		header.source_key = source_key;
+		stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+		mesh_binary_write(stream, m.position);
+		mesh_binary_write(stream, m.normal);
+		mesh_binary_write(stream, m.color);
+		mesh_binary_write(stream, m.uv);
+		mesh_binary_write(stream, m.connectivity);
+	}
+
+	bool mesh_load_file_binary(std::string const& filename, mesh& m, uint64_t source_key)
+	{
+		std::ifstream stream(filename, std::ios::binary | std::ios::ate);
+		if (!stream.is_open())
+			return false;
+		size_t const size = size_t(stream.tellg());
+		stream.seekg(0);
+
+		mesh_binary_header header;
+		if (size < sizeof(header) || !stream.read(reinterpret_cast<char*>(&header), sizeof(header)))
+			return false;
+		if (std::memcmp(header.magic, mesh_binary_magic, sizeof(header.magic)) != 0 || header.version != mesh_binary_version || header.endianness != mesh_binary_endianness)
+			return false;
+		if (source_key != 0 && header.source_key != source_key)
+			return false;
+
+		mesh loaded;
+		auto const remaining = [&]() { return size - size_t(stream.tellg()); };
+		bool const valid = mesh_binary_read(stream, remaining(), loaded.position)
+			&& mesh_binary_read(stream, remaining(), loaded.normal)
+			&& mesh_binary_read(stream, remaining(), loaded.color)
+			&& mesh_binary_read(stream, remaining(), loaded.uv)
+			&& mesh_binary_read(stream, remaining(), loaded.connectivity);
+		if (!valid)
+			return false;
+
+		m = loaded;
+		return true;
+	}
+
+	// Key of the binary cache: name, size, and modification time of the .obj file (FNV-1a hash)
+	static uint64_t mesh_binary_source_key(std::string const& filename)
+	{
+		int64_t stamp[2] = { 0, 0 };
+		struct stat info;
+		if (stat(filename.c_str(), &info) == 0) {
+			stamp[0] = int64_t(info.st_size);
+			stamp[1] = int64_t(info.st_mtime);
+		}
+
+		uint64_t hash = 14695981039346656037ull;
+		auto const hash_bytes = [&hash](void const* data, size_t size) {
+			unsigned char const* bytes = static_cast<unsigned char const*>(data);
+			for (size_t k = 0; k < size; ++k) {
+				hash ^= bytes[k];
+				hash *= 1099511628211ull;
+			}
+		};
+		hash_bytes(filename.data(), filename.size() + 1);
+		hash_bytes(stamp, sizeof(stamp));
+		return hash;
+	}
+
+	mesh mesh_load_file_obj_optimized(std::string const& filename, std::string const& binary_cache)
+	{
+		std::string const cache = binary_cache.size() > 0 ? binary_cache : filename + ".bin";
+		uint64_t const source_key = mesh_binary_source_key(filename);
+
+		mesh shape;
+		if (mesh_load_file_binary(cache, shape, source_key))
+			return shape;
+
+		// Bake: the mesh is optimized once and stored in the cache
+		shape = mesh_load_file_obj(filename);
+		shape.fill_empty_field();
+		if (shape.position.size() > 0 && shape.connectivity.size() > 0) {
+			mesh_optimization_report const report = mesh_optimize(shape, true);
+			std::cout << "Mesh optimization [" << filename << "] " << str(report) << std::endl;
+		}
+		mesh_save_file_binary(cache, shape, source_key);
+		return shape;
+	}
+}
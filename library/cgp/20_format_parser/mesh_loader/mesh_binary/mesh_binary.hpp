@@ -0,0 +1,22 @@
+#pragma once
+
+#include "cgp/11_mesh/mesh.hpp"
+
+#include <cstdint>
+
+namespace cgp
+{
+	/** Save a mesh in a binary file: the per-vertex buffers and the connectivity are stored as raw arrays, read back without any parsing
+	* source_key: identifies the source the mesh was built from (see mesh_load_file_binary) */
+	void mesh_save_file_binary(std::string const& filename, mesh const& m, uint64_t source_key = 0);
+
+	/** Load a mesh written by mesh_save_file_binary
+	* source_key: if not 0, the file is rejected when it was built with another key (out of date cache)
+	* Return false if the file doesn't exist, is out of date, or is not a valid mesh binary */
+	bool mesh_load_file_binary(std::string const& filename, mesh& m, uint64_t source_key = 0);
+
+	/** Load a mesh stored as .obj, with its missing fields filled and optimized for the GPU (mesh_optimize with overdraw)
+	* The optimization runs once, when the binary cache is baked: the next calls load the cache as long as the .obj file is unchanged
+	* binary_cache: file of the optimized mesh (default: the filename of the .obj followed by ".bin") */
+	mesh mesh_load_file_obj_optimized(std::string const& filename, std::string const& binary_cache = "");
+}
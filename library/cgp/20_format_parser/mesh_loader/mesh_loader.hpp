@@ -1,4 +1,5 @@
 #pragma once
 
 #include "obj/obj.hpp"
-#include "obj_advanced/obj_advanced.hpp"
\ No newline at end of file
+#include "obj_advanced/obj_advanced.hpp"
+#include "mesh_binary/mesh_binary.hpp"
\ No newline at end of file